@@ -0,0 +1,430 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "load_generator.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+
+#include <nx/kit/debug.h>
+#include <nx/kit/utils.h>
+
+#include "socket_utils.h"
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+using nx::kit::utils::format;
+
+namespace {
+
+/** Latency histogram with power-of-two buckets of microseconds. */
+class Histogram
+{
+public:
+    void add(microseconds value)
+    {
+        const uint64_t us = (uint64_t) std::max<int64_t>(0, value.count());
+        int bucket = 0;
+        while (bucket < kBucketCount - 1 && us >= (uint64_t(1) << bucket))
+            ++bucket;
+        ++m_buckets[bucket];
+        ++m_count;
+        m_max = std::max(m_max, us);
+    }
+
+    void print(const std::string& caption) const
+    {
+        std::cout << caption << ": ";
+        if (m_count == 0)
+        {
+            std::cout << "no samples\n";
+            return;
+        }
+        std::cout << m_count << " samples, p50 < " << percentileBound(0.5)
+            << " us, p90 < " << percentileBound(0.9) << " us, p99 < " << percentileBound(0.99)
+            << " us, max " << m_max << " us\n";
+
+        const int64_t maxBucket = *std::max_element(m_buckets.begin(), m_buckets.end());
+        for (int i = 0; i < kBucketCount; ++i)
+        {
+            if (m_buckets[i] == 0)
+                continue;
+            static constexpr int kBarWidth = 50;
+            std::cout << format("    < %10llu us: %8lld ", (unsigned long long) bucketBound(i),
+                (long long) m_buckets[i])
+                << std::string((size_t) (kBarWidth * m_buckets[i] / maxBucket), '#') << "\n";
+        }
+    }
+
+private:
+    static uint64_t bucketBound(int bucket) { return uint64_t(1) << bucket; }
+
+    uint64_t percentileBound(double fraction) const
+    {
+        const int64_t rank = (int64_t) std::ceil(fraction * (double) m_count);
+        int64_t accumulated = 0;
+        for (int i = 0; i < kBucketCount; ++i)
+        {
+            accumulated += m_buckets[i];
+            if (accumulated >= rank)
+                return bucketBound(i);
+        }
+        return bucketBound(kBucketCount - 1);
+    }
+
+private:
+    static constexpr int kBucketCount = 32;
+    std::array<int64_t, kBucketCount> m_buckets{};
+    int64_t m_count = 0;
+    uint64_t m_max = 0;
+};
+
+struct Connection
+{
+    enum class State { connecting, connected, closed };
+
+    int fd = -1;
+    State state = State::connecting;
+    steady_clock::time_point connectStartedAt;
+    steady_clock::time_point nextKeyAt;
+    size_t scriptPosition = 0;
+
+    /** Time of the oldest send which has not been acknowledged by the peer yet. */
+    std::optional<steady_clock::time_point> unackedSince;
+};
+
+struct Statistics
+{
+    int established = 0;
+    int connectErrors = 0;
+    int disconnects = 0;
+    int sendErrors = 0;
+    int64_t keysSent = 0;
+    int64_t keysDropped = 0; /**< Not sent because the socket send buffer was full. */
+    Histogram connectLatency;
+    Histogram ackLatency;
+};
+
+class LoadGenerator
+{
+public:
+    LoadGenerator(const LoadOptions& options):
+        m_options(options),
+        m_keyInterval(std::max(steady_clock::duration(1), duration_cast<steady_clock::duration>(
+            duration<double>(1.0 / options.keysPerSecond))))
+    {
+    }
+
+    ~LoadGenerator()
+    {
+        for (auto& connection: m_connections)
+            close(&connection);
+    }
+
+    bool run();
+
+private:
+    void startConnecting();
+    void onConnectCompleted(Connection* connection);
+    void onReadable(Connection* connection);
+    void sendDueKeys(Connection* connection, steady_clock::time_point now);
+    void pollAck(Connection* connection, steady_clock::time_point now);
+    void close(Connection* connection);
+    char nextKey(Connection* connection);
+    int pollTimeoutMs(steady_clock::time_point now, steady_clock::time_point deadline) const;
+    void printReport(duration<double> elapsed) const;
+
+private:
+    /** How often the unacknowledged bytes are polled while any are outstanding. */
+    static constexpr auto kAckPollPeriod = 1ms;
+
+    static constexpr char kGameKeys[] = "qweadzxs";
+
+    const LoadOptions& m_options;
+    const steady_clock::duration m_keyInterval;
+    std::vector<Connection> m_connections;
+    Statistics m_stats;
+    std::mt19937 m_random{std::random_device{}()};
+    bool m_isAckSupported = true;
+};
+
+void LoadGenerator::startConnecting()
+{
+    std::vector<std::unique_ptr<AddrInfo>> addrInfos;
+    for (const auto& target: m_options.targets)
+        addrInfos.push_back(std::make_unique<AddrInfo>(target.host, target.port));
+
+    m_connections.resize(m_options.connectionCount);
+    for (int i = 0; i < m_options.connectionCount; ++i)
+    {
+        Connection& connection = m_connections[i];
+        const addrinfo* const addr = addrInfos[i % addrInfos.size()]->data;
+        connection.scriptPosition = m_options.script.empty()
+            ? 0
+            : (i * m_options.script.size() / m_options.connectionCount);
+        connection.connectStartedAt = steady_clock::now();
+
+        connection.fd = (int) ::socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (connection.fd < 0 || !setSocketNonBlocking(connection.fd))
+        {
+            NX_PRINT << getLastSocketError("Unable to create a socket");
+            ++m_stats.connectErrors;
+            close(&connection);
+            continue;
+        }
+
+        if (::connect(connection.fd, addr->ai_addr, (int) addr->ai_addrlen) == 0)
+            onConnectCompleted(&connection);
+        else if (!lastSocketErrorIsConnectInProgress())
+        {
+            NX_PRINT << getLastSocketError("Unable to connect");
+            ++m_stats.connectErrors;
+            close(&connection);
+        }
+    }
+}
+
+void LoadGenerator::onConnectCompleted(Connection* connection)
+{
+    int error = 0;
+    #if defined(_WIN32)
+        int len = sizeof(error);
+    #else
+        socklen_t len = sizeof(error);
+    #endif
+    if (::getsockopt(connection->fd, SOL_SOCKET, SO_ERROR, (char*) &error, &len) != 0
+        || error != 0)
+    {
+        NX_PRINT << "Unable to connect: " << std::system_category().message(error);
+        ++m_stats.connectErrors;
+        close(connection);
+        return;
+    }
+
+    const auto now = steady_clock::now();
+    m_stats.connectLatency.add(duration_cast<microseconds>(now - connection->connectStartedAt));
+    ++m_stats.established;
+    setSocketNoDelay(connection->fd);
+    connection->state = Connection::State::connected;
+
+    // Spread the first keys of the connections over one key interval to avoid bursts.
+    std::uniform_int_distribution<int64_t> phase(0, m_keyInterval.count());
+    connection->nextKeyAt = now + steady_clock::duration(phase(m_random));
+}
+
+void LoadGenerator::onReadable(Connection* connection)
+{
+    char buffer[256];
+    const int r = (int) ::recv(connection->fd, buffer, sizeof(buffer), /*flags*/ 0);
+    if (r > 0 || (r < 0 && lastSocketErrorIsWouldBlock()))
+        return; //< The data, if any, is ignored.
+
+    ++m_stats.disconnects;
+    close(connection);
+}
+
+char LoadGenerator::nextKey(Connection* connection)
+{
+    if (m_options.script.empty())
+    {
+        std::uniform_int_distribution<int> index(0, (int) sizeof(kGameKeys) - 2);
+        return kGameKeys[index(m_random)];
+    }
+    const char key = m_options.script[connection->scriptPosition];
+    connection->scriptPosition = (connection->scriptPosition + 1) % m_options.script.size();
+    return key;
+}
+
+void LoadGenerator::sendDueKeys(Connection* connection, steady_clock::time_point now)
+{
+    if (now < connection->nextKeyAt)
+        return;
+
+    // If the loop has woken up late, the overdue keys are sent with a single write.
+    const int64_t dueKeyCount = 1 + (now - connection->nextKeyAt) / m_keyInterval;
+    connection->nextKeyAt += dueKeyCount * m_keyInterval;
+
+    std::string keys;
+    for (int64_t i = 0; i < dueKeyCount; ++i)
+        keys.push_back(nextKey(connection));
+
+    #if defined(MSG_NOSIGNAL)
+        static constexpr int kFlags = MSG_NOSIGNAL;
+    #else
+        static constexpr int kFlags = 0;
+    #endif
+    const int r = (int) ::send(connection->fd, keys.data(), (int) keys.size(), kFlags);
+    if (r < 0)
+    {
+        if (lastSocketErrorIsWouldBlock())
+        {
+            m_stats.keysDropped += dueKeyCount;
+            return;
+        }
+        NX_PRINT << getLastSocketError("Unable to send");
+        ++m_stats.sendErrors;
+        close(connection);
+        return;
+    }
+
+    m_stats.keysSent += r;
+    m_stats.keysDropped += dueKeyCount - r;
+    if (!connection->unackedSince)
+        connection->unackedSince = now;
+}
+
+void LoadGenerator::pollAck(Connection* connection, steady_clock::time_point now)
+{
+    if (!m_isAckSupported || !connection->unackedSince)
+        return;
+
+    const std::optional<int> bytes = unackedSocketBytes(connection->fd);
+    if (!bytes)
+    {
+        m_isAckSupported = false;
+        return;
+    }
+    if (*bytes > 0)
+        return;
+
+    m_stats.ackLatency.add(duration_cast<microseconds>(now - *connection->unackedSince));
+    connection->unackedSince.reset();
+}
+
+void LoadGenerator::close(Connection* connection)
+{
+    if (connection->fd >= 0)
+        closeSocket(connection->fd);
+    connection->fd = -1;
+    connection->state = Connection::State::closed;
+}
+
+int LoadGenerator::pollTimeoutMs(
+    steady_clock::time_point now, steady_clock::time_point deadline) const
+{
+    steady_clock::time_point wakeUpAt = deadline;
+    for (const auto& connection: m_connections)
+    {
+        if (connection.state != Connection::State::connected)
+            continue;
+        wakeUpAt = std::min(wakeUpAt, connection.nextKeyAt);
+        if (m_isAckSupported && connection.unackedSince)
+            wakeUpAt = std::min(wakeUpAt, now + kAckPollPeriod);
+    }
+    if (wakeUpAt <= now)
+        return 0;
+
+    // Round up, otherwise the loop would spin until the due time.
+    return (int) duration_cast<milliseconds>(wakeUpAt - now + 999us).count();
+}
+
+bool LoadGenerator::run()
+{
+    const auto startedAt = steady_clock::now();
+    const auto deadline = startedAt + m_options.duration;
+
+    startConnecting();
+
+    std::vector<pollfd> pollFds;
+    std::vector<Connection*> polledConnections;
+    for (;;)
+    {
+        auto now = steady_clock::now();
+        if (now >= deadline)
+            break;
+
+        pollFds.clear();
+        polledConnections.clear();
+        for (auto& connection: m_connections)
+        {
+            if (connection.state == Connection::State::closed)
+                continue;
+            pollfd pollFd{};
+            pollFd.fd = connection.fd;
+            pollFd.events =
+                (connection.state == Connection::State::connecting) ? POLLOUT : POLLIN;
+            pollFds.push_back(pollFd);
+            polledConnections.push_back(&connection);
+        }
+        if (pollFds.empty())
+        {
+            NX_PRINT << "All connections are closed.";
+            break;
+        }
+
+        if (pollSockets(pollFds.data(), pollFds.size(), pollTimeoutMs(now, deadline)) < 0)
+            throwSocketError("poll() failed");
+
+        for (size_t i = 0; i < pollFds.size(); ++i)
+        {
+            Connection* const connection = polledConnections[i];
+            const short events = pollFds[i].revents;
+            if (events == 0)
+                continue;
+            if (connection->state == Connection::State::connecting)
+                onConnectCompleted(connection);
+            else if (events & (POLLIN | POLLERR | POLLHUP))
+                onReadable(connection);
+        }
+
+        now = steady_clock::now();
+        for (auto& connection: m_connections)
+        {
+            if (connection.state != Connection::State::connected)
+                continue;
+            pollAck(&connection, now);
+            sendDueKeys(&connection, now);
+        }
+    }
+
+    printReport(steady_clock::now() - startedAt);
+    return m_stats.connectErrors == 0 && m_stats.sendErrors == 0;
+}
+
+void LoadGenerator::printReport(duration<double> elapsed) const
+{
+    const double targetRate = m_options.keysPerSecond * m_options.connectionCount;
+    const double achievedRate = (double) m_stats.keysSent / elapsed.count();
+
+    std::cout << "\n"
+        << "Duration: " << format("%.3f", elapsed.count()) << " s\n"
+        << "Connections: " << m_options.connectionCount << " requested, "
+            << m_stats.established << " established, "
+            << m_stats.connectErrors << " failed to connect, "
+            << m_stats.disconnects << " disconnected by the server, "
+            << m_stats.sendErrors << " failed to send\n"
+        << "Keys: " << m_stats.keysSent << " sent, "
+            << m_stats.keysDropped << " dropped because the socket buffer was full\n"
+        << "Throughput: " << format("%.1f", achievedRate) << " keys/s achieved, "
+            << format("%.1f", targetRate) << " keys/s targeted\n";
+    m_stats.connectLatency.print("Connect latency");
+    if (m_isAckSupported)
+        m_stats.ackLatency.print("Send-to-ack latency");
+    else
+        std::cout << "Send-to-ack latency: not supported on this platform\n";
+}
+
+} // namespace
+
+bool runLoad(const LoadOptions& options)
+{
+    if (!NX_KIT_ASSERT(!options.targets.empty()) || !NX_KIT_ASSERT(options.connectionCount > 0)
+        || !NX_KIT_ASSERT(options.keysPerSecond > 0))
+    {
+        return false;
+    }
+
+    [[maybe_unused]] SocketSubsystem socketSubsystem;
+
+    NX_PRINT << "Opening " << options.connectionCount << " connection(s) to "
+        << options.targets.size() << " target(s), sending " << options.keysPerSecond
+        << " keys/s per connection for " << options.duration.count() << " s.";
+
+    LoadGenerator loadGenerator(options);
+    return loadGenerator.run();
+}
@@ -0,0 +1,41 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+struct LoadOptions
+{
+    struct Target
+    {
+        std::string host;
+        int port = -1;
+    };
+
+    /** Connections are distributed among the targets round-robin. */
+    std::vector<Target> targets;
+
+    int connectionCount = 1;
+
+    /** Target rate of each connection. */
+    double keysPerSecond = 10;
+
+    std::chrono::seconds duration{10};
+
+    /**
+     * Keys to send, cycled; each connection starts at a different offset. If empty, the keys are
+     * chosen randomly among the game control keys.
+     */
+    std::string script;
+};
+
+/**
+ * Opens the requested connections and sends keystrokes at the requested rate from a single
+ * thread, using a non-blocking event loop, then prints the achieved throughput, the errors, and
+ * the histograms of the connect and send-to-ack latencies.
+ *
+ * @return Whether there were no connection or send errors.
+ */
+bool runLoad(const LoadOptions& options);
@@ -1,106 +1,182 @@
 // Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 
-#include <exception>
-#include <iostream>
-#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <iostream>
+#include <iterator>
 #include <memory>
-#include <vector>
-#include <cstdio>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <system_error>
+#include <thread>
+#include <vector>
 
-#if !defined(_WIN32)
-    #error "ms_netcat is Windows-only."
+#if defined(_WIN32)
+    #include <conio.h>
+#else
+    #include <sys/select.h>
+    #include <termios.h>
 #endif
 
-#include <conio.h>
-#include <WinSock2.h>
-#include <ws2tcpip.h>
-
 #include <nx/kit/debug.h>
 #include <nx/kit/utils.h>
 
-static std::string getLastSocketError(const std::string& message)
-{
-    return message + ": " + std::system_category().message(WSAGetLastError());
-}
+#include <ms/vampires_nx_vms_plugin/shared_memory_ring.h>
 
-[[noreturn]] static void throwSocketError(const std::string& message)
-{
-    throw std::exception(getLastSocketError(message).c_str());
-}
+#include "load_generator.h"
+#include "socket_utils.h"
 
-struct SocketSubsystem
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+/**
+ * Puts the console into the raw mode (no line buffering, no echo, ^C delivered as a key) for the
+ * lifetime of the object.
+ */
+struct Terminal
 {
-    SocketSubsystem()
-    {
-        WSADATA wsaData;
-        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
-            throwSocketError("WSAStartup() failed");
-    }
+    #if defined(_WIN32)
+        // The console functions _kbhit() and _getch() are always raw.
+    #else
+        termios savedAttributes{};
+        bool isRaw = false;
+
+        Terminal()
+        {
+            if (tcgetattr(STDIN_FILENO, &savedAttributes) != 0)
+                return; //< Not a terminal, e.g. stdin is redirected from a file.
 
-    ~SocketSubsystem()
+            termios raw = savedAttributes;
+            raw.c_lflag &= ~(tcflag_t) (ICANON | ECHO | ISIG | IEXTEN);
+            raw.c_iflag &= ~(tcflag_t) (IXON | ICRNL);
+            raw.c_cc[VMIN] = 1;
+            raw.c_cc[VTIME] = 0;
+            isRaw = tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) == 0;
+        }
+
+        ~Terminal()
+        {
+            if (isRaw)
+                tcsetattr(STDIN_FILENO, TCSAFLUSH, &savedAttributes);
+        }
+    #endif
+
+    /**
+     * @param timeout If not specified, waits for a key infinitely.
+     * @return Key code, or nothing if the timeout has expired, or EOF if stdin is closed.
+     */
+    std::optional<int> readKey(std::optional<microseconds> timeout)
     {
-        WSACleanup();
+        #if defined(_WIN32)
+            if (!timeout)
+                return _getch();
+            const auto deadline = steady_clock::now() + *timeout;
+            do
+            {
+                if (_kbhit())
+                    return _getch();
+                std::this_thread::yield();
+            } while (steady_clock::now() < deadline);
+            return std::nullopt;
+        #else
+            fd_set fds;
+            FD_ZERO(&fds);
+            FD_SET(STDIN_FILENO, &fds);
+            timeval tv{};
+            if (timeout)
+            {
+                tv.tv_sec = (time_t) duration_cast<seconds>(*timeout).count();
+                tv.tv_usec = (suseconds_t) (*timeout % 1s).count();
+            }
+            const int r = select(STDIN_FILENO + 1, &fds, nullptr, nullptr, timeout ? &tv : nullptr);
+            if (r < 0 && errno != EINTR)
+                throw std::runtime_error("select() on stdin failed");
+            if (r <= 0)
+                return std::nullopt;
+
+            unsigned char key = 0;
+            if (read(STDIN_FILENO, &key, 1) != 1)
+                return EOF;
+            return key;
+        #endif
     }
 };
 
-struct AddrInfo
+/** Destination of the keystrokes. */
+struct Channel
 {
-    addrinfo* data = nullptr;
+    /** Time of the oldest send which has not been acknowledged by the peer yet. */
+    std::optional<steady_clock::time_point> unackedSince;
 
-    AddrInfo(const std::string& host, int port)
-    {
-        addrinfo hints;
-        memset(&hints, 0, sizeof(hints));
-        hints.ai_family = AF_INET;
-        hints.ai_socktype = SOCK_STREAM;
-        hints.ai_protocol = IPPROTO_TCP;
+    virtual ~Channel() = default;
 
-        const auto r = getaddrinfo(
-            host.c_str(),
-            nx::kit::utils::toString(port).c_str(),
-            &hints,
-            &data);
+    virtual void send(const std::string& bytes) = 0;
 
-        if (r != 0)
-            throwSocketError("getaddrinfo() failed");
+    /** @return Send-to-ack latency if all the sent bytes have just been acknowledged. */
+    std::optional<microseconds> pollAck()
+    {
+        if (!unackedSince)
+            return std::nullopt;
+        const std::optional<bool> acked = isAcked();
+        if (!acked)
+        {
+            unackedSince.reset(); //< Not supported - stop polling.
+            return std::nullopt;
+        }
+        if (!*acked)
+            return std::nullopt;
+        const auto latency = duration_cast<microseconds>(steady_clock::now() - *unackedSince);
+        unackedSince.reset();
+        return latency;
     }
 
-    ~AddrInfo()
+protected:
+    /** @return Whether all the sent bytes were acknowledged, or nothing if it cannot be told. */
+    virtual std::optional<bool> isAcked() = 0;
+
+    void onSent()
     {
-        if (data)
-            freeaddrinfo(data);
+        if (!unackedSince)
+            unackedSince = steady_clock::now();
     }
 };
 
-struct Socket
+struct Socket: Channel
 {
     int fd = -1;
     bool connected = false;
 
-    Socket()
+    explicit Socket(int family)
     {
-        fd = (int) ::socket(PF_INET, SOCK_STREAM, /*protocol*/ IPPROTO_TCP);
+        fd = (int) ::socket(family, SOCK_STREAM, /*protocol*/ 0);
         if (fd < 0)
             throwSocketError("Unable to create a socket: socket() failed");
     }
 
-    ~Socket()
+    virtual ~Socket() override
     {
         if (fd >= 0)
         {
             std::cerr << "\n"; //< Newline after the logged keystrokes.
             if (connected)
             {
-                if (::shutdown(fd, SD_BOTH) < 0)
+                #if defined(_WIN32)
+                    static constexpr int kShutdownBoth = SD_BOTH;
+                #else
+                    static constexpr int kShutdownBoth = SHUT_RDWR;
+                #endif
+                if (::shutdown(fd, kShutdownBoth) < 0)
                 {
                     // Cannot throw an exception in the destructor.
                     NX_PRINT << getLastSocketError("Unable to shutdown the socket: shutdown() failed");
                 }
             }
-            ::closesocket(fd);
+            closeSocket(fd);
         }
     }
 
@@ -110,38 +186,183 @@ struct Socket
         if (::connect(fd, addrInfo.data->ai_addr, (int) addrInfo.data->ai_addrlen) != 0)
             throwSocketError("Unable to connect to the server: connect() failed");
         connected = true;
+
+        // Keystrokes are batched by this tool, so Nagle's algorithm would only add latency.
+        if (!setSocketNoDelay(fd))
+            throwSocketError("Unable to set TCP_NODELAY: setsockopt() failed");
+    }
+
+    void connect(const std::string& unixSocketPath)
+    {
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (unixSocketPath.size() >= sizeof(addr.sun_path))
+            throw std::runtime_error("Unix-domain socket path is too long");
+        strncpy(addr.sun_path, unixSocketPath.c_str(), sizeof(addr.sun_path) - 1);
+        if (::connect(fd, (const sockaddr*) &addr, (int) sizeof(addr)) != 0)
+            throwSocketError("Unable to connect to the server: connect() failed");
+        connected = true;
     }
 
-    void send(char c)
+    virtual void send(const std::string& bytes) override
     {
         if (!NX_KIT_ASSERT(connected))
             return;
-        if (::send(fd, &c, /*len*/ 1, /*flags*/ 0) < 0)
-            throwSocketError("Unable to send a byte to the server: send() failed");   
+        if (::send(fd, bytes.data(), (int) bytes.size(), /*flags*/ 0) < 0)
+            throwSocketError("Unable to send bytes to the server: send() failed");
+        onSent();
+    }
+
+protected:
+    virtual std::optional<bool> isAcked() override
+    {
+        const std::optional<int> bytes = unackedSocketBytes(fd);
+        if (!bytes)
+            return std::nullopt;
+        return *bytes == 0;
     }
 };
 
-static void netcat(const std::string& host, int port)
+/** Writes the keystrokes into the plugin's shared memory ring; sending is syscall-free. */
+struct SharedMemoryChannel: Channel
 {
-    [[maybe_unused]] SocketSubsystem socketSubsystem;
-    Socket socket;
-    socket.connect(host, port);
-    NX_PRINT << "Connected to " << host << ":" << port << ". "
+    std::unique_ptr<ms::vampires_nx_vms_plugin::SharedMemoryRingMapping> mapping;
+
+    explicit SharedMemoryChannel(const std::string& name):
+        mapping(ms::vampires_nx_vms_plugin::SharedMemoryRingMapping::open(name))
+    {
+        if (!mapping)
+        {
+            throw std::runtime_error("Unable to open the shared memory "
+                + nx::kit::utils::toString(
+                    ms::vampires_nx_vms_plugin::SharedMemoryRingMapping::osName(name))
+                + " - make sure the plugin uses the shared memory transport with this name.");
+        }
+    }
+
+    virtual ~SharedMemoryChannel() override
+    {
+        std::cerr << "\n"; //< Newline after the logged keystrokes.
+    }
+
+    virtual void send(const std::string& bytes) override
+    {
+        for (const char c: bytes)
+        {
+            if (!mapping->ring()->push(c))
+            {
+                std::cerr << "(ring is full, key dropped) ";
+                break;
+            }
+        }
+        onSent();
+    }
+
+protected:
+    /** The plugin consumes the keys once per video frame, so this is the frame-latency. */
+    virtual std::optional<bool> isAcked() override
+    {
+        return mapping->ring()->isDrained();
+    }
+};
+
+struct Options
+{
+    /** Keys typed within this window after the first one are sent with a single write. */
+    microseconds batchWindow{0};
+
+    bool printLatency = false;
+};
+
+/** Where to send the keystrokes to: exactly one of the alternatives is specified. */
+struct Destination
+{
+    std::string host;
+    int port = -1;
+    std::string unixSocketPath;
+    std::string sharedMemoryName;
+};
+
+static std::unique_ptr<Channel> openChannel(const Destination& destination)
+{
+    if (!destination.sharedMemoryName.empty())
+    {
+        auto channel = std::make_unique<SharedMemoryChannel>(destination.sharedMemoryName);
+        NX_PRINT << "Opened shared memory " << channel->mapping->osName() << ". "
+            << "Press keys to send keystrokes, ^C to exit:";
+        return channel;
+    }
+
+    if (!destination.unixSocketPath.empty())
+    {
+        auto socket = std::make_unique<Socket>(AF_UNIX);
+        socket->connect(destination.unixSocketPath);
+        NX_PRINT << "Connected to " << destination.unixSocketPath << ". "
+            << "Press keys to send keystrokes, ^C to exit:";
+        return socket;
+    }
+
+    auto socket = std::make_unique<Socket>(AF_INET);
+    socket->connect(destination.host, destination.port);
+    NX_PRINT << "Connected to " << destination.host << ":" << destination.port << ". "
         << "Press keys to send keystrokes, ^C to exit:";
+    return socket;
+}
 
+static void netcat(const Destination& destination, const Options& options)
+{
+    /** How often the unacknowledged bytes are polled while waiting for the keys. */
+    static constexpr microseconds kAckPollPeriod = 100us;
+
+    [[maybe_unused]] SocketSubsystem socketSubsystem;
+    const std::unique_ptr<Channel> channel = openChannel(destination);
+
+    Terminal terminal;
+    std::string batch;
+    steady_clock::time_point batchDeadline;
     for (;;)
     {
-        const int key = _getch();
-        NX_KIT_ASSERT(key != EOF); //< _getch() never returns EOF.
-        if (key == '\x03') //< ^C.
+        std::optional<microseconds> timeout;
+        if (!batch.empty())
         {
-            std::cerr << "^C\n";
-            break;
+            timeout = std::max(0us,
+                duration_cast<microseconds>(batchDeadline - steady_clock::now()));
+        }
+        if (options.printLatency && channel->unackedSince)
+            timeout = timeout ? std::min(*timeout, kAckPollPeriod) : kAckPollPeriod;
+
+        if (const std::optional<int> key = terminal.readKey(timeout))
+        {
+            if (*key == EOF)
+                break;
+            if (*key == '\x03') //< ^C.
+            {
+                std::cerr << "^C\n";
+                break;
+            }
+            std::cout << nx::kit::utils::toString((char) *key) << " " << std::flush;
+            if (batch.empty())
+                batchDeadline = steady_clock::now() + options.batchWindow;
+            batch.push_back((char) *key);
+        }
+
+        if (!batch.empty() && steady_clock::now() >= batchDeadline)
+        {
+            channel->send(batch);
+            batch.clear();
+        }
+
+        if (options.printLatency)
+        {
+            if (const auto latency = channel->pollAck())
+                std::cout << "(ack " << latency->count() << " us) " << std::flush;
         }
-        std::cout << nx::kit::utils::toString((char) key) << " ";
-        socket.send((char) key);
     }
 
+    if (!batch.empty())
+        channel->send(batch);
+
     NX_PRINT << "Disconnecting from the server.";
 }
 
@@ -155,10 +376,60 @@ Equivalent of Linux/Cygwin's command:
     stty -icanon && nc <host> <port>
 
 Usage:
- )" << nx::kit::utils::getProcessName() << R"( <host> <port>
+ )" << nx::kit::utils::getProcessName() << R"( [<options>] <host> <port>
+ )" << nx::kit::utils::getProcessName() << R"( [<options>] --unix <socket-path>
+ )" << nx::kit::utils::getProcessName() << R"( [<options>] --shm <name>
+ )" << nx::kit::utils::getProcessName() << R"( --load <connections> [<load-options>] <host> <port> [<host> <port>...]
+
+Options:
+ --batch-us <microseconds>
+    Keys typed within this time after the first one are sent with a single write. Default: 0.
+ --latency
+    After each write, print the time until the server's TCP stack has acknowledged it (Linux and
+    Windows 10+ only), or until the plugin has consumed it from the shared memory.
+ --unix <socket-path>
+    Connect to a Unix-domain socket instead of a TCP one (Linux, macOS, Windows 10+).
+ --shm <name>
+    Write the keystrokes into the shared memory created by the plugin on the same machine.
+
+Load mode, for stress-testing: opens the given number of connections to the given targets
+(round-robin), sends keystrokes from a single thread, then prints the achieved throughput, the
+errors, and the latency histograms. Load options:
+ --rate <keys-per-second>
+    Target rate of each connection. Default: 10.
+ --duration <seconds>
+    Default: 10.
+ --script <file>
+    Send the keys from this file, cycled. By default, random game control keys are sent.
 )";
 }
 
+[[noreturn]] static void exitWithError(const std::string& message)
+{
+    std::cerr << "ERROR: " << message << " Run with -h, --help or /? for usage help.\n";
+    exit(1);
+}
+
+static int parseInt(const char* arg, const std::string& name, int minValue, int maxValue)
+{
+    int value = 0;
+    if (!nx::kit::utils::fromString(arg, &value) || value < minValue || value > maxValue)
+    {
+        exitWithError(nx::kit::utils::format("Invalid %s value %s: expected an integer in range "
+            "[%d, %d].", name.c_str(), nx::kit::utils::toString(arg).c_str(),
+            minValue, maxValue));
+    }
+    return value;
+}
+
+static std::string readFile(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("Unable to open file " + nx::kit::utils::toString(filename));
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
 int main(int argc, char** argv)
 {
     try
@@ -171,23 +442,92 @@ int main(int argc, char** argv)
             exit(0);
         }
 
-        if (argc != 3)
+        Options options;
+        Destination destination;
+        std::optional<LoadOptions> loadOptions;
+        int argIndex = 1;
+        for (; argIndex < argc && strncmp(argv[argIndex], "--", 2) == 0; ++argIndex)
         {
-            std::cerr << "ERROR: Expected 2 args. Run with -h, --help or /? for usage help.\n";
-            exit(1);
+            const std::string option = argv[argIndex];
+            const bool hasValue = argIndex + 1 < argc;
+            if (option == "--latency")
+            {
+                options.printLatency = true;
+            }
+            else if (option == "--batch-us" && hasValue)
+            {
+                options.batchWindow =
+                    microseconds(parseInt(argv[++argIndex], option, 0, INT_MAX));
+            }
+            else if (option == "--unix" && hasValue)
+            {
+                destination.unixSocketPath = argv[++argIndex];
+            }
+            else if (option == "--shm" && hasValue)
+            {
+                destination.sharedMemoryName = argv[++argIndex];
+            }
+            else if (option == "--load" && hasValue)
+            {
+                loadOptions.emplace();
+                loadOptions->connectionCount = parseInt(argv[++argIndex], option, 1, 100000);
+            }
+            else if (option == "--rate" && hasValue && loadOptions)
+            {
+                loadOptions->keysPerSecond = parseInt(argv[++argIndex], option, 1, 1000000);
+            }
+            else if (option == "--duration" && hasValue && loadOptions)
+            {
+                loadOptions->duration =
+                    std::chrono::seconds(parseInt(argv[++argIndex], option, 1, 86400));
+            }
+            else if (option == "--script" && hasValue && loadOptions)
+            {
+                loadOptions->script = readFile(argv[++argIndex]);
+            }
+            else
+            {
+                exitWithError("Invalid option " + nx::kit::utils::toString(option)
+                    + " or its value.");
+            }
+        }
+
+        const int positionalArgCount = argc - argIndex;
+        const bool isLocal =
+            !destination.unixSocketPath.empty() || !destination.sharedMemoryName.empty();
+        if (isLocal)
+        {
+            if (loadOptions || positionalArgCount != 0
+                || (!destination.unixSocketPath.empty() && !destination.sharedMemoryName.empty()))
+            {
+                exitWithError("--unix or --shm can only be used alone, without <host> <port>.");
+            }
+            netcat(destination, options);
+            return 0;
+        }
+
+        if (positionalArgCount == 0 || positionalArgCount % 2 != 0
+            || (!loadOptions && positionalArgCount != 2))
+        {
+            exitWithError(loadOptions ? "Expected pairs of <host> <port>." : "Expected 2 args.");
         }
 
-        int port;
-        if (!nx::kit::utils::fromString(argv[2], &port) || port < 1 || port > 65535)
+        std::vector<LoadOptions::Target> targets;
+        for (; argIndex < argc; argIndex += 2)
         {
-            std::cerr << "ERROR: Invalid port value " << nx::kit::utils::toString(argv[2])
-                << ": expected an integer in range [1, 65535].\n";
-            exit(1);
+            targets.push_back(
+                {argv[argIndex], parseInt(argv[argIndex + 1], "port", 1, 65535)});
         }
 
-        const std::string host = argv[1];
+        if (loadOptions)
+        {
+            loadOptions->targets = targets;
+            return runLoad(*loadOptions) ? 0 : 2;
+        }
 
-        netcat(host, port);
+        destination.host = targets[0].host;
+        destination.port = targets[0].port;
+        netcat(destination, options);
     }
     catch (const std::exception& e)
     {
@@ -0,0 +1,188 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+/**@file
+ * Platform layer over BSD sockets and WinSock shared by the interactive and the load modes.
+ */
+
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#if defined(_WIN32)
+    #include <WinSock2.h>
+    #include <ws2tcpip.h>
+    #include <mstcpip.h>
+    #include <afunix.h>
+#else
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <poll.h>
+    #include <sys/ioctl.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+    #if defined(__linux__)
+        #include <linux/sockios.h>
+    #endif
+#endif
+
+#include <nx/kit/utils.h>
+
+inline int lastSocketError()
+{
+    #if defined(_WIN32)
+        return WSAGetLastError();
+    #else
+        return errno;
+    #endif
+}
+
+inline std::string getLastSocketError(const std::string& message)
+{
+    return message + ": " + std::system_category().message(lastSocketError());
+}
+
+[[noreturn]] inline void throwSocketError(const std::string& message)
+{
+    throw std::runtime_error(getLastSocketError(message));
+}
+
+/** @return Whether the last non-blocking call has failed only because it would block. */
+inline bool lastSocketErrorIsWouldBlock()
+{
+    const int error = lastSocketError();
+    #if defined(_WIN32)
+        return error == WSAEWOULDBLOCK;
+    #else
+        return error == EAGAIN || error == EWOULDBLOCK;
+    #endif
+}
+
+/** @return Whether the last non-blocking connect() has failed only because it is in progress. */
+inline bool lastSocketErrorIsConnectInProgress()
+{
+    const int error = lastSocketError();
+    #if defined(_WIN32)
+        return error == WSAEWOULDBLOCK;
+    #else
+        return error == EINPROGRESS;
+    #endif
+}
+
+inline void closeSocket(int fd)
+{
+    #if defined(_WIN32)
+        ::closesocket(fd);
+    #else
+        ::close(fd);
+    #endif
+}
+
+inline bool setSocketNonBlocking(int fd)
+{
+    #if defined(_WIN32)
+        u_long argp = 1;
+        return ::ioctlsocket(fd, FIONBIO, &argp) == 0;
+    #else
+        const int flags = ::fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    #endif
+}
+
+inline bool setSocketNoDelay(int fd)
+{
+    const int enable = 1;
+    return ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (const char*) &enable, sizeof(enable)) == 0;
+}
+
+/**
+ * @return Number of sent bytes which have not been acknowledged by the peer's TCP stack yet, or
+ *     nothing if the platform cannot tell.
+ */
+inline std::optional<int> unackedSocketBytes(int fd)
+{
+    #if defined(_WIN32)
+        DWORD version = 0;
+        TCP_INFO_v0 info{};
+        DWORD bytesReturned = 0;
+        if (WSAIoctl(fd, SIO_TCP_INFO, &version, sizeof(version), &info, sizeof(info),
+            &bytesReturned, /*overlapped*/ nullptr, /*completionRoutine*/ nullptr) != 0)
+        {
+            return std::nullopt;
+        }
+        return (int) info.BytesInFlight;
+    #elif defined(__linux__)
+        int bytes = 0;
+        if (ioctl(fd, SIOCOUTQ, &bytes) != 0)
+            return std::nullopt;
+        return bytes;
+    #else
+        (void) fd;
+        return std::nullopt;
+    #endif
+}
+
+inline int pollSockets(pollfd* fds, size_t count, int timeoutMs)
+{
+    #if defined(_WIN32)
+        return WSAPoll(fds, (ULONG) count, timeoutMs);
+    #else
+        return ::poll(fds, (nfds_t) count, timeoutMs);
+    #endif
+}
+
+struct SocketSubsystem
+{
+    #if defined(_WIN32)
+        SocketSubsystem()
+        {
+            WSADATA wsaData;
+            if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+                throwSocketError("WSAStartup() failed");
+        }
+
+        ~SocketSubsystem()
+        {
+            WSACleanup();
+        }
+    #endif
+};
+
+struct AddrInfo
+{
+    addrinfo* data = nullptr;
+
+    AddrInfo(const std::string& host, int port)
+    {
+        addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_protocol = IPPROTO_TCP;
+
+        const auto r = getaddrinfo(
+            host.c_str(),
+            nx::kit::utils::toString(port).c_str(),
+            &hints,
+            &data);
+
+        if (r != 0)
+            throwSocketError("getaddrinfo() failed");
+    }
+
+    ~AddrInfo()
+    {
+        if (data)
+            freeaddrinfo(data);
+    }
+
+    AddrInfo(const AddrInfo&) = delete;
+    AddrInfo& operator=(const AddrInfo&) = delete;
+};
@@ -0,0 +1,33 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <vector>
+
+namespace ms::vampires_nx_vms_plugin {
+
+/**
+ * Source of the keystrokes controlling the game; polled once per video frame, so the
+ * implementations must never block. Not thread-safe.
+ */
+class ControlReader
+{
+public:
+    /** Key of one of the players; players are numbered by their control connections. */
+    struct PlayerKey
+    {
+        int player = 0;
+        char key = '\0';
+    };
+
+    virtual ~ControlReader() = default;
+
+    /**
+     * Appends at most one buffered key of each player to the batch, without blocking, and
+     * discards the rest of the buffered keys, which is needed if the keyboard repeat rate exceeds
+     * the frame rate.
+     */
+    virtual void takeKeys(std::vector<PlayerKey>* keys) noexcept = 0;
+};
+
+} // namespace ms::vampires_nx_vms_plugin
@@ -2,11 +2,22 @@
 
 #include "device_agent.h"
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
 #include <nx/sdk/analytics/helpers/event_metadata.h>
 #include <nx/sdk/analytics/helpers/event_metadata_packet.h>
 #include <nx/sdk/analytics/helpers/object_metadata_packet.h>
+#include <nx/sdk/helpers/span_recorder.h>
 
 #include "integration.h"
+#include "metrics.h"
+#include "shared_memory_reader.h"
+#include "socket_reader.h"
+#include "tracing.h"
 #include "utils.h"
 
 namespace ms::vampires_nx_vms_plugin {
@@ -18,12 +29,17 @@ using namespace nx::sdk::analytics;
 class Item: public Vampires::Item
 {
 public:
-    Item(Kind kind, int x, int y):
+    Item(Kind kind, int x, int y, const nx::sdk::Uuid& uuid = nx::sdk::UuidHelper::randomUuid()):
         Vampires::Item(kind, x, y),
-        uuid(nx::sdk::UuidHelper::randomUuid())
+        uuid(uuid)
     {
     }
 
+    virtual PersistentData persistentData() const override
+    {
+        return uuid; //< Restored tracks keep their ids.
+    }
+
     virtual std::string toString() const override
     {
         return Vampires::Item::toString() + nx::sdk::UuidHelper::toStdString(uuid);
@@ -40,8 +56,25 @@ public:
     {
         return new Item(kind, x, y);
     }
+
+    virtual Item* restoreItem(Vampires::Item::Kind kind, int x, int y,
+        const Vampires::Item::PersistentData& persistentData) const override
+    {
+        nx::sdk::Uuid uuid;
+        std::copy(persistentData.begin(), persistentData.end(), uuid.begin());
+        return new Item(kind, x, y, uuid);
+    }
 };
 
+DeviceAgent::~DeviceAgent()
+{
+    saveGame();
+
+    // The next subscriber, if any, takes over the game.
+    if (m_sharedWorld)
+        m_sharedWorld->unsubscribe(this);
+}
+
 std::string DeviceAgent::manifestString() const
 {
     return /*suppress newline*/ 1 + (const char*) R"json(
@@ -63,6 +96,10 @@ std::string DeviceAgent::manifestString() const
             {
                 "id": ")json" + kBorderObjectType + R"json(",
                 "name": ""
+            },
+            {
+                "id": ")json" + kHudObjectType + R"json(",
+                "name": "Performance"
             }
         ]
     }
@@ -104,6 +141,7 @@ static Vampires::Direction keyToDirection(int key)
 
 void DeviceAgent::performPlayerLost()
 {
+    Metrics::instance().gamesLost.add();
     pushIntegrationDiagnosticEvent(
         IIntegrationDiagnosticEvent::Level::error, "Game over", "Vampire has you!");
     initGame();
@@ -111,6 +149,7 @@ void DeviceAgent::performPlayerLost()
 
 void DeviceAgent::performPlayerWon()
 {
+    Metrics::instance().gamesWon.add();
     pushIntegrationDiagnosticEvent(
         IIntegrationDiagnosticEvent::Level::warning, "Congratulations", "Vampires pwned!");
     initGame();
@@ -121,28 +160,71 @@ void DeviceAgent::performPlayerWon()
  */
 bool DeviceAgent::pushCompressedVideoFrame(Ptr<const ICompressedVideoPacket> videoFrame)
 {
+    Metrics& metrics = Metrics::instance();
+    metrics.framesReceived.add();
+
+    const auto frameTime = std::chrono::steady_clock::now();
+    if (m_lastFrameTime)
+    {
+        m_stats.frameIntervalMs.add(
+            std::chrono::duration<double, std::milli>(frameTime - *m_lastFrameTime).count());
+    }
+    m_lastFrameTime = frameTime;
+
     ++m_frameIndex;
     m_lastVideoFrameTimestampUs = videoFrame->timestampUs();
 
-    if (!NX_KIT_ASSERT(m_socketReader))
+    if (m_frameIndex % kIniReloadPeriodFrames == 0)
+        updateTracing();
+
+    if (m_sharedWorld && !m_isDriving)
+    {
+        if (!m_sharedWorld->isDriver(this))
+            return true; //< Only the objects published by the driver are sent.
+        NX_PRINT << "Taking over the shared game world.";
+        startDriving();
+    }
+
+    if (!NX_KIT_ASSERT(m_isDriving))
         return false;
 
-    if (const std::optional<char> key = m_socketReader->getChar())
+    m_playerKeys.clear();
+    if (m_controlReader)
+    {
+        const Span span("takeKeys");
+        m_controlReader->takeKeys(&m_playerKeys);
+    }
+    if (!m_playerKeys.empty())
     {
-        const Vampires::Direction direction = keyToDirection(*key);
-        if (direction != Vampires::Direction::count)
+        m_pendingKeyTime = std::chrono::steady_clock::now();
+
+        // The keys of all players are applied as one batch, in the order of the players.
+        m_playerCommands.clear();
+        for (const ControlReader::PlayerKey& playerKey: m_playerKeys)
         {
-            if (m_vampires->movePlayer(direction) == Vampires::PlayerResult::lost)
-                performPlayerLost();
+            const Vampires::Direction direction = keyToDirection(playerKey.key);
+            if (direction != Vampires::Direction::count)
+                m_playerCommands.push_back({playerKey.player, direction});
         }
-
-        m_socketReader->clear(); //< Needed if keyboard repeat rate is more than the frame rate.
+        if (m_vampires->movePlayers(m_playerCommands) == Vampires::PlayerResult::lost)
+            performPlayerLost();
     }
 
     // Move the vampires every Nth frame.
     if (m_frameIndex % intSetting(this, kSpeedSetting) == 0)
     {
-        switch (m_vampires->moveVampires())
+        const auto startTime = std::chrono::steady_clock::now();
+        Vampires::VampireResult result;
+        {
+            const Span span("moveVampires");
+            result = m_vampires->moveVampires();
+        }
+        const auto tickDuration = std::chrono::steady_clock::now() - startTime;
+        metrics.moveVampiresDuration.observe(std::chrono::duration<double>(tickDuration).count());
+        m_stats.tickMs.add(std::chrono::duration<double, std::milli>(tickDuration).count());
+        metrics.ticks.add();
+
+        switch (result)
         {
             case Vampires::VampireResult::lost:
                 performPlayerLost();
@@ -153,40 +235,274 @@ bool DeviceAgent::pushCompressedVideoFrame(Ptr<const ICompressedVideoPacket> vid
         }
     }
 
+    scrollViewport();
+
+    if (m_frameIndex % kSnapshotPeriodFrames == 0)
+        saveGame();
+
+    if (m_spectatorServer)
+    {
+        const Span span("SpectatorServer::publish");
+        m_spectatorServer->publish(*m_vampires);
+    }
+    m_vampires->clearChangedCells();
+
     return true; //< There were no errors while processing the video frame.
 }
 
 bool DeviceAgent::pullMetadataPackets(std::vector<Ptr<IMetadataPacket>>* metadataPackets)
 {
-    metadataPackets->push_back(generateObjectMetadataPacket());
+    std::shared_ptr<const ObjectMetadataList> objects;
+    if (m_isDriving)
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        objects = generateObjectMetadata();
+        const auto endTime = std::chrono::steady_clock::now();
+        m_stats.metadataBuildMs.add(
+            std::chrono::duration<double, std::milli>(endTime - startTime).count());
+        if (m_pendingKeyTime)
+        {
+            m_stats.inputLatencyMs.add(
+                std::chrono::duration<double, std::milli>(endTime - *m_pendingKeyTime).count());
+            m_pendingKeyTime.reset();
+        }
+        if (m_sharedWorld)
+            m_sharedWorld->publish(objects);
+    }
+    else if (m_sharedWorld)
+    {
+        objects = m_sharedWorld->objects();
+    }
+    if (!objects)
+        return true; //< The game has not started yet.
+
+    // Bind the object metadata to the last video frame using a timestamp.
+    metadataPackets->push_back(
+        makePtr<SharedObjectMetadataPacket>(objects, m_lastVideoFrameTimestampUs));
+    Metrics::instance().objectsPerPacket.observe((double) objects->size());
+    m_stats.objectsPerPacket.add((double) objects->size());
+
+    // The HUD goes in its own packet, so that the shared objects stay the same for all cameras.
+    if (boolSetting(this, kPerformanceHudSetting))
+    {
+        auto hudPacket = makePtr<ObjectMetadataPacket>();
+        hudPacket->setTimestampUs(m_lastVideoFrameTimestampUs);
+        hudPacket->addItem(createHudObjectMetadata());
+        metadataPackets->push_back(hudPacket);
+    }
     return true; //< There were no errors while filling metadataPackets.
 }
 
-void DeviceAgent::initGame()
+/** @return Empty string if snapshots are disabled. */
+std::string DeviceAgent::snapshotPath() const
 {
-    m_vampires = std::make_unique<Vampires>(
-        intSetting(this, kFieldWidthSetting),
-        intSetting(this, kFieldHeightSetting),
-        intSetting(this, kVampireCountSetting),
-        intSetting(this, kWallCountSetting),
-        std::make_shared<ItemFactory>());
+    const std::string dir = settingValue(kSnapshotDirSetting);
+    if (dir.empty())
+        return "";
+
+    // Device ids are like "{uuid}"; keep only the filename-friendly chars.
+    std::string deviceId;
+    for (const char c: m_deviceId)
+    {
+        if (isalnum((unsigned char) c) || c == '-' || c == '_')
+            deviceId.push_back(c);
+    }
+    return (std::filesystem::path(dir) / ("vampires_" + deviceId + ".snapshot")).string();
 }
 
-void DeviceAgent::doSetNeededMetadataTypes(
-    nx::sdk::Result<void>* /*outValue*/,
-    const nx::sdk::analytics::IMetadataTypes* /*neededMetadataTypes*/)
+/** @return Null if there is no suitable snapshot. */
+std::unique_ptr<Vampires> DeviceAgent::restoreGame()
 {
-    m_socketReader = std::make_unique<SocketReader>();
+    const std::string path = snapshotPath();
+    if (path.empty() || !std::filesystem::exists(path))
+        return nullptr;
+
+    std::string error;
+    auto vampires = Vampires::restoreSnapshot(path, std::make_shared<ItemFactory>(), &error);
+    if (!vampires)
+    {
+        NX_PRINT << "WARNING: Starting a new game. " << error;
+        return nullptr;
+    }
 
-    if (!m_socketReader->startListening(intSetting(this, kPortSetting)))
+    if (vampires->width != intSetting(this, kFieldWidthSetting)
+        || vampires->height != intSetting(this, kFieldHeightSetting)
+        || vampires->vampireCount != intSetting(this, kVampireCountSetting)
+        || vampires->wallCount != intSetting(this, kWallCountSetting)
+        || vampires->playerCount != intSetting(this, kPlayerCountSetting))
     {
-        NX_PRINT << "FATAL ERROR: Unable to open the control socket. Terminating.";
-        exit(42);
+        NX_PRINT << "Starting a new game: the game parameters differ from the saved game.";
+        return nullptr;
+    }
+
+    NX_PRINT << "Resuming the game saved in " << nx::kit::utils::toString(path);
+    return vampires;
+}
+
+void DeviceAgent::saveGame()
+{
+    if (!m_vampires)
+        return;
+    const std::string path = snapshotPath();
+    if (path.empty())
+        return;
+
+    const Span span("saveGame");
+    std::string error;
+    if (!m_vampires->saveSnapshot(path, &error))
+        NX_PRINT << "ERROR: Unable to save the game: " << error;
+}
+
+/**
+ * Opens the control channel and the spectator socket, and starts the game, or takes over the game
+ * of the shared world if it has already been started by another DeviceAgent.
+ */
+void DeviceAgent::startDriving()
+{
+    m_controlReader.reset(); //< Closes the socket, if any, before opening it again.
+    m_controlReader = createControlReader();
+    if (!m_controlReader)
+    {
+        if (!m_sharedWorld)
+        {
+            NX_PRINT << "FATAL ERROR: Unable to open the control channel. Terminating.";
+            exit(42);
+        }
+        NX_PRINT << "ERROR: Unable to open the control channel; the player will stay still.";
     }
 
     NX_PRINT << "Control keys: keypad with NumLock, or qwe/asd/zx - make use of diagonal keys!";
 
-    initGame();
+    m_spectatorServer.reset();
+    if (const int spectatorPort = intSetting(this, kSpectatorPortSetting); spectatorPort > 0)
+    {
+        m_spectatorServer = std::make_unique<SpectatorServer>();
+        if (!m_spectatorServer->startListening(spectatorPort))
+            m_spectatorServer.reset(); //< Spectators are optional, so the game goes on.
+    }
+
+    m_isDriving = true;
+    if (m_sharedWorld && (m_vampires = m_sharedWorld->vampires()))
+        initView();
+    else
+        initGame(/*restoreSnapshot*/ true);
+}
+
+/**
+ * @param restoreSnapshot Whether to resume the saved game instead of starting a new one, if
+ *     possible.
+ */
+void DeviceAgent::initGame(bool restoreSnapshot)
+{
+    m_vampires = restoreSnapshot ? restoreGame() : nullptr;
+    if (!m_vampires)
+    {
+        m_vampires = std::make_shared<Vampires>(
+            intSetting(this, kFieldWidthSetting),
+            intSetting(this, kFieldHeightSetting),
+            intSetting(this, kVampireCountSetting),
+            intSetting(this, kWallCountSetting),
+            intSetting(this, kPlayerCountSetting),
+            std::make_shared<ItemFactory>());
+    }
+    m_vampires->setParallelism((int) std::thread::hardware_concurrency());
+    if (m_sharedWorld)
+        m_sharedWorld->setVampires(m_vampires);
+
+    initView();
+}
+
+/** Sets up the metadata generation for the current game. */
+void DeviceAgent::initView()
+{
+    // A non-positive viewport size means the whole field.
+    const int viewportWidth = intSetting(this, kViewportWidthSetting);
+    const int viewportHeight = intSetting(this, kViewportHeightSetting);
+    m_viewport.width = (viewportWidth > 0)
+        ? std::min(viewportWidth, m_vampires->width) : m_vampires->width;
+    m_viewport.height = (viewportHeight > 0)
+        ? std::min(viewportHeight, m_vampires->height) : m_vampires->height;
+
+    m_objectBudget = intSetting(this, kObjectBudgetSetting);
+
+    // Center the viewport on the player.
+    m_viewport.x = m_vampires->player().x() - m_viewport.width / 2;
+    m_viewport.y = m_vampires->player().y() - m_viewport.height / 2;
+    scrollViewport();
+
+    if (m_spectatorServer)
+        m_spectatorServer->resync();
+}
+
+/**
+ * Scrolls the viewport only when the player approaches its edge, rather than on each move, so
+ * that the picture does not shift on every keystroke.
+ */
+void DeviceAgent::scrollViewport()
+{
+    const auto scroll =
+        [](int* origin, int size, int playerPos, int fieldSize)
+        {
+            const int margin = size / 4;
+            if (playerPos < *origin + margin)
+                *origin = playerPos - margin;
+            else if (playerPos > *origin + size - 1 - margin)
+                *origin = playerPos - (size - 1 - margin);
+            *origin = std::clamp(*origin, 0, fieldSize - size);
+        };
+
+    scroll(&m_viewport.x, m_viewport.width, m_vampires->player().x(), m_vampires->width);
+    scroll(&m_viewport.y, m_viewport.height, m_vampires->player().y(), m_vampires->height);
+}
+
+/** A bare name is placed into the temp dir; a path is used as is. */
+static std::string unixSocketPath(const std::string& name)
+{
+    if (name.find_first_of("/\\") != std::string::npos)
+        return name;
+
+    #if defined(_WIN32)
+        const char* const tempDir = getenv("TEMP");
+        return std::string(tempDir ? tempDir : ".") + "\\" + name + ".sock";
+    #else
+        return "/tmp/" + name + ".sock";
+    #endif
+}
+
+std::unique_ptr<ControlReader> DeviceAgent::createControlReader()
+{
+    const std::string transport = settingValue(kControlTransportSetting);
+    const std::string name = settingValue(kControlNameSetting);
+
+    if (transport == kSharedMemoryTransport)
+    {
+        auto sharedMemoryReader = std::make_unique<SharedMemoryReader>();
+        if (!sharedMemoryReader->open(name))
+            return nullptr;
+        return sharedMemoryReader;
+    }
+
+    // Each player connects separately; the shared memory ring serves a single player.
+    auto socketReader = std::make_unique<SocketReader>(intSetting(this, kPlayerCountSetting));
+    const bool isListening = (transport == kUnixSocketTransport)
+        ? socketReader->startListening(unixSocketPath(name))
+        : socketReader->startListening(intSetting(this, kPortSetting));
+    if (!isListening)
+        return nullptr;
+    return socketReader;
+}
+
+void DeviceAgent::doSetNeededMetadataTypes(
+    nx::sdk::Result<void>* /*outValue*/,
+    const nx::sdk::analytics::IMetadataTypes* /*neededMetadataTypes*/)
+{
+    if (!m_sharedWorld && (m_sharedWorld = m_engine->sharedWorld()))
+        m_sharedWorld->subscribe(this);
+
+    if (!m_sharedWorld || m_sharedWorld->isDriver(this))
+        startDriving();
+    else
+        NX_PRINT << "Showing the shared game world run by another camera.";
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -214,10 +530,12 @@ Ptr<ObjectMetadata> DeviceAgent::createObjectMetadata(const Item* item) const
     auto objectMetadata = makePtr<ObjectMetadata>();
     objectMetadata->setTypeId(itemObjectType(item->kind));
     objectMetadata->setTrackId(item->uuid);
-    const float cellWidth = 1.0F / m_vampires->width;
-    const float cellHeight = 1.0F / m_vampires->height;
+    const float cellWidth = 1.0F / (float) m_viewport.width;
+    const float cellHeight = 1.0F / (float) m_viewport.height;
     objectMetadata->setBoundingBox(Rect(
-        (float) item->x() * cellWidth, (float) item->y() * cellHeight, cellWidth, cellHeight));
+        (float) (item->x() - m_viewport.x) * cellWidth,
+        (float) (item->y() - m_viewport.y) * cellHeight,
+        cellWidth, cellHeight));
 
     std::vector<Ptr<Attribute>> attributes;
     attributes.push_back(makePtr<Attribute>(
@@ -226,28 +544,173 @@ Ptr<ObjectMetadata> DeviceAgent::createObjectMetadata(const Item* item) const
     return objectMetadata;
 }
 
-Ptr<IMetadataPacket> DeviceAgent::generateObjectMetadataPacket() const
+/**
+ * Blocks get track ids which are stable while the block stays the same, so that the Server does
+ * not have to store a new track for each block on each frame.
+ */
+Ptr<ObjectMetadata> DeviceAgent::createBlockObjectMetadata(const FieldQuadtree::Block& block) const
 {
-    // ObjectMetadataPacket contains arbitrary number of ObjectMetadata.
-    const auto objectMetadataPacket = makePtr<ObjectMetadataPacket>();
+    const auto& rect = block.rect;
 
-    // Bind the object metadata to the last video frame using a timestamp.
-    objectMetadataPacket->setTimestampUs(m_lastVideoFrameTimestampUs);
-    objectMetadataPacket->setDurationUs(0);
+    Uuid trackId = m_trackId;
+    const uint32_t keys[] = {
+        (uint32_t) rect.x, (uint32_t) rect.y, (uint32_t) rect.width,
+        ((uint32_t) rect.height << 8) | ((uint32_t) block.kind << 1) | block.isUniform};
+    for (int i = 0; i < (int) trackId.size(); ++i)
+        trackId[i] ^= (uint8_t) (keys[i / 4] >> (8 * (i % 4)));
+
+    const auto kind = (Vampires::Item::Kind) block.kind;
+    auto objectMetadata = makePtr<ObjectMetadata>();
+    objectMetadata->setTypeId(itemObjectType(kind));
+    objectMetadata->setTrackId(trackId);
+    const float cellWidth = 1.0F / (float) m_viewport.width;
+    const float cellHeight = 1.0F / (float) m_viewport.height;
+    objectMetadata->setBoundingBox(Rect(
+        (float) (rect.x - m_viewport.x) * cellWidth,
+        (float) (rect.y - m_viewport.y) * cellHeight,
+        (float) rect.width * cellWidth,
+        (float) rect.height * cellHeight));
+
+    std::vector<Ptr<Attribute>> attributes;
+    attributes.push_back(makePtr<Attribute>(
+        Attribute::Type::string, "nx.sys.color", itemColor(kind)));
+    if (!block.isUniform)
+    {
+        attributes.push_back(makePtr<Attribute>(
+            Attribute::Type::string, "Aggregated", "Mixed cells"));
+    }
+    objectMetadata->addAttributes(attributes);
+    return objectMetadata;
+}
+
+/** @return Text like "1.25 ms (max 3.50 ms)", or "-" if there were no samples yet. */
+template<int kCapacity>
+static std::string hudValue(const RollingWindow<kCapacity>& window, const char* unit)
+{
+    if (window.isEmpty())
+        return "-";
+    return nx::kit::utils::format("%.2f %s (max %.2f %s)",
+        window.average(), unit, window.max(), unit);
+}
+
+/**
+ * A single object in the top left corner of the frame, with the statistics of the recent frames
+ * as its attributes.
+ */
+Ptr<ObjectMetadata> DeviceAgent::createHudObjectMetadata() const
+{
+    auto objectMetadata = makePtr<ObjectMetadata>();
+    objectMetadata->setTypeId(kHudObjectType);
+    objectMetadata->setTrackId(m_hudTrackId);
+    objectMetadata->setBoundingBox(Rect(0, 0, 0.3F, 0.15F));
+
+    const double frameIntervalMs = std::max(m_stats.frameIntervalMs.average(), 1e-3);
+    const std::string fps = m_stats.frameIntervalMs.isEmpty()
+        ? "-"
+        : nx::kit::utils::format("%.1f", 1000.0 / frameIntervalMs);
+    const std::string objectsPerPacket = m_stats.objectsPerPacket.isEmpty()
+        ? "-"
+        : nx::kit::utils::format("%.0f (max %.0f)",
+            m_stats.objectsPerPacket.average(), m_stats.objectsPerPacket.max());
+
+    objectMetadata->addAttributes({
+        makePtr<Attribute>(Attribute::Type::string, "Tick time", hudValue(m_stats.tickMs, "ms")),
+        makePtr<Attribute>(Attribute::Type::string, "Metadata build time",
+            hudValue(m_stats.metadataBuildMs, "ms")),
+        makePtr<Attribute>(Attribute::Type::string, "Objects per packet", objectsPerPacket),
+        makePtr<Attribute>(Attribute::Type::string, "Input latency",
+            hudValue(m_stats.inputLatencyMs, "ms")),
+        makePtr<Attribute>(Attribute::Type::string, "FPS", fps),
+    });
+    return objectMetadata;
+}
+
+/**
+ * @return Uniform block for each side of the border which is visible in the viewport, clipped to
+ *     it: the border cells are implicit, so they are not covered by the items or the quadtree.
+ */
+static std::vector<FieldQuadtree::Block> borderBlocks(
+    const Vampires& vampires, const FieldQuadtree::Rect& viewport)
+{
+    const int w = vampires.width;
+    const int h = vampires.height;
+    const FieldQuadtree::Rect sides[] = {{0, 0, w, 1}, {0, h - 1, w, 1}, {0, 1, 1, h - 2},
+        {w - 1, 1, 1, h - 2}};
+
+    std::vector<FieldQuadtree::Block> blocks;
+    for (const auto& side: sides)
+    {
+        const int left = std::max(side.x, viewport.x);
+        const int top = std::max(side.y, viewport.y);
+        const int right = std::min(side.x + side.width, viewport.x + viewport.width);
+        const int bottom = std::min(side.y + side.height, viewport.y + viewport.height);
+        if (left < right && top < bottom)
+        {
+            blocks.push_back({{left, top, right - left, bottom - top},
+                (int) Vampires::Item::Kind::border, /*isUniform*/ true});
+        }
+    }
+    return blocks;
+}
+
+/**
+ * The objects are not modified after being built, so they can be shared by the packets of all the
+ * cameras of the shared world.
+ */
+std::shared_ptr<const ObjectMetadataList> DeviceAgent::generateObjectMetadata() const
+{
+    const Span span("generateObjectMetadata");
+
+    auto objects = std::make_shared<ObjectMetadataList>();
+
+    const FieldQuadtree::Rect viewport{
+        m_viewport.x, m_viewport.y, m_viewport.width, m_viewport.height};
+    const std::vector<FieldQuadtree::Block> border = borderBlocks(*m_vampires, viewport);
+    for (const auto& block: border)
+        objects->push_back(createBlockObjectMetadata(block));
+
+    const int itemBudget = std::max(1, m_objectBudget - (int) border.size());
+    if (m_objectBudget > 0 && m_vampires->quadtree().count(viewport) > itemBudget)
+    {
+        for (const auto& block: m_vampires->quadtree().aggregate(viewport, itemBudget))
+            objects->push_back(createBlockObjectMetadata(block));
+        return objects;
+    }
+
+    // Scanning the viewport cell by cell is cheaper only if it has fewer cells than there are
+    // items on the field, which is not the case e.g. for the whole-field viewport of a huge field.
+    const FieldQuadtree::Rect field{0, 0, m_vampires->width, m_vampires->height};
+    if ((int64_t) viewport.width * viewport.height > m_vampires->quadtree().count(field))
+    {
+        m_vampires->forEachItem(
+            [&](const Vampires::Item& item)
+            {
+                if (item.x() >= viewport.x && item.x() < viewport.x + viewport.width
+                    && item.y() >= viewport.y && item.y() < viewport.y + viewport.height)
+                {
+                    if (const auto objectMetadata =
+                        createObjectMetadata(dynamic_cast<const Item*>(&item)))
+                    {
+                        objects->push_back(objectMetadata);
+                    }
+                }
+            });
+        return objects;
+    }
 
-    for (int y = 0; y < m_vampires->height; ++y)
+    for (int y = m_viewport.y; y < m_viewport.y + m_viewport.height; ++y)
     {
-        for (int x = 0; x < m_vampires->width; ++x)
+        for (int x = m_viewport.x; x < m_viewport.x + m_viewport.width; ++x)
         {
             if (const auto objectMetadata = createObjectMetadata(
                 dynamic_cast<const Item*>(m_vampires->itemAt(x, y).get())))
             {
-                objectMetadataPacket->addItem(objectMetadata);
+                objects->push_back(objectMetadata);
             }
         }
     }
 
-    return objectMetadataPacket;
+    return objects;
 }
 
 } // namespace ms::vampires_nx_vms_plugin
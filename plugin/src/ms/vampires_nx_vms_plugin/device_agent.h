@@ -2,14 +2,20 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
+#include <optional>
+#include <vector>
 
 #include <nx/sdk/analytics/helpers/consuming_device_agent.h>
 #include <nx/sdk/helpers/uuid_helper.h>
 #include <nx/sdk/analytics/helpers/object_metadata.h>
 
 #include "engine.h"
-#include "socket_reader.h"
+#include "control_reader.h"
+#include "rolling_window.h"
+#include "shared_world.h"
+#include "spectator_server.h"
 #include "vampires.h"
 
 namespace ms::vampires_nx_vms_plugin {
@@ -21,11 +27,12 @@ class DeviceAgent: public nx::sdk::analytics::ConsumingDeviceAgent
 public:
     DeviceAgent(Engine* const engine, const nx::sdk::IDeviceInfo* deviceInfo):
         ConsumingDeviceAgent(deviceInfo, /*enableOutput*/ false),
-        m_engine(engine)
+        m_engine(engine),
+        m_deviceId(deviceInfo->id())
     {
     }
 
-    virtual ~DeviceAgent() override = default;
+    virtual ~DeviceAgent() override;
 
     std::string settingValue(const std::string& settingName) const
     {
@@ -36,8 +43,22 @@ public:
     static inline const std::string kFieldHeightSetting = "fieldHeight";
     static inline const std::string kVampireCountSetting = "vampireCount";
     static inline const std::string kWallCountSetting = "wallCount";
+    static inline const std::string kPlayerCountSetting = "playerCount";
     static inline const std::string kSpeedSetting = "speed";
+    static inline const std::string kViewportWidthSetting = "viewportWidth";
+    static inline const std::string kViewportHeightSetting = "viewportHeight";
+    static inline const std::string kObjectBudgetSetting = "objectBudget";
+    static inline const std::string kSnapshotDirSetting = "snapshotDir";
+    static inline const std::string kPerformanceHudSetting = "performanceHud";
     static inline const std::string kPortSetting = "port";
+    static inline const std::string kControlTransportSetting = "controlTransport";
+    static inline const std::string kControlNameSetting = "controlName";
+    static inline const std::string kSpectatorPortSetting = "spectatorPort";
+
+    /** Values of kControlTransportSetting. */
+    static inline const std::string kTcpTransport = "tcp";
+    static inline const std::string kUnixSocketTransport = "unixSocket";
+    static inline const std::string kSharedMemoryTransport = "sharedMemory";
 
 protected:
     virtual std::string manifestString() const override;
@@ -53,22 +74,40 @@ protected:
         const nx::sdk::analytics::IMetadataTypes* neededMetadataTypes) override;
 
 private:
-    nx::sdk::Ptr<nx::sdk::analytics::IMetadataPacket> generateObjectMetadataPacket() const;
+    std::shared_ptr<const ObjectMetadataList> generateObjectMetadata() const;
     std::string itemObjectType(Vampires::Item::Kind kind) const;
 
     nx::sdk::Ptr<nx::sdk::analytics::ObjectMetadata> createObjectMetadata(const Item* item) const;
+    nx::sdk::Ptr<nx::sdk::analytics::ObjectMetadata> createBlockObjectMetadata(
+        const FieldQuadtree::Block& block) const;
+    nx::sdk::Ptr<nx::sdk::analytics::ObjectMetadata> createHudObjectMetadata() const;
 
     void performPlayerLost();
     void performPlayerWon();
-    void initGame();
+    void startDriving();
+    void initGame(bool restoreSnapshot = false);
+    void initView();
+    std::string snapshotPath() const;
+    std::unique_ptr<Vampires> restoreGame();
+    void saveGame();
+    void scrollViewport();
+    std::unique_ptr<ControlReader> createControlReader();
 
 private:
     static inline const std::string kPlayerObjectType = "ms.vampires.player";
     static inline const std::string kWallObjectType = "ms.vampires.wall";
     static inline const std::string kVampireObjectType = "ms.vampires.vampire";
     static inline const std::string kBorderObjectType = "ms.vampires.border";
+    static inline const std::string kHudObjectType = "ms.vampires.hud";
 
     Engine* const m_engine;
+    const std::string m_deviceId;
+
+    /** How often the .ini file is re-read, allowing to switch tracing on the fly. */
+    static constexpr int kIniReloadPeriodFrames = 30;
+
+    /** How often the game is saved, if snapshots are enabled. */
+    static constexpr int kSnapshotPeriodFrames = 300;
 
     /** Length of the the track (in frames). The value was chosen arbitrarily. */
     static constexpr int kTrackFrameCount = 256;
@@ -80,8 +119,50 @@ private:
     /** Used for binding object and event metadata to the particular video frame. */
     int64_t m_lastVideoFrameTimestampUs = 0;
 
-    std::unique_ptr<Vampires> m_vampires;
-    std::unique_ptr<SocketReader> m_socketReader;
+    /** Null if this DeviceAgent shows the shared world driven by another one. */
+    std::shared_ptr<Vampires> m_vampires;
+
+    std::shared_ptr<SharedWorld> m_sharedWorld; /**< Null if the shared world is disabled. */
+
+    /** Whether this DeviceAgent runs the game, rather than shows the game of another one. */
+    bool m_isDriving = false;
+
+    /**
+     * Region of the field around the player which is turned into the metadata, so that the
+     * metadata volume does not depend on the field size. Covers the whole field if disabled.
+     */
+    struct Viewport
+    {
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+    };
+    Viewport m_viewport;
+
+    /** If positive, and the viewport has more items, they are aggregated via the quadtree. */
+    int m_objectBudget = 0;
+
+    /** Samples of the recent frames, shown by the performance HUD; updated on each frame. */
+    struct PerformanceStats
+    {
+        static constexpr int kWindowSize = 64;
+
+        RollingWindow<kWindowSize> tickMs;
+        RollingWindow<kWindowSize> metadataBuildMs;
+        RollingWindow<kWindowSize> objectsPerPacket;
+        RollingWindow<kWindowSize> inputLatencyMs; /**< From taking a key to sending its effect. */
+        RollingWindow<kWindowSize> frameIntervalMs;
+    };
+    PerformanceStats m_stats;
+    std::optional<std::chrono::steady_clock::time_point> m_lastFrameTime;
+    std::optional<std::chrono::steady_clock::time_point> m_pendingKeyTime;
+    const nx::sdk::Uuid m_hudTrackId = nx::sdk::UuidHelper::randomUuid();
+
+    std::unique_ptr<ControlReader> m_controlReader;
+    std::vector<ControlReader::PlayerKey> m_playerKeys; /**< Reused each frame. */
+    std::vector<Vampires::PlayerCommand> m_playerCommands; /**< Reused each frame. */
+    std::unique_ptr<SpectatorServer> m_spectatorServer; /**< Null if spectators are disabled. */
 };
 
 } // namespace ms::vampires_nx_vms_plugin
@@ -4,17 +4,66 @@
 
 #include "integration.h"
 #include "device_agent.h"
+#include "tracing.h"
+#include "utils.h"
 
 namespace ms::vampires_nx_vms_plugin {
 
 using namespace nx::sdk;
 using namespace nx::sdk::analytics;
 
+Engine::Engine(Integration* integration):
+    nx::sdk::analytics::Engine(/*enableOutput*/ false),
+    m_integration(integration)
+{
+    updateTracing();
+}
+
+Engine::~Engine()
+{
+    finishTracing();
+}
+
 void Engine::doObtainDeviceAgent(Result<IDeviceAgent*>* outResult, const IDeviceInfo* deviceInfo)
 {
     *outResult = new DeviceAgent(this, deviceInfo);
 }
 
+std::shared_ptr<SharedWorld> Engine::sharedWorld() const
+{
+    const std::lock_guard<std::mutex> lock(m_sharedWorldMutex);
+    return m_sharedWorld;
+}
+
+/**
+ * (Re)starts the metrics endpoint if its port has changed. Switching the shared-world mode
+ * affects only the DeviceAgents which start afterwards.
+ */
+Result<const ISettingsResponse*> Engine::settingsReceived()
+{
+    {
+        const std::lock_guard<std::mutex> lock(m_sharedWorldMutex);
+        if (!boolSetting(this, kSharedWorldSetting))
+            m_sharedWorld.reset();
+        else if (!m_sharedWorld)
+            m_sharedWorld = std::make_shared<SharedWorld>();
+    }
+
+    const int metricsPort = intSetting(this, kMetricsPortSetting);
+    const int currentPort = m_metricsServer ? m_metricsServer->port() : 0;
+    if (metricsPort != currentPort)
+    {
+        m_metricsServer.reset();
+        if (metricsPort > 0)
+        {
+            m_metricsServer = std::make_unique<MetricsServer>();
+            if (!m_metricsServer->start(metricsPort))
+                m_metricsServer.reset(); //< The metrics are optional, so the game goes on.
+        }
+    }
+    return nullptr;
+}
+
 std::string Engine::manifestString() const
 {
     return /*suppress newline*/ 1 + (const char*) R"json(
@@ -54,6 +103,15 @@ std::string Engine::manifestString() const
                         "minValue": 3,
                         "defaultValue": 100
                     },
+                    {
+                        "type": "SpinBox",
+                        "name": ")json" + DeviceAgent::kPlayerCountSetting + R"json(",
+                        "caption": "Number of Players",
+                        "description": "Each player connects to the control port separately.",
+                        "minValue": 1,
+                        "maxValue": 16,
+                        "defaultValue": 1
+                    },
                     {
                         "type": "SpinBox",
                         "name": ")json" + DeviceAgent::kSpeedSetting + R"json(",
@@ -61,6 +119,36 @@ std::string Engine::manifestString() const
                         "minValue": 1,
                         "maxValue": 1000,
                         "defaultValue": 10
+                    },
+                    {
+                        "type": "SpinBox",
+                        "name": ")json" + DeviceAgent::kViewportWidthSetting + R"json(",
+                        "caption": "Viewport width (0 - whole field)",
+                        "description": "Only the cells around the player are shown; the viewport scrolls when the player approaches its edge.",
+                        "minValue": 0,
+                        "defaultValue": 0
+                    },
+                    {
+                        "type": "SpinBox",
+                        "name": ")json" + DeviceAgent::kViewportHeightSetting + R"json(",
+                        "caption": "Viewport height (0 - whole field)",
+                        "minValue": 0,
+                        "defaultValue": 0
+                    },
+                    {
+                        "type": "SpinBox",
+                        "name": ")json" + DeviceAgent::kObjectBudgetSetting + R"json(",
+                        "caption": "Max objects per frame (0 - unlimited)",
+                        "description": "If the viewport has more items, uniform regions are merged into larger rectangles, and the rest is approximated, via a quadtree.",
+                        "minValue": 0,
+                        "defaultValue": 0
+                    },
+                    {
+                        "type": "CheckBox",
+                        "name": ")json" + DeviceAgent::kPerformanceHudSetting + R"json(",
+                        "caption": "Show performance HUD",
+                        "description": "An object in the top left corner shows the tick time, metadata build time, objects per packet, input latency and FPS, averaged over the recent frames.",
+                        "defaultValue": false
                     }
                 ]
             },
@@ -68,14 +156,55 @@ std::string Engine::manifestString() const
                 "type": "GroupBox",
                 "caption": "Controls",
                 "items": [
+                    {
+                        "type": "ComboBox",
+                        "name": ")json" + DeviceAgent::kControlTransportSetting + R"json(",
+                        "caption": "Control transport",
+                        "description": "Unix-domain socket and shared memory work only for a controller on the Server machine, with less latency than TCP.",
+                        "defaultValue": ")json" + DeviceAgent::kTcpTransport + R"json(",
+                        "range": [
+                            ")json" + DeviceAgent::kTcpTransport + R"json(",
+                            ")json" + DeviceAgent::kUnixSocketTransport + R"json(",
+                            ")json" + DeviceAgent::kSharedMemoryTransport + R"json("
+                        ],
+                        "itemCaptions": {
+                            ")json" + DeviceAgent::kTcpTransport + R"json(": "TCP socket",
+                            ")json" + DeviceAgent::kUnixSocketTransport + R"json(": "Unix-domain socket",
+                            ")json" + DeviceAgent::kSharedMemoryTransport + R"json(": "Shared memory"
+                        }
+                    },
                     {
                         "type": "SpinBox",
                         "name": ")json" + DeviceAgent::kPortSetting + R"json(",
                         "caption": "Socket port for control",
+                        "description": "Used by the TCP transport.",
                         "minValue": 1,
                         "maxValue": 65535,
                         "defaultValue": 65432
                     },
+                    {
+                        "type": "TextField",
+                        "name": ")json" + DeviceAgent::kControlNameSetting + R"json(",
+                        "caption": "Local control channel name",
+                        "description": "Used by the Unix-domain socket transport (a file in the temp dir, or a full path) and the shared memory transport.",
+                        "defaultValue": "vampires_control"
+                    },
+                    {
+                        "type": "SpinBox",
+                        "name": ")json" + DeviceAgent::kSpectatorPortSetting + R"json(",
+                        "caption": "Socket port for spectators (0 - disabled)",
+                        "description": "Read-only clients receive the field as a keyframe followed by per-tick deltas.",
+                        "minValue": 0,
+                        "maxValue": 65535,
+                        "defaultValue": 0
+                    },
+                    {
+                        "type": "TextField",
+                        "name": ")json" + DeviceAgent::kSnapshotDirSetting + R"json(",
+                        "caption": "Directory for saved games (empty - disabled)",
+                        "description": "The game is saved periodically and on exit, and resumed after a Server restart if the game parameters are the same.",
+                        "defaultValue": ""
+                    },
                     {
                         "type": "Banner",
                         "icon": "info",
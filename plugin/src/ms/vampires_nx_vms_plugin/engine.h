@@ -6,6 +6,12 @@
 #include <nx/sdk/analytics/helpers/engine.h>
 #include <nx/sdk/analytics/i_uncompressed_video_frame.h>
 
+#include <memory>
+#include <mutex>
+
+#include "metrics_server.h"
+#include "shared_world.h"
+
 namespace ms::vampires_nx_vms_plugin {
 
 class Integration;
@@ -13,13 +19,8 @@ class Integration;
 class Engine: public nx::sdk::analytics::Engine
 {
 public:
-    Engine(Integration* integration):
-        nx::sdk::analytics::Engine(/*enableOutput*/ false),
-        m_integration(integration)
-    {
-    }
-
-    virtual ~Engine() override = default;
+    Engine(Integration* integration);
+    virtual ~Engine() override;
 
     std::string settingValue(const std::string& settingName) const
     {
@@ -28,15 +29,27 @@ public:
 
     Integration* integration() const { return m_integration; }
 
+    /** @return Null if the shared-world mode is disabled. */
+    std::shared_ptr<SharedWorld> sharedWorld() const;
+
+    static inline const std::string kMetricsPortSetting = "metricsPort";
+    static inline const std::string kSharedWorldSetting = "sharedWorld";
+
 protected:
     virtual std::string manifestString() const override;
 
+    virtual nx::sdk::Result<const nx::sdk::ISettingsResponse*> settingsReceived() override;
+
     virtual void doObtainDeviceAgent(
         nx::sdk::Result<nx::sdk::analytics::IDeviceAgent*>* outResult,
         const nx::sdk::IDeviceInfo* deviceInfo) override;
 
 private:
     Integration* const m_integration;
+    std::unique_ptr<MetricsServer> m_metricsServer; /**< Null if the metrics are disabled. */
+
+    mutable std::mutex m_sharedWorldMutex;
+    std::shared_ptr<SharedWorld> m_sharedWorld; /**< Null if the shared world is disabled. */
 };
 
 } // namespace ms::vampires_nx_vms_plugin
@@ -0,0 +1,146 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "field_encoder.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace ms::vampires_nx_vms_plugin {
+
+static void appendVarint(std::string* buffer, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        buffer->push_back((char) ((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    buffer->push_back((char) value);
+}
+
+namespace {
+
+/** Appends the runs of the keyframe, merging the adjacent runs of the same cell code. */
+class RunWriter
+{
+public:
+    explicit RunWriter(std::string* buffer): m_buffer(buffer) {}
+
+    void add(int code, uint64_t length)
+    {
+        if (length == 0)
+            return;
+        if (code != m_code)
+        {
+            flush();
+            m_code = code;
+        }
+        m_length += length;
+    }
+
+    void flush()
+    {
+        if (m_length > 0)
+            appendVarint(m_buffer, (m_length << 3) | (uint64_t) m_code);
+        m_length = 0;
+    }
+
+private:
+    std::string* const m_buffer;
+    int m_code = -1;
+    uint64_t m_length = 0;
+};
+
+struct OccupiedCell
+{
+    int x = -1;
+    int y = -1;
+    int code = 0;
+};
+
+} // namespace
+
+/**
+ * Only the items are visited, rather than every cell of the field: the empty cells between them
+ * and the border rows and columns are emitted as whole runs.
+ */
+FieldEncoder::Buffer FieldEncoder::encodeKeyframe(const Vampires& vampires)
+{
+    std::vector<OccupiedCell> cells;
+    vampires.forEachItem(
+        [&](const Vampires::Item& item)
+        {
+            cells.push_back({item.x(), item.y(), cellCode(&item)});
+        });
+    std::sort(cells.begin(), cells.end(),
+        [](const OccupiedCell& a, const OccupiedCell& b)
+        {
+            return a.y != b.y ? a.y < b.y : a.x < b.x;
+        });
+
+    const int width = vampires.width;
+    const int height = vampires.height;
+    auto buffer = std::make_shared<std::string>();
+    buffer->reserve(/*header*/ 11 + /*row ends*/ 4 * (size_t) height + /*cells*/ 2 * cells.size());
+    buffer->push_back('K');
+    appendVarint(buffer.get(), (uint64_t) width);
+    appendVarint(buffer.get(), (uint64_t) height);
+
+    static constexpr int kBorderCode = cellCode(Vampires::Item::Kind::border);
+    RunWriter runs(buffer.get());
+    runs.add(kBorderCode, (uint64_t) width); //< The top row.
+    auto cell = cells.begin();
+    for (int y = 1; y < height - 1; ++y)
+    {
+        runs.add(kBorderCode, 1);
+        int x = 1; //< The first cell not emitted yet.
+        for (; cell != cells.end() && cell->y == y; ++cell)
+        {
+            runs.add(/*empty*/ 0, (uint64_t) (cell->x - x));
+            runs.add(cell->code, 1);
+            x = cell->x + 1;
+        }
+        runs.add(/*empty*/ 0, (uint64_t) (width - 1 - x));
+        runs.add(kBorderCode, 1);
+    }
+    runs.add(kBorderCode, (uint64_t) width); //< The bottom row.
+    runs.flush();
+
+    return buffer;
+}
+
+FieldEncoder::Buffer FieldEncoder::encodeDelta(const Vampires& vampires)
+{
+    if (vampires.changedCells().empty())
+        return nullptr;
+
+    // A cell may have changed several times during the tick; only its final state matters.
+    std::vector<Vampires::Cell> cells = vampires.changedCells();
+    const auto byPosition =
+        [](const Vampires::Cell& a, const Vampires::Cell& b)
+        {
+            return a.y != b.y ? a.y < b.y : a.x < b.x;
+        };
+    std::sort(cells.begin(), cells.end(), byPosition);
+    cells.erase(std::unique(cells.begin(), cells.end(),
+        [](const Vampires::Cell& a, const Vampires::Cell& b)
+        {
+            return a.x == b.x && a.y == b.y;
+        }),
+        cells.end());
+
+    auto buffer = std::make_shared<std::string>();
+    buffer->reserve(/*header*/ 1 + /*count*/ 5 + cells.size() * /*typical cell*/ 3);
+    buffer->push_back('D');
+    appendVarint(buffer.get(), (uint64_t) cells.size());
+    for (const auto& cell: cells)
+    {
+        appendVarint(buffer.get(), (uint64_t) cell.x);
+        appendVarint(buffer.get(), (uint64_t) cell.y);
+        buffer->push_back((char) cellCode(vampires, cell.x, cell.y));
+    }
+
+    return buffer;
+}
+
+} // namespace ms::vampires_nx_vms_plugin
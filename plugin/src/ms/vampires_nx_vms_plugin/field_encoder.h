@@ -0,0 +1,52 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "vampires.h"
+
+namespace ms::vampires_nx_vms_plugin {
+
+/**
+ * Encodes the game field into a compact binary stream for spectators. The stream consists of
+ * messages of two kinds: a keyframe carries the whole field, and a delta carries the cells changed
+ * since the previous message. All numbers are unsigned LEB128 varints.
+ *
+ * Keyframe: `'K' width height run...`, where each run is `(length << 3) | cellCode`, and the runs
+ * cover the field row by row.
+ *
+ * Delta: `'D' count (x y cellCode)...`, where each cell is listed at most once.
+ *
+ * Cell code is 0 for an empty cell, otherwise `1 + (int) Vampires::Item::Kind`.
+ *
+ * The messages are immutable once built, so one instance can be shared by all the spectators.
+ */
+class FieldEncoder
+{
+public:
+    using Buffer = std::shared_ptr<const std::string>;
+
+    static Buffer encodeKeyframe(const Vampires& vampires);
+
+    /** @return Null if there are no changed cells. */
+    static Buffer encodeDelta(const Vampires& vampires);
+
+    static int cellCode(const Vampires::Item* item)
+    {
+        return item ? cellCode(item->kind) : 0;
+    }
+
+    static constexpr int cellCode(Vampires::Item::Kind kind) { return 1 + (int) kind; }
+
+    /** @return Code of the cell, the border cells having the code of Item::Kind::border. */
+    static int cellCode(const Vampires& vampires, int x, int y)
+    {
+        return vampires.isBorder(x, y)
+            ? cellCode(Vampires::Item::Kind::border)
+            : cellCode(vampires.itemAt(x, y).get());
+    }
+};
+
+} // namespace ms::vampires_nx_vms_plugin
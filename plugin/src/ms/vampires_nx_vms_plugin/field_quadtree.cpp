@@ -0,0 +1,247 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "field_quadtree.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <tuple>
+
+#include <nx/kit/debug.h>
+
+namespace ms::vampires_nx_vms_plugin {
+
+static FieldQuadtree::Rect intersection(const FieldQuadtree::Rect& a, const FieldQuadtree::Rect& b)
+{
+    const int left = std::max(a.x, b.x);
+    const int top = std::max(a.y, b.y);
+    const int right = std::min(a.x + a.width, b.x + b.width);
+    const int bottom = std::min(a.y + a.height, b.y + b.height);
+    if (right <= left || bottom <= top)
+        return {};
+    return {left, top, right - left, bottom - top};
+}
+
+/** 64-bit, because the root square of a huge field may have more than INT_MAX cells. */
+static int64_t area(const FieldQuadtree::Rect& rect)
+{
+    return (int64_t) rect.width * rect.height;
+}
+
+static int64_t area(int squareSize)
+{
+    return (int64_t) squareSize * squareSize;
+}
+
+FieldQuadtree::FieldQuadtree(int width, int height):
+    m_width(width),
+    m_height(height)
+{
+    while (m_rootSize < width || m_rootSize < height)
+        m_rootSize *= 2;
+}
+
+void FieldQuadtree::add(int kind, int x, int y)
+{
+    update(kind, x, y, +1);
+}
+
+void FieldQuadtree::remove(int kind, int x, int y)
+{
+    update(kind, x, y, -1);
+}
+
+void FieldQuadtree::update(int kind, int x, int y, int delta)
+{
+    if (!NX_KIT_ASSERT(kind >= 0 && kind < kKindCount)
+        || !NX_KIT_ASSERT(x >= 0 && x < m_width && y >= 0 && y < m_height))
+    {
+        return;
+    }
+
+    Node* node = &m_root;
+    for (int size = m_rootSize; ; size /= 2)
+    {
+        node->counts[kind] += delta;
+        node->total += delta;
+        NX_KIT_ASSERT(node->counts[kind] >= 0);
+        if (size == 1)
+            return;
+
+        const int half = size / 2;
+        const int quadrant = ((y & half) ? 2 : 0) + ((x & half) ? 1 : 0);
+        std::unique_ptr<Node>& child = node->children[quadrant];
+        if (!child)
+        {
+            if (!NX_KIT_ASSERT(delta > 0, "Removing an item from an empty cell."))
+                return;
+            child = std::make_unique<Node>();
+        }
+        if (delta < 0 && child->total + delta == 0)
+        {
+            child.reset(); //< The whole quadrant becomes empty.
+            return;
+        }
+        node = child.get();
+    }
+}
+
+int FieldQuadtree::count(const Rect& region) const
+{
+    return count(Square{&m_root, 0, 0, m_rootSize}, region);
+}
+
+int FieldQuadtree::count(const Square& square, const Rect& region) const
+{
+    const Rect squareRect{square.x, square.y, square.size, square.size};
+    const Rect overlap = intersection(squareRect, region);
+    if (area(overlap) == 0 || square.node->total == 0)
+        return 0;
+    if (area(overlap) == area(square.size))
+        return square.node->total;
+
+    int result = 0;
+    forEachChild(square, region,
+        [&](const Square& child) { result += count(child, region); });
+    return result;
+}
+
+/** Calls the visitor for each non-empty child quadrant overlapping the region. */
+template<typename Visitor>
+void FieldQuadtree::forEachChild(const Square& square, const Rect& region, Visitor visitor)
+{
+    const int half = square.size / 2;
+    for (int quadrant = 0; quadrant < 4; ++quadrant)
+    {
+        const Node* const child = square.node->children[quadrant].get();
+        if (!child)
+            continue;
+        const Square childSquare{child,
+            square.x + ((quadrant & 1) ? half : 0),
+            square.y + ((quadrant & 2) ? half : 0),
+            half};
+        if (area(intersection({childSquare.x, childSquare.y, half, half}, region)) > 0)
+            visitor(childSquare);
+    }
+}
+
+FieldQuadtree::Block FieldQuadtree::makeBlock(const Square& square, const Rect& region)
+{
+    Block block;
+    block.rect = intersection({square.x, square.y, square.size, square.size}, region);
+    const auto& counts = square.node->counts;
+    block.kind = (int) (std::max_element(counts.begin(), counts.end()) - counts.begin());
+
+    // The counts are exact for the region only if the square lies within it.
+    block.isUniform = area(block.rect) == area(square.size)
+        && counts[block.kind] == area(block.rect);
+    return block;
+}
+
+std::vector<FieldQuadtree::Block> FieldQuadtree::aggregate(const Rect& region, int budget) const
+{
+    const Rect clippedRegion = intersection(region, {0, 0, m_width, m_height});
+
+    std::vector<Block> result;
+    std::vector<Square> level;
+    if (m_root.total > 0 && area(clippedRegion) > 0)
+        level.push_back({&m_root, 0, 0, m_rootSize});
+
+    std::vector<Square> mixed;
+    std::vector<Square> nextLevel;
+    while (!level.empty())
+    {
+        // Uniform nodes are final; each mixed node is one block if the refinement stops here.
+        mixed.clear();
+        for (const Square& square: level)
+        {
+            const Block block = makeBlock(square, clippedRegion);
+            if (block.isUniform)
+                result.push_back(block);
+            else
+                mixed.push_back(square);
+        }
+        if (mixed.empty())
+            break;
+
+        nextLevel.clear();
+        for (const Square& square: mixed)
+        {
+            forEachChild(square, clippedRegion,
+                [&](const Square& child) { nextLevel.push_back(child); });
+        }
+
+        if (budget > 0 && (int) (result.size() + nextLevel.size()) > budget)
+        {
+            for (const Square& square: mixed)
+            {
+                // A square sticking out of the region may have all its items outside of it.
+                if (count(square, clippedRegion) > 0)
+                    result.push_back(makeBlock(square, clippedRegion));
+            }
+            break;
+        }
+        std::swap(level, nextLevel);
+    }
+    return result;
+}
+
+/** @return Squared distance from the point to the nearest cell of the square. */
+static int64_t distance2(int x, int y, int squareX, int squareY, int squareSize)
+{
+    const int64_t dx = std::max({squareX - x, 0, x - (squareX + squareSize - 1)});
+    const int64_t dy = std::max({squareY - y, 0, y - (squareY + squareSize - 1)});
+    return dx * dx + dy * dy;
+}
+
+std::optional<FieldQuadtree::Point> FieldQuadtree::nearest(int kind, int x, int y) const
+{
+    if (!NX_KIT_ASSERT(kind >= 0 && kind < kKindCount))
+        return std::nullopt;
+
+    Nearest best;
+    nearest(Square{&m_root, 0, 0, m_rootSize}, kind, x, y, &best);
+    if (best.distance2 == INT64_MAX)
+        return std::nullopt;
+    return best.point;
+}
+
+void FieldQuadtree::nearest(const Square& square, int kind, int x, int y, Nearest* best)
+{
+    if (square.node->counts[kind] == 0
+        || distance2(x, y, square.x, square.y, square.size) > best->distance2)
+    {
+        return;
+    }
+
+    if (square.size == 1)
+    {
+        const Point point{square.x, square.y};
+        const int64_t d2 = distance2(x, y, point.x, point.y, /*squareSize*/ 1);
+        const auto order = [](int64_t d, const Point& p) { return std::tuple(d, p.y, p.x); };
+        if (order(d2, point) < order(best->distance2, best->point))
+            *best = {d2, point};
+        return;
+    }
+
+    // The children, the closest first, via the insertion sort: there are at most four of them.
+    std::array<Square, 4> children;
+    std::array<int64_t, 4> childDistances2;
+    int childCount = 0;
+    forEachChild(square, Rect{square.x, square.y, square.size, square.size},
+        [&](const Square& child)
+        {
+            const int64_t d2 = distance2(x, y, child.x, child.y, child.size);
+            int i = childCount++;
+            for (; i > 0 && childDistances2[i - 1] > d2; --i)
+            {
+                children[i] = children[i - 1];
+                childDistances2[i] = childDistances2[i - 1];
+            }
+            children[i] = child;
+            childDistances2[i] = d2;
+        });
+    for (int i = 0; i < childCount; ++i)
+        nearest(children[i], kind, x, y, best);
+}
+
+} // namespace ms::vampires_nx_vms_plugin
@@ -0,0 +1,110 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace ms::vampires_nx_vms_plugin {
+
+/**
+ * Sparse region quadtree counting the occupied cells of each item kind, used to render a dense
+ * field with a bounded number of rectangles. Only the nodes containing occupied cells exist, so
+ * the memory depends on the number of items rather than on the field area. Each update walks a
+ * single root-to-leaf path.
+ */
+class FieldQuadtree
+{
+public:
+    /** Item kinds are passed as ints in range [0, kKindCount). */
+    static constexpr int kKindCount = 4;
+
+    struct Rect
+    {
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    struct Point
+    {
+        int x = 0;
+        int y = 0;
+    };
+
+    /** Rectangle to be rendered as a single object. */
+    struct Block
+    {
+        Rect rect;
+        int kind = -1; /**< If not uniform, the kind of the majority of the occupied cells. */
+        bool isUniform = false; /**< Whether all cells of the rect are occupied by `kind`. */
+    };
+
+public:
+    FieldQuadtree(int width, int height);
+
+    void add(int kind, int x, int y);
+    void remove(int kind, int x, int y);
+
+    /** @return Number of the occupied cells in the region. */
+    int count(const Rect& region) const;
+
+    /**
+     * Covers the occupied cells of the region with at most `budget` blocks (if budget > 0): the
+     * tree is refined level by level while the next level still fits the budget, so uniform
+     * regions collapse into one block, and the remaining mixed nodes become approximate blocks.
+     * Empty regions produce no blocks.
+     */
+    std::vector<Block> aggregate(const Rect& region, int budget) const;
+
+    /**
+     * @return Occupied cell of the kind nearest to the given point by the Euclidean distance;
+     *     ties are resolved to the smallest y, then x. Nullopt if there are no such cells.
+     *     Visits only the quadrants containing the kind which may be closer than the best cell
+     *     found so far, nearer quadrants first.
+     */
+    std::optional<Point> nearest(int kind, int x, int y) const;
+
+private:
+    struct Node
+    {
+        std::array<int, kKindCount> counts{};
+        int total = 0;
+        std::array<std::unique_ptr<Node>, 4> children; /**< Null for empty quadrants. */
+    };
+
+    /** Node with its square; the square may stick out of the field. */
+    struct Square
+    {
+        const Node* node = nullptr;
+        int x = 0;
+        int y = 0;
+        int size = 0;
+    };
+
+    void update(int kind, int x, int y, int delta);
+    int count(const Square& square, const Rect& region) const;
+    static Block makeBlock(const Square& square, const Rect& region);
+    template<typename Visitor>
+    static void forEachChild(const Square& square, const Rect& region, Visitor visitor);
+
+    struct Nearest
+    {
+        int64_t distance2 = INT64_MAX; /**< Squared distance to `point`. */
+        Point point;
+    };
+
+    static void nearest(const Square& square, int kind, int x, int y, Nearest* best);
+
+private:
+    const int m_width;
+    const int m_height;
+    int m_rootSize = 1; /**< Power of two, covering the field. */
+    Node m_root;
+};
+
+} // namespace ms::vampires_nx_vms_plugin
@@ -28,6 +28,7 @@ Result<IEngine*> Integration::doObtainEngine()
  * - description: Description of the Integration in a few sentences.
  * - version: Version of the Integration.
  * - vendor: Integration creator (person or company) name.
+ * - engineSettingsModel: Settings of the Engine, which are common for all the cameras.
  */
 std::string Integration::manifestString() const
 {
@@ -37,7 +38,28 @@ std::string Integration::manifestString() const
     "name": "Vampires Plugin",
     "description": "Game from the Soviet computer AGAT by Roman Bader, 1987.",
     "version": "3.0.0",
-    "vendor": "Mike Shevchenko (mike.shevchenko@gmail.com)"
+    "vendor": "Mike Shevchenko (mike.shevchenko@gmail.com)",
+    "engineSettingsModel": {
+        "type": "Settings",
+        "items": [
+            {
+                "type": "CheckBox",
+                "name": ")json" + Engine::kSharedWorldSetting + R"json(",
+                "caption": "Shared world",
+                "description": "All cameras show the same game, run by the first one of them, with the game settings of that camera.",
+                "defaultValue": false
+            },
+            {
+                "type": "SpinBox",
+                "name": ")json" + Engine::kMetricsPortSetting + R"json(",
+                "caption": "Metrics port (0 - disabled)",
+                "description": "Prometheus metrics are served at http://127.0.0.1:<port>/metrics.",
+                "defaultValue": 0,
+                "minValue": 0,
+                "maxValue": 65535
+            }
+        ]
+    }
 }
 )json";
 }
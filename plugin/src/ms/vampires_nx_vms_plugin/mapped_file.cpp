@@ -0,0 +1,105 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "mapped_file.h"
+
+#include <cerrno>
+#include <system_error>
+
+#if defined(_WIN32)
+    #if !defined(NOMINMAX)
+        #define NOMINMAX
+    #endif
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include <nx/kit/utils.h>
+
+namespace ms::vampires_nx_vms_plugin {
+
+using nx::kit::utils::toString;
+
+/** Allows to be called as `return error(outError, "...");`. */
+static std::unique_ptr<MappedFile> error(std::string* outError, const std::string& message)
+{
+    #if defined(_WIN32)
+        const int code = (int) GetLastError();
+    #else
+        const int code = errno;
+    #endif
+    *outError = message + ": " + std::system_category().message(code);
+    return nullptr;
+}
+
+std::unique_ptr<MappedFile> MappedFile::open(const std::string& path, std::string* outError)
+{
+    auto file = std::unique_ptr<MappedFile>(new MappedFile());
+
+    #if defined(_WIN32)
+        const HANDLE fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+            /*securityAttributes*/ nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+            /*templateFile*/ nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE)
+            return error(outError, "Unable to open " + toString(path));
+        file->m_fileHandle = fileHandle;
+
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(fileHandle, &size))
+            return error(outError, "Unable to get the size of " + toString(path));
+        file->m_size = (size_t) size.QuadPart;
+        if (file->m_size == 0)
+            return file; //< Empty files cannot be mapped.
+
+        file->m_mappingHandle = CreateFileMappingA(fileHandle, /*attributes*/ nullptr,
+            PAGE_READONLY, /*sizeHigh*/ 0, /*sizeLow*/ 0, /*name*/ nullptr);
+        if (!file->m_mappingHandle)
+            return error(outError, "Unable to map " + toString(path));
+
+        file->m_data = (const uint8_t*) MapViewOfFile(
+            file->m_mappingHandle, FILE_MAP_READ, 0, 0, file->m_size);
+        if (!file->m_data)
+            return error(outError, "Unable to map " + toString(path));
+    #else
+        file->m_fd = ::open(path.c_str(), O_RDONLY);
+        if (file->m_fd < 0)
+            return error(outError, "Unable to open " + toString(path));
+
+        struct stat fileStat{};
+        if (fstat(file->m_fd, &fileStat) != 0)
+            return error(outError, "Unable to get the size of " + toString(path));
+        file->m_size = (size_t) fileStat.st_size;
+        if (file->m_size == 0)
+            return file; //< Empty files cannot be mapped.
+
+        void* const address = mmap(
+            nullptr, file->m_size, PROT_READ, MAP_PRIVATE, file->m_fd, /*offset*/ 0);
+        if (address == MAP_FAILED)
+            return error(outError, "Unable to map " + toString(path));
+        file->m_data = (const uint8_t*) address;
+    #endif
+
+    return file;
+}
+
+MappedFile::~MappedFile()
+{
+    #if defined(_WIN32)
+        if (m_data)
+            UnmapViewOfFile(m_data);
+        if (m_mappingHandle)
+            CloseHandle(m_mappingHandle);
+        if (m_fileHandle)
+            CloseHandle(m_fileHandle);
+    #else
+        if (m_data)
+            munmap((void*) m_data, m_size);
+        if (m_fd >= 0)
+            close(m_fd);
+    #endif
+}
+
+} // namespace ms::vampires_nx_vms_plugin
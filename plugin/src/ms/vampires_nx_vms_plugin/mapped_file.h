@@ -0,0 +1,41 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace ms::vampires_nx_vms_plugin {
+
+/** Read-only memory mapping of a whole file. */
+class MappedFile
+{
+public:
+    /** @return Null on failure, with the reason in outError. */
+    static std::unique_ptr<MappedFile> open(const std::string& path, std::string* outError);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    MappedFile() = default;
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    #if defined(_WIN32)
+        void* m_fileHandle = nullptr;
+        void* m_mappingHandle = nullptr;
+    #else
+        int m_fd = -1;
+    #endif
+};
+
+} // namespace ms::vampires_nx_vms_plugin
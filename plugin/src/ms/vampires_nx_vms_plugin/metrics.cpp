@@ -0,0 +1,132 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "metrics.h"
+
+#include <algorithm>
+
+#include <nx/kit/debug.h>
+#include <nx/kit/utils.h>
+
+namespace ms::vampires_nx_vms_plugin {
+
+using nx::kit::utils::format;
+
+int Metric::shardIndex() noexcept
+{
+    static std::atomic<int> threadCount{0};
+    static thread_local const int index =
+        threadCount.fetch_add(1, std::memory_order_relaxed) % kShardCount;
+    return index;
+}
+
+void Metric::appendHeader(std::string* text, const char* type) const
+{
+    *text += "# HELP " + m_name + " " + m_help + "\n";
+    *text += "# TYPE " + m_name + " " + type + "\n";
+}
+
+uint64_t Counter::value() const noexcept
+{
+    uint64_t result = 0;
+    for (const auto& shard: m_shards)
+        result += shard.value.load(std::memory_order_relaxed);
+    return result;
+}
+
+void Counter::appendText(std::string* text) const
+{
+    appendHeader(text, "counter");
+    *text += name() + " " + std::to_string(value()) + "\n";
+}
+
+Histogram::Histogram(std::string name, std::string help, std::vector<double> upperBounds):
+    Metric(std::move(name), std::move(help)),
+    m_upperBounds(std::move(upperBounds))
+{
+    NX_KIT_ASSERT((int) m_upperBounds.size() <= kMaxBucketCount);
+    NX_KIT_ASSERT(std::is_sorted(m_upperBounds.begin(), m_upperBounds.end()));
+}
+
+void Histogram::observe(double value) noexcept
+{
+    // The buckets are few, so a linear search is faster than a binary one.
+    int bucket = 0;
+    while (bucket < (int) m_upperBounds.size() && value > m_upperBounds[bucket])
+        ++bucket;
+
+    Shard& shard = m_shards[shardIndex()];
+    shard.bucketCounts[bucket].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+uint64_t Histogram::count() const noexcept
+{
+    uint64_t result = 0;
+    for (const auto& shard: m_shards)
+    {
+        for (const auto& bucketCount: shard.bucketCounts)
+            result += bucketCount.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+double Histogram::sum() const noexcept
+{
+    double result = 0;
+    for (const auto& shard: m_shards)
+        result += shard.sum.load(std::memory_order_relaxed);
+    return result;
+}
+
+void Histogram::appendText(std::string* text) const
+{
+    std::array<uint64_t, kMaxBucketCount + 1> bucketCounts{};
+    double sum = 0;
+    for (const auto& shard: m_shards)
+    {
+        for (int i = 0; i <= (int) m_upperBounds.size(); ++i)
+            bucketCounts[i] += shard.bucketCounts[i].load(std::memory_order_relaxed);
+        sum += shard.sum.load(std::memory_order_relaxed);
+    }
+
+    // Prometheus buckets are cumulative; the last one equals the count.
+    appendHeader(text, "histogram");
+    uint64_t cumulativeCount = 0;
+    for (int i = 0; i <= (int) m_upperBounds.size(); ++i)
+    {
+        cumulativeCount += bucketCounts[i];
+        const std::string le =
+            (i < (int) m_upperBounds.size()) ? format("%g", m_upperBounds[i]) : "+Inf";
+        *text += name() + "_bucket{le=\"" + le + "\"} " + std::to_string(cumulativeCount) + "\n";
+    }
+    *text += name() + "_sum " + format("%.9g", sum) + "\n";
+    *text += name() + "_count " + std::to_string(cumulativeCount) + "\n";
+}
+
+Metrics& Metrics::instance()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+std::string Metrics::text() const
+{
+    const Metric* const metrics[] = {
+        &framesReceived,
+        &ticks,
+        &moveVampiresDuration,
+        &objectsPerPacket,
+        &keystrokesReceived,
+        &keystrokesDropped,
+        &controlReconnects,
+        &gamesLost,
+        &gamesWon,
+    };
+
+    std::string text;
+    for (const Metric* metric: metrics)
+        metric->appendText(&text);
+    return text;
+}
+
+} // namespace ms::vampires_nx_vms_plugin
@@ -0,0 +1,135 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ms::vampires_nx_vms_plugin {
+
+/**
+ * Counters and histograms of the plugin, rendered in the Prometheus text exposition format.
+ *
+ * Updating is lock-free and practically contention-free: each thread is assigned one of
+ * kShardCount cache-line-sized shards, and updates only its own shard with relaxed atomics; the
+ * shards are summed up when the metrics are scraped. Thus the game threads never wait for a
+ * scrape, and a scrape sees each shard in some recent state.
+ */
+class Metric
+{
+public:
+    static constexpr int kShardCount = 16;
+
+    Metric(std::string name, std::string help): m_name(std::move(name)), m_help(std::move(help))
+    {
+    }
+
+    virtual ~Metric() = default;
+
+    Metric(const Metric&) = delete;
+    Metric& operator=(const Metric&) = delete;
+
+    const std::string& name() const { return m_name; }
+
+    /** Appends the HELP and TYPE lines, and the samples. */
+    virtual void appendText(std::string* text) const = 0;
+
+protected:
+    /** @return Shard of the calling thread; stays the same for the lifetime of the thread. */
+    static int shardIndex() noexcept;
+
+    void appendHeader(std::string* text, const char* type) const;
+
+private:
+    const std::string m_name;
+    const std::string m_help;
+};
+
+/** Monotonically increasing count of events. */
+class Counter: public Metric
+{
+public:
+    using Metric::Metric;
+
+    void add(uint64_t value = 1) noexcept
+    {
+        m_shards[shardIndex()].value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const noexcept;
+
+    virtual void appendText(std::string* text) const override;
+
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<uint64_t> value{0};
+    };
+
+    std::array<Shard, kShardCount> m_shards;
+};
+
+/** Distribution of observed values over the fixed buckets, with the sum and the count. */
+class Histogram: public Metric
+{
+public:
+    static constexpr int kMaxBucketCount = 15;
+
+    /** @param upperBounds Ascending, at most kMaxBucketCount; the "+Inf" bucket is implied. */
+    Histogram(std::string name, std::string help, std::vector<double> upperBounds);
+
+    void observe(double value) noexcept;
+
+    uint64_t count() const noexcept;
+    double sum() const noexcept;
+
+    virtual void appendText(std::string* text) const override;
+
+private:
+    struct alignas(64) Shard
+    {
+        std::array<std::atomic<uint64_t>, kMaxBucketCount + 1> bucketCounts{}; //< Non-cumulative.
+        std::atomic<double> sum{0};
+    };
+
+    const std::vector<double> m_upperBounds;
+    std::array<Shard, kShardCount> m_shards;
+};
+
+/** Process-wide metrics of the plugin; the names follow the Prometheus conventions. */
+class Metrics
+{
+public:
+    static Metrics& instance();
+
+    /** @return All the metrics in the Prometheus text exposition format (version 0.0.4). */
+    std::string text() const;
+
+    Counter framesReceived{"vampires_frames_received_total",
+        "Video frames received from the Server."};
+    Counter ticks{"vampires_ticks_total",
+        "Game ticks, i.e. moves of the vampires."};
+    Histogram moveVampiresDuration{"vampires_move_vampires_duration_seconds",
+        "Duration of moving the vampires in one tick.",
+        {0.00001, 0.0001, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5}};
+    Histogram objectsPerPacket{"vampires_objects_per_packet",
+        "Number of objects in each metadata packet.",
+        {0, 10, 100, 1000, 10000, 100000}};
+    Counter keystrokesReceived{"vampires_keystrokes_received_total",
+        "Bytes received from the controller."};
+    Counter keystrokesDropped{"vampires_keystrokes_dropped_total",
+        "Received bytes discarded as key repeats or as being late for the frame."};
+    Counter controlReconnects{"vampires_control_reconnects_total",
+        "Times the controller connection was closed and listened for again."};
+    Counter gamesLost{"vampires_games_lost_total", "Games in which a vampire caught the player."};
+    Counter gamesWon{"vampires_games_won_total", "Games in which the vampires were defeated."};
+
+private:
+    Metrics() = default;
+};
+
+} // namespace ms::vampires_nx_vms_plugin
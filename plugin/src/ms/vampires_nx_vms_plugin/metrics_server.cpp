@@ -0,0 +1,201 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "metrics_server.h"
+
+#include <chrono>
+#include <cstring>
+#include <string>
+
+#if !defined(_WIN32)
+    #include <sys/select.h>
+#endif
+
+#include <nx/kit/debug.h>
+#include <nx/sdk/helpers/span_recorder.h>
+
+#include "metrics.h"
+#include "socket_utils.h"
+
+namespace ms::vampires_nx_vms_plugin {
+
+using nx::kit::utils::format;
+
+/** Allows to be called as `return error("%1...", args);`. */
+template<typename... Args>
+static bool error(Args&&... args) noexcept
+{
+    NX_PRINT << "ERROR: " << format(std::forward<decltype(args)>(args)...) << ": " +
+        lastSocketErrorMessage();
+    return false;
+}
+
+/** @return Whether the socket has become readable (or has an incoming connection) in time. */
+static bool waitForReadable(int fd, int timeoutMs) noexcept
+{
+    fd_set readFds;
+    FD_ZERO(&readFds);
+    FD_SET(fd, &readFds);
+    timeval timeout{timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+    return select(fd + 1, &readFds, /*writeFds*/ nullptr, /*exceptFds*/ nullptr, &timeout) > 0;
+}
+
+/** @return Whether the socket has become writable in time. */
+static bool waitForWritable(int fd, int timeoutMs) noexcept
+{
+    fd_set writeFds;
+    FD_ZERO(&writeFds);
+    FD_SET(fd, &writeFds);
+    timeval timeout{timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+    return select(fd + 1, /*readFds*/ nullptr, &writeFds, /*exceptFds*/ nullptr, &timeout) > 0;
+}
+
+static std::string httpResponse(
+    const std::string& status, const std::string& contentType, const std::string& body)
+{
+    return "HTTP/1.1 " + status + "\r\n"
+        "Content-Type: " + contentType + "\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        "Connection: close\r\n"
+        "\r\n"
+        + body;
+}
+
+MetricsServer::MetricsServer() noexcept
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+    m_isStopping = true;
+    if (m_thread.joinable())
+        m_thread.join();
+    if (m_socketFd >= 0)
+        closeSocketFd(m_socketFd);
+}
+
+bool MetricsServer::start(int port) noexcept
+{
+    if (!NX_KIT_ASSERT(port > 0) || !NX_KIT_ASSERT(port <= 65535))
+        return false;
+    if (!NX_KIT_ASSERT(m_socketFd < 0))
+        return false;
+
+    m_port = port;
+
+    if ((m_socketFd = (int) socket(PF_INET, SOCK_STREAM, /*protocol*/ 0)) < 0)
+        return error("Metrics socket creation failed");
+
+    sockaddr_in localAddr;
+    memset(&localAddr, 0, sizeof(localAddr));
+    localAddr.sin_family = AF_INET;
+    localAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    localAddr.sin_port = htons(m_port);
+
+    if (bind(m_socketFd, (sockaddr*) &localAddr, sizeof(localAddr)) < 0)
+        return error("Unable to bind on the metrics socket at port %d", m_port);
+
+    if (listen(m_socketFd, /*backlog*/ 16) < 0)
+        return error("Unable to listen on the metrics socket");
+
+    m_thread = std::thread([this]() { run(); });
+
+    NX_PRINT << "\n####### Metrics are available at http://127.0.0.1:" << m_port << "/metrics\n";
+    return true;
+}
+
+void MetricsServer::run() noexcept
+{
+    while (!m_isStopping)
+    {
+        if (!waitForReadable(m_socketFd, kPollPeriodMs))
+            continue;
+
+        const int fd = (int) accept(m_socketFd, /*addr*/ nullptr, /*addrlen*/ nullptr);
+        if (fd < 0)
+        {
+            error("Unable to accept on the metrics socket");
+            continue;
+        }
+
+        // A client which stops reading must not block the thread: see sendAll().
+        if (setSocketNonBlocking(fd))
+            serveClient(fd);
+        else
+            error("Unable to make the metrics client socket non-blocking");
+        closeSocketFd(fd);
+    }
+}
+
+void MetricsServer::serveClient(int fd) noexcept
+{
+    // Only the request line matters; the headers are read just to let the client finish sending.
+    std::string request;
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(kRequestTimeoutMs);
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192)
+    {
+        if (m_isStopping || std::chrono::steady_clock::now() > deadline)
+            return;
+        if (!waitForReadable(fd, kPollPeriodMs))
+            continue;
+        char buffer[1024];
+        const int r = (int) recv(fd, buffer, sizeof(buffer), /*flags*/ 0);
+        if (r < 0 && lastSocketErrorIsWouldBlock())
+            continue;
+        if (r <= 0)
+            return;
+        request.append(buffer, (size_t) r);
+    }
+
+    std::string response;
+    if (request.starts_with("GET /metrics ") || request.starts_with("GET /metrics?"))
+    {
+        response = httpResponse("200 OK", "text/plain; version=0.0.4; charset=utf-8",
+            Metrics::instance().text());
+    }
+    else if (request.starts_with("GET /trace ") || request.starts_with("GET /trace?"))
+    {
+        response = httpResponse("200 OK", "application/json",
+            nx::sdk::SpanRecorder::instance().chromeTraceJson());
+    }
+    else if (request.starts_with("GET "))
+    {
+        response = httpResponse("404 Not Found", "text/plain", "Try /metrics or /trace\n");
+    }
+    else
+    {
+        response = httpResponse("400 Bad Request", "text/plain", "");
+    }
+
+    if (!sendAll(fd, response))
+        error("Unable to send the metrics");
+}
+
+/**
+ * Sends the whole data via the non-blocking socket, waiting for the client to read it for at most
+ * kRequestTimeoutMs, or until the server is stopping.
+ */
+bool MetricsServer::sendAll(int fd, const std::string& data) const noexcept
+{
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(kRequestTimeoutMs);
+    size_t sentBytes = 0;
+    while (sentBytes < data.size())
+    {
+        if (m_isStopping || std::chrono::steady_clock::now() > deadline)
+            return false;
+        const ConstBuffer buffer{data.data() + sentBytes, data.size() - sentBytes};
+        const long long r = sendBuffers(fd, &buffer, /*count*/ 1);
+        if (r < 0 && lastSocketErrorIsWouldBlock())
+        {
+            waitForWritable(fd, kPollPeriodMs);
+            continue;
+        }
+        if (r <= 0)
+            return false;
+        sentBytes += (size_t) r;
+    }
+    return true;
+}
+
+} // namespace ms::vampires_nx_vms_plugin
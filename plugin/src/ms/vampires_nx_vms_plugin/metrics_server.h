@@ -0,0 +1,49 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace ms::vampires_nx_vms_plugin {
+
+/**
+ * Minimal HTTP server exposing Metrics::instance() at "/metrics" for Prometheus scrapers, and the
+ * spans recorded by nx::sdk::SpanRecorder at "/trace" as Chrome trace-event JSON. Listens
+ * on the loopback interface only, and serves one request at a time from a single background
+ * thread, so the game threads are never involved.
+ */
+class MetricsServer final
+{
+public:
+    MetricsServer() noexcept;
+    ~MetricsServer();
+
+    /** Opens the socket and starts the serving thread. */
+    bool start(int port) noexcept;
+
+    int port() const { return m_port; }
+
+private:
+    void run() noexcept;
+    void serveClient(int fd) noexcept;
+    bool sendAll(int fd, const std::string& data) const noexcept;
+
+private:
+    /** How often the serving thread checks whether it has to stop. */
+    static constexpr int kPollPeriodMs = 200;
+
+    /**
+     * A client which does not send its request in time, or does not read the response in time,
+     * is disconnected.
+     */
+    static constexpr int kRequestTimeoutMs = 2000;
+
+    int m_port = -1;
+    int m_socketFd = -1;
+    std::atomic<bool> m_isStopping{false};
+    std::thread m_thread;
+};
+
+} // namespace ms::vampires_nx_vms_plugin
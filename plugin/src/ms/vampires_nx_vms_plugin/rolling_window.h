@@ -0,0 +1,67 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+
+namespace ms::vampires_nx_vms_plugin {
+
+/**
+ * Statistics of the last kCapacity samples. Never allocates; adding a sample and querying the
+ * average are O(1) via a running sum, while max() scans the window. The running sum is
+ * recomputed once per kCapacity samples, so that rounding errors do not accumulate.
+ */
+template<int kCapacity>
+class RollingWindow
+{
+public:
+    static_assert(kCapacity > 0);
+
+    void add(double value)
+    {
+        if (m_count == kCapacity)
+            m_sum -= m_samples[m_next];
+        else
+            ++m_count;
+        m_samples[m_next] = value;
+        m_sum += value;
+        m_next = (m_next + 1) % kCapacity;
+
+        if (m_next == 0)
+        {
+            m_sum = 0;
+            for (const double sample: m_samples)
+                m_sum += sample;
+        }
+    }
+
+    int count() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+
+    /** @return 0 if empty. */
+    double average() const { return (m_count == 0) ? 0 : m_sum / m_count; }
+
+    /** @return 0 if empty. */
+    double max() const
+    {
+        if (m_count == 0)
+            return 0;
+        return *std::max_element(m_samples.begin(), m_samples.begin() + m_count);
+    }
+
+    void clear()
+    {
+        m_count = 0;
+        m_next = 0;
+        m_sum = 0;
+    }
+
+private:
+    std::array<double, kCapacity> m_samples{};
+    int m_count = 0;
+    int m_next = 0; /**< Index of the slot for the next sample, which is the oldest one if full. */
+    double m_sum = 0;
+};
+
+} // namespace ms::vampires_nx_vms_plugin
@@ -0,0 +1,86 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "shared_memory_reader.h"
+
+#include <cerrno>
+#include <system_error>
+
+#include <nx/kit/debug.h>
+#include <nx/kit/utils.h>
+
+#include "metrics.h"
+
+namespace ms::vampires_nx_vms_plugin {
+
+using nx::kit::utils::format;
+using nx::kit::utils::toString;
+
+static std::string lastErrorMessage() noexcept
+{
+    #if defined(_WIN32)
+        return std::system_category().message((int) GetLastError());
+    #else
+        return std::system_category().message(errno);
+    #endif
+}
+
+static void printWelcomeMessage(const std::string& name, const std::string& osName) noexcept
+{
+    NX_PRINT << format(
+R"(
+
+###################################################################################################
+ATTENTION: Waiting for keystrokes in shared memory %s.
+
+Execute the following command in another terminal on the same machine:
+    ms_netcat --shm %s
+)", toString(osName).c_str(), name.c_str());
+}
+
+SharedMemoryReader::~SharedMemoryReader()
+{
+    if (m_mapping)
+        NX_PRINT << "\n####### Closing the shared memory " << toString(m_mapping->osName());
+}
+
+bool SharedMemoryReader::open(const std::string& name) noexcept
+{
+    if (!NX_KIT_ASSERT(!m_mapping) || !NX_KIT_ASSERT(!name.empty()))
+        return false;
+
+    m_mapping = SharedMemoryRingMapping::create(name);
+    if (!m_mapping)
+    {
+        NX_PRINT << "ERROR: Unable to create the shared memory "
+            << toString(SharedMemoryRingMapping::osName(name)) << ": " << lastErrorMessage();
+        return false;
+    }
+
+    printWelcomeMessage(name, m_mapping->osName());
+    return true;
+}
+
+void SharedMemoryReader::takeKeys(std::vector<PlayerKey>* keys) noexcept
+{
+    if (!m_mapping)
+        return;
+
+    const std::optional<char> c = m_mapping->ring()->pop();
+    if (!c)
+        return;
+
+    if (!m_hasReceivedData)
+    {
+        NX_PRINT << "\n####### Received first keystroke: " << toString(*c);
+        m_hasReceivedData = true;
+    }
+    keys->push_back({/*player*/ 0, *c});
+
+    // The rest of the bytes have not been popped, so they are counted as received here.
+    const uint32_t discardedCount = m_mapping->ring()->clear();
+    Metrics& metrics = Metrics::instance();
+    metrics.keystrokesReceived.add(1 + discardedCount);
+    metrics.keystrokesDropped.add(discardedCount);
+}
+
+} // namespace ms::vampires_nx_vms_plugin
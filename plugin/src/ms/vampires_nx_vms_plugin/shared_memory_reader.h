@@ -0,0 +1,33 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "control_reader.h"
+#include "shared_memory_ring.h"
+
+namespace ms::vampires_nx_vms_plugin {
+
+/**
+ * Reads the keystrokes from a SharedMemoryRing written by a local controller. Polling costs a
+ * single atomic load, without any syscall. Not thread-safe.
+ */
+class SharedMemoryReader final: public ControlReader
+{
+public:
+    ~SharedMemoryReader();
+
+    /** Creates the named shared memory segment and waits for a controller to open it. */
+    bool open(const std::string& name) noexcept;
+
+    /** The shared memory has a single writer, so there is a single player. */
+    virtual void takeKeys(std::vector<PlayerKey>* keys) noexcept override;
+
+private:
+    std::unique_ptr<SharedMemoryRingMapping> m_mapping;
+    bool m_hasReceivedData = false;
+};
+
+} // namespace ms::vampires_nx_vms_plugin
@@ -0,0 +1,229 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+/**@file
+ * Header-only, so that it can be shared by the plugin (which creates the ring and reads from it)
+ * and a local controller like ms_netcat (which opens the ring and writes to it).
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#if defined(_WIN32)
+    #if !defined(NOMINMAX)
+        #define NOMINMAX
+    #endif
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace ms::vampires_nx_vms_plugin {
+
+/**
+ * Layout of the shared memory segment through which a local controller sends keystrokes to the
+ * plugin: a single-producer single-consumer ring of bytes. Both sides access it only via atomic
+ * loads and stores, so sending or receiving a keystroke costs no syscall.
+ *
+ * The indices are free-running; `writeIndex - readIndex` is the number of unread bytes.
+ */
+struct SharedMemoryRing
+{
+    static constexpr uint32_t kMagic = 0x504D4156; //< "VAMP" in little-endian.
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kCapacity = 4096; //< Must be a power of two.
+
+    static_assert((kCapacity & (kCapacity - 1)) == 0);
+    static_assert(std::atomic<uint32_t>::is_always_lock_free,
+        "Atomics in shared memory must not rely on a process-local lock.");
+
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+
+    // Each index is written by one side only; keep them on separate cache lines.
+    alignas(64) std::atomic<uint32_t> writeIndex;
+    alignas(64) std::atomic<uint32_t> readIndex;
+    alignas(64) char data[kCapacity];
+
+    /** Called by the creator of the segment; the memory is expected to be zero-filled. */
+    void init()
+    {
+        version = kVersion;
+        writeIndex.store(0, std::memory_order_relaxed);
+        readIndex.store(0, std::memory_order_relaxed);
+        magic.store(kMagic, std::memory_order_release); //< Publishes the fields above.
+    }
+
+    bool isValid() const
+    {
+        return magic.load(std::memory_order_acquire) == kMagic && version == kVersion;
+    }
+
+    /** Producer side. @return False if the ring is full. */
+    bool push(char c)
+    {
+        const uint32_t w = writeIndex.load(std::memory_order_relaxed);
+        if (w - readIndex.load(std::memory_order_acquire) == kCapacity)
+            return false;
+        data[w & (kCapacity - 1)] = c;
+        writeIndex.store(w + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Producer side. @return Whether the consumer has read everything pushed so far. */
+    bool isDrained() const
+    {
+        return readIndex.load(std::memory_order_acquire)
+            == writeIndex.load(std::memory_order_relaxed);
+    }
+
+    /** Consumer side. */
+    std::optional<char> pop()
+    {
+        const uint32_t r = readIndex.load(std::memory_order_relaxed);
+        if (r == writeIndex.load(std::memory_order_acquire))
+            return std::nullopt;
+        const char c = data[r & (kCapacity - 1)];
+        readIndex.store(r + 1, std::memory_order_release);
+        return c;
+    }
+
+    /** Consumer side: discards all unread bytes. @return Number of the discarded bytes. */
+    uint32_t clear()
+    {
+        const uint32_t w = writeIndex.load(std::memory_order_acquire);
+        const uint32_t r = readIndex.load(std::memory_order_relaxed);
+        readIndex.store(w, std::memory_order_release);
+        return w - r;
+    }
+};
+
+/** Maps a named SharedMemoryRing into the address space of the process. */
+class SharedMemoryRingMapping
+{
+public:
+    /**
+     * Creates the segment if needed, and (re)initializes the ring.
+     * @return Null on failure.
+     */
+    static std::unique_ptr<SharedMemoryRingMapping> create(const std::string& name)
+    {
+        auto mapping = std::unique_ptr<SharedMemoryRingMapping>(new SharedMemoryRingMapping());
+        mapping->m_osName = osName(name);
+        #if defined(_WIN32)
+            mapping->m_handle = CreateFileMappingA(INVALID_HANDLE_VALUE, /*attributes*/ nullptr,
+                PAGE_READWRITE, /*sizeHigh*/ 0, (DWORD) sizeof(SharedMemoryRing),
+                mapping->m_osName.c_str());
+            if (!mapping->m_handle)
+                return nullptr;
+        #else
+            mapping->m_fd = shm_open(mapping->m_osName.c_str(), O_CREAT | O_RDWR, 0666);
+            if (mapping->m_fd < 0)
+                return nullptr;
+            mapping->m_isOwner = true;
+            // Let local controllers of any user connect, regardless of the umask.
+            fchmod(mapping->m_fd, 0666);
+            if (ftruncate(mapping->m_fd, (off_t) sizeof(SharedMemoryRing)) != 0)
+                return nullptr;
+        #endif
+        if (!mapping->map())
+            return nullptr;
+        mapping->m_ring->init();
+        return mapping;
+    }
+
+    /**
+     * Opens the segment created by another process.
+     * @return Null on failure.
+     */
+    static std::unique_ptr<SharedMemoryRingMapping> open(const std::string& name)
+    {
+        auto mapping = std::unique_ptr<SharedMemoryRingMapping>(new SharedMemoryRingMapping());
+        mapping->m_osName = osName(name);
+        #if defined(_WIN32)
+            mapping->m_handle = OpenFileMappingA(
+                FILE_MAP_ALL_ACCESS, /*inheritHandle*/ FALSE, mapping->m_osName.c_str());
+            if (!mapping->m_handle)
+                return nullptr;
+        #else
+            mapping->m_fd = shm_open(mapping->m_osName.c_str(), O_RDWR, 0);
+            if (mapping->m_fd < 0)
+                return nullptr;
+        #endif
+        if (!mapping->map() || !mapping->m_ring->isValid())
+            return nullptr;
+        return mapping;
+    }
+
+    ~SharedMemoryRingMapping()
+    {
+        #if defined(_WIN32)
+            if (m_ring)
+                UnmapViewOfFile(m_ring);
+            if (m_handle)
+                CloseHandle(m_handle);
+        #else
+            if (m_ring)
+                munmap(m_ring, sizeof(SharedMemoryRing));
+            if (m_fd >= 0)
+                close(m_fd);
+            if (m_isOwner)
+                shm_unlink(m_osName.c_str());
+        #endif
+    }
+
+    SharedMemoryRing* ring() const { return m_ring; }
+
+    /** @return The name of the segment in the OS namespace. */
+    const std::string& osName() const { return m_osName; }
+
+    static std::string osName(const std::string& name)
+    {
+        #if defined(_WIN32)
+            // The Server is a service running in another session than the controller.
+            return "Global\\" + name;
+        #else
+            return "/" + name;
+        #endif
+    }
+
+private:
+    SharedMemoryRingMapping() = default;
+
+    bool map()
+    {
+        #if defined(_WIN32)
+            void* const address = MapViewOfFile(
+                m_handle, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SharedMemoryRing));
+            if (!address)
+                return false;
+        #else
+            void* const address = mmap(nullptr, sizeof(SharedMemoryRing),
+                PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, /*offset*/ 0);
+            if (address == MAP_FAILED)
+                return false;
+        #endif
+        m_ring = static_cast<SharedMemoryRing*>(address);
+        return true;
+    }
+
+private:
+    std::string m_osName;
+    SharedMemoryRing* m_ring = nullptr;
+    #if defined(_WIN32)
+        HANDLE m_handle = nullptr;
+    #else
+        int m_fd = -1;
+        bool m_isOwner = false;
+    #endif
+};
+
+} // namespace ms::vampires_nx_vms_plugin
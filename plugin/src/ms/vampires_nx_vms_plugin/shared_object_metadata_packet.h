@@ -0,0 +1,52 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <nx/sdk/analytics/i_object_metadata_packet.h>
+#include <nx/sdk/helpers/ref_countable.h>
+#include <nx/sdk/ptr.h>
+
+namespace ms::vampires_nx_vms_plugin {
+
+using ObjectMetadataList = std::vector<nx::sdk::Ptr<const nx::sdk::analytics::IObjectMetadata>>;
+
+/**
+ * Packet referring to an immutable list of objects which can be shared by any number of packets,
+ * e.g. of different cameras: making a packet costs the same regardless of the object count.
+ */
+class SharedObjectMetadataPacket:
+    public nx::sdk::RefCountable<nx::sdk::analytics::IObjectMetadataPacket>
+{
+public:
+    SharedObjectMetadataPacket(
+        std::shared_ptr<const ObjectMetadataList> objects, int64_t timestampUs)
+        :
+        m_objects(std::move(objects)),
+        m_timestampUs(timestampUs)
+    {
+    }
+
+    virtual Flags flags() const override { return Flags::none; }
+    virtual int64_t timestampUs() const override { return m_timestampUs; }
+    virtual int64_t durationUs() const override { return 0; }
+    virtual int count() const override { return (int) m_objects->size(); }
+
+protected:
+    virtual const nx::sdk::analytics::IObjectMetadata* getAt(int index) const override
+    {
+        if (index < 0 || index >= (int) m_objects->size())
+            return nullptr;
+        return nx::sdk::shareToPtr((*m_objects)[index]).releasePtr();
+    }
+
+private:
+    const std::shared_ptr<const ObjectMetadataList> m_objects;
+    const int64_t m_timestampUs;
+};
+
+} // namespace ms::vampires_nx_vms_plugin
@@ -0,0 +1,52 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "shared_world.h"
+
+#include <algorithm>
+
+namespace ms::vampires_nx_vms_plugin {
+
+void SharedWorld::subscribe(const DeviceAgent* deviceAgent)
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    if (std::find(m_subscribers.begin(), m_subscribers.end(), deviceAgent) == m_subscribers.end())
+        m_subscribers.push_back(deviceAgent);
+}
+
+void SharedWorld::unsubscribe(const DeviceAgent* deviceAgent)
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    std::erase(m_subscribers, deviceAgent);
+}
+
+bool SharedWorld::isDriver(const DeviceAgent* deviceAgent) const
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_subscribers.empty() && m_subscribers.front() == deviceAgent;
+}
+
+std::shared_ptr<Vampires> SharedWorld::vampires() const
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    return m_vampires;
+}
+
+void SharedWorld::setVampires(std::shared_ptr<Vampires> vampires)
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    m_vampires = std::move(vampires);
+}
+
+void SharedWorld::publish(std::shared_ptr<const ObjectMetadataList> objects)
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    m_objects = std::move(objects);
+}
+
+std::shared_ptr<const ObjectMetadataList> SharedWorld::objects() const
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    return m_objects;
+}
+
+} // namespace ms::vampires_nx_vms_plugin
@@ -0,0 +1,51 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "shared_object_metadata_packet.h"
+#include "vampires.h"
+
+namespace ms::vampires_nx_vms_plugin {
+
+class DeviceAgent;
+
+/**
+ * Single game shown by all the cameras of an Engine in the shared-world mode, so that the CPU
+ * cost does not depend on the number of cameras.
+ *
+ * The earliest subscribed DeviceAgent is the driver: it runs the game on its frames, and
+ * publishes the objects built for each frame. The other DeviceAgents only send the latest
+ * published objects with their own timestamps. When the driver unsubscribes, the next subscriber
+ * takes over the game. Thread-safe.
+ */
+class SharedWorld final
+{
+public:
+    void subscribe(const DeviceAgent* deviceAgent);
+    void unsubscribe(const DeviceAgent* deviceAgent);
+    bool isDriver(const DeviceAgent* deviceAgent) const;
+
+    /** @return Null if the game has not been started yet. */
+    std::shared_ptr<Vampires> vampires() const;
+
+    /** Called by the driver when it starts a new game. */
+    void setVampires(std::shared_ptr<Vampires> vampires);
+
+    /** Called by the driver for each frame. */
+    void publish(std::shared_ptr<const ObjectMetadataList> objects);
+
+    /** @return Null if nothing has been published yet. */
+    std::shared_ptr<const ObjectMetadataList> objects() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<const DeviceAgent*> m_subscribers; /**< In the order of subscription. */
+    std::shared_ptr<Vampires> m_vampires; /**< Accessed only by the driver. */
+    std::shared_ptr<const ObjectMetadataList> m_objects;
+};
+
+} // namespace ms::vampires_nx_vms_plugin
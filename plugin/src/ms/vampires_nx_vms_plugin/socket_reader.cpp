@@ -2,26 +2,20 @@
 
 #include "socket_reader.h"
 
-#include <system_error>
-
-#if defined(_WIN32)
-    #include <WinSock2.h>
-#else
-    #include <sys/socket.h>
-    #include <sys/types.h>
-    #include <netinet/in.h>
-    #include <arpa/inet.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if !defined(_WIN32)
+    #include <sys/stat.h>
 #endif
 
 #include <nx/kit/debug.h>
 
-namespace ms::vampires_nx_vms_plugin {
+#include "metrics.h"
+#include "socket_utils.h"
 
-using namespace std::chrono_literals;
-
-#if !defined(_WIN32)
-    #error "Currently this socket wrapper is Windows-only."
-#endif
+namespace ms::vampires_nx_vms_plugin {
 
 using nx::kit::utils::format;
 using nx::kit::utils::toString;
@@ -31,11 +25,12 @@ template<typename... Args>
 static bool error(Args&&... args)  noexcept
 {
     NX_PRINT << "ERROR: " << format(std::forward<decltype(args)>(args)...) << ": " +
-        std::system_category().message(WSAGetLastError());
+        lastSocketErrorMessage();
     return false;
 }
 
-SocketReader::SocketReader() noexcept
+SocketReader::SocketReader(int maxConnectionCount) noexcept:
+    m_connections(std::max(1, maxConnectionCount))
 {
 }
 
@@ -45,89 +40,191 @@ SocketReader::~SocketReader()
     closeSocket();
 }
 
+void SocketReader::closeConnection(Connection* connection) noexcept
+{
+    if (connection->dataFd)
+    {
+        if (!closeSocketFd(*connection->dataFd))
+            error("Unable to close the connection");
+        connection->dataFd.reset();
+        connection->hasReceivedData = false;
+    }
+}
+
 void SocketReader::closeSocket() noexcept
 {
+    for (auto& connection: m_connections)
+        closeConnection(&connection);
+
     if (m_socketFd >= 0)
     {
-        if (closesocket(m_socketFd) != 0)
+        if (!closeSocketFd(m_socketFd))
             error("Unable to close the socket");
         m_socketFd = -1;
-        m_dataFd.reset();
-        m_hasReceivedData = false;
+        if (!m_unixSocketPath.empty())
+            std::remove(m_unixSocketPath.c_str());
     }
 }
 
-static void waitForConnection(int socketFd, std::promise<int> dataFdPromise) noexcept
+/** Accepts the pending connections while there are free player slots. */
+void SocketReader::acceptConnections() noexcept
 {
-    sockaddr_in clientAddr;
-    int len = sizeof(sockaddr_in);
-    const int dataFd = (int) accept(socketFd, (sockaddr*) &clientAddr, &len);
-    if (dataFd < 0)
-    {
-        error("Unable to accept on the socket");
+    if (m_socketFd < 0)
         return;
-    }
 
-    NX_PRINT << format("\n####### Connection accepted from %d.%d.%d.%d\n",
-        clientAddr.sin_addr.S_un.S_un_b.s_b1,
-        clientAddr.sin_addr.S_un.S_un_b.s_b2,
-        clientAddr.sin_addr.S_un.S_un_b.s_b3,
-        clientAddr.sin_addr.S_un.S_un_b.s_b4);
+    for (int player = 0; player < (int) m_connections.size(); ++player)
+    {
+        Connection& connection = m_connections[player];
+        if (connection.dataFd)
+            continue;
 
-    dataFdPromise.set_value(dataFd);
+        sockaddr_storage clientAddr;
+        SocketLen len = sizeof(clientAddr);
+        const int dataFd = (int) accept(m_socketFd, (sockaddr*) &clientAddr, &len);
+        if (dataFd < 0)
+        {
+            if (!lastSocketErrorIsWouldBlock())
+                error("Unable to accept on the socket");
+            return;
+        }
+
+        const std::string playerSuffix =
+            (m_connections.size() > 1) ? format(" for player %d", player + 1) : "";
+        if (clientAddr.ss_family == AF_INET)
+        {
+            NX_PRINT << "\n####### Connection accepted from "
+                << ipv4AddressToString((const sockaddr_in&) clientAddr) << playerSuffix << "\n";
+        }
+        else
+        {
+            NX_PRINT << "\n####### Local connection accepted" << playerSuffix << "\n";
+        }
+
+        if (!setSocketNonBlocking(dataFd))
+            error("Unable to set the socket to non-blocking mode");
+        connection.dataFd = dataFd;
+    }
 }
 
-static void printWelcomeMessage(int port) noexcept
+static std::string playersNote(int maxConnectionCount) noexcept
+{
+    if (maxConnectionCount == 1)
+        return "";
+    return format(" (up to %d players, each via a separate connection)", maxConnectionCount);
+}
+
+static void printTcpWelcomeMessage(int port, int maxConnectionCount) noexcept
 {
     NX_PRINT << format(
 R"(
 
 ###################################################################################################
-ATTENTION: Waiting for incoming connection at port %d.
+ATTENTION: Waiting for incoming connection at port %d%s.
 
 Execute the following command in another terminal:
-    Linux or Cygwin:
-        stty -icanon && nc localhost %d
-    Git Bash or cmd:
+    Any OS, using ms_netcat from the plugin package:
         ms_netcat localhost %d
-)", port, port, port, port);
+    Linux or Cygwin, without ms_netcat:
+        stty -icanon && nc localhost %d
+)", port, playersNote(maxConnectionCount).c_str(), port, port);
+}
+
+static void printUnixSocketWelcomeMessage(
+    const std::string& path, int maxConnectionCount) noexcept
+{
+    NX_PRINT << format(
+R"(
+
+###################################################################################################
+ATTENTION: Waiting for incoming connection at Unix-domain socket %s%s.
+
+Execute the following command in another terminal on the same machine:
+    Any OS, using ms_netcat from the plugin package:
+        ms_netcat --unix %s
+    Linux or Cygwin, without ms_netcat:
+        stty -icanon && nc -U %s
+)", toString(path).c_str(), playersNote(maxConnectionCount).c_str(),
+        path.c_str(), path.c_str());
 }
 
 bool SocketReader::startListening(int port) noexcept
 {
     if (!NX_KIT_ASSERT(port > 0) || !NX_KIT_ASSERT(port <= 65535))
         return false;
-    if (!NX_KIT_ASSERT(m_socketFd < 0) || !NX_KIT_ASSERT(!m_dataFd))
-        return false;
 
     m_port = port;
+    m_unixSocketPath.clear();
+    return listen();
+}
 
-    if ((m_socketFd = (int) socket(PF_INET, SOCK_STREAM, /*protocol*/ 0)) < 0)
-        return error("Socket creation failed");
+bool SocketReader::startListening(const std::string& unixSocketPath) noexcept
+{
+    if (!NX_KIT_ASSERT(!unixSocketPath.empty())
+        || !NX_KIT_ASSERT(unixSocketPath.size() < sizeof(sockaddr_un::sun_path)))
+    {
+        return false;
+    }
+
+    m_unixSocketPath = unixSocketPath;
+    return listen();
+}
+
+bool SocketReader::listen() noexcept
+{
+    if (!NX_KIT_ASSERT(m_socketFd < 0))
+        return false;
+
+    if (m_unixSocketPath.empty())
+    {
+        if ((m_socketFd = (int) socket(PF_INET, SOCK_STREAM, /*protocol*/ 0)) < 0)
+            return error("Socket creation failed");
 
-    sockaddr_in localAddr;
-    memset(&localAddr, 0, sizeof(localAddr));
-    localAddr.sin_family = AF_INET;
-    localAddr.sin_addr.s_addr = INADDR_ANY;
-    localAddr.sin_port = htons(m_port);
+        sockaddr_in localAddr;
+        memset(&localAddr, 0, sizeof(localAddr));
+        localAddr.sin_family = AF_INET;
+        localAddr.sin_addr.s_addr = INADDR_ANY;
+        localAddr.sin_port = htons(m_port);
 
-    if (bind(m_socketFd, (sockaddr*) &localAddr, sizeof(localAddr)) < 0)
-        return error("Unable to bind on the socket");
+        if (bind(m_socketFd, (sockaddr*) &localAddr, sizeof(localAddr)) < 0)
+            return error("Unable to bind on the socket");
+    }
+    else
+    {
+        if ((m_socketFd = (int) socket(AF_UNIX, SOCK_STREAM, /*protocol*/ 0)) < 0)
+            return error("Unix-domain socket creation failed");
+
+        sockaddr_un localAddr;
+        memset(&localAddr, 0, sizeof(localAddr));
+        localAddr.sun_family = AF_UNIX;
+        strncpy(localAddr.sun_path, m_unixSocketPath.c_str(), sizeof(localAddr.sun_path) - 1);
+
+        std::remove(m_unixSocketPath.c_str()); //< Left behind if the Server has crashed.
+        if (bind(m_socketFd, (sockaddr*) &localAddr, sizeof(localAddr)) < 0)
+            return error("Unable to bind on the socket %s", toString(m_unixSocketPath).c_str());
+
+        #if !defined(_WIN32)
+            // Let local controllers of any user connect, regardless of the umask.
+            chmod(m_unixSocketPath.c_str(), 0666);
+        #endif
+    }
 
-    if (listen(m_socketFd, /*backlog*/ 100) < 0)
+    if (::listen(m_socketFd, /*backlog*/ 100) < 0)
         return error("Unable to listen on the socket");
 
-    printWelcomeMessage(m_port);
+    // The connections are accepted by polling, without blocking the video frame thread.
+    if (!setSocketNonBlocking(m_socketFd))
+        return error("Unable to set the listening socket to non-blocking mode");
 
-    // Create a thread which will wait for the connection and return its data fd via the `future`.
-    std::promise<int> dataFdPromise;
-    m_dataFdFuture = dataFdPromise.get_future();
-    std::thread(waitForConnection, m_socketFd, std::move(dataFdPromise)).detach();
+    const int maxConnectionCount = (int) m_connections.size();
+    if (m_unixSocketPath.empty())
+        printTcpWelcomeMessage(m_port, maxConnectionCount);
+    else
+        printUnixSocketWelcomeMessage(m_unixSocketPath, maxConnectionCount);
 
     return true;
 }
 
-std::vector<char> SocketReader::receiveAvailableBytes() noexcept
+std::vector<char> SocketReader::receiveAvailableBytes(Connection* connection) noexcept
 {
     std::vector<char> bytes;
     for (;;) //< Looping to allow more bytes to arrive while we are reading the previous ones.
@@ -135,7 +232,8 @@ std::vector<char> SocketReader::receiveAvailableBytes() noexcept
         static constexpr int kBufferSize = 256;
         const int oldBytesCount = (int) bytes.size();
         bytes.resize(oldBytesCount + kBufferSize);
-        const int r = recv(*m_dataFd, &bytes[oldBytesCount], kBufferSize, /*flags*/ 0);
+        const int r = (int) recv(
+            *connection->dataFd, &bytes[oldBytesCount], kBufferSize, /*flags*/ 0);
         if (r > 0)
         {
             bytes.resize(oldBytesCount + r);
@@ -144,13 +242,15 @@ std::vector<char> SocketReader::receiveAvailableBytes() noexcept
         if (r == 0)
         {
             NX_PRINT << "Connection was closed by the sender - please reconnect.";
-            closeSocket();
-            startListening(m_port);
+            Metrics::instance().controlReconnects.add();
+            closeConnection(connection); //< The listening socket accepts the reconnection.
             return {};
         }
-        if (WSAGetLastError() != WSAEWOULDBLOCK)
+        if (!lastSocketErrorIsWouldBlock())
         {
-            error("Unable to read from the socket");
+            error("Unable to read from the socket - please reconnect");
+            Metrics::instance().controlReconnects.add();
+            closeConnection(connection); //< Frees the player slot for the reconnection.
             return {};
         }
         // No data was read on this iteration.
@@ -160,47 +260,34 @@ std::vector<char> SocketReader::receiveAvailableBytes() noexcept
     return bytes;
 }
 
-std::optional<char> SocketReader::getChar() noexcept
+void SocketReader::takeKeys(std::vector<PlayerKey>* keys) noexcept
 {
-    if (!m_dataFd)
-    {
-        if (m_dataFdFuture.wait_for(1us) != std::future_status::ready)
-            return std::nullopt;
-        m_dataFd = m_dataFdFuture.get(); //<< The socket has connected.
+    acceptConnections();
 
-        u_long argp = 1;
-        if (ioctlsocket(*m_dataFd, FIONBIO, &argp) < 0)
-            error("Unable to set the socket to non-blocking mode");
-    }
-
-    const std::vector<char> bytes = receiveAvailableBytes();
-
-    // Copy received bytes to the buffer, removing consecutive keystrokes to avoid inertia.
-    char prevByte = m_buffer.empty() ? '\0' : m_buffer.back();
-    for (const char byte: bytes)
+    Metrics& metrics = Metrics::instance();
+    for (int player = 0; player < (int) m_connections.size(); ++player)
     {
-        if (byte == prevByte)
+        Connection& connection = m_connections[player];
+        if (!connection.dataFd)
             continue;
-        m_buffer.push(byte);
-        prevByte = byte;
-    }
-    if (m_buffer.empty())
-        return std::nullopt;
 
-    const char c = m_buffer.front();
-    if (!m_hasReceivedData)
-    {
-        NX_PRINT << "\n####### Received first keystroke: " << toString(c);
-        m_hasReceivedData = true;
-    }
-    m_buffer.pop();
-    return c;
-}
+        const std::vector<char> bytes = receiveAvailableBytes(&connection);
+        if (bytes.empty())
+            continue;
+        metrics.keystrokesReceived.add(bytes.size());
 
-void SocketReader::clear() noexcept
-{
-    std::queue<char> empty;
-    std::swap(m_buffer, empty);
+        // Only the first key is taken; the rest, including the key repeats, are dropped.
+        metrics.keystrokesDropped.add(bytes.size() - 1);
+        const char c = bytes.front();
+        if (!connection.hasReceivedData)
+        {
+            NX_PRINT << "\n####### Received first keystroke"
+                << ((m_connections.size() > 1) ? format(" of player %d", player + 1) : "")
+                << ": " << toString(c);
+            connection.hasReceivedData = true;
+        }
+        keys->push_back({player, c});
+    }
 }
 
 } // namespace ms::vampires_nx_vms_plugin
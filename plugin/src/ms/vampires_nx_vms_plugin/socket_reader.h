@@ -2,39 +2,54 @@
 
 #pragma once
 
-#include <queue>
-#include <thread>
-#include <future>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "control_reader.h"
 
 namespace ms::vampires_nx_vms_plugin {
 
-/** Opens a socket for reading the incoming characters. Not thread-safe. */
-class SocketReader final
+/**
+ * Opens a socket for reading the incoming characters. Each of up to maxConnectionCount
+ * simultaneous connections controls its own player; a new connection takes the lowest free player
+ * number. Connections are accepted when polled, so no thread is needed. Not thread-safe.
+ */
+class SocketReader final: public ControlReader
 {
 public:
-    SocketReader() noexcept;
+    explicit SocketReader(int maxConnectionCount = 1) noexcept;
     ~SocketReader();
 
-    /** Opens the socket and starts listening to connections. */
+    /** Opens a TCP socket and starts listening to connections. */
     bool startListening(int port) noexcept;
 
-    /** Reads a character from the buffer if there is one, without blocking. */
-    std::optional<char> getChar() noexcept;
+    /**
+     * Opens a Unix-domain stream socket (AF_UNIX, supported by Windows 10+ as well) and starts
+     * listening to connections. Avoids the TCP/IP stack for a controller on the same machine.
+     */
+    bool startListening(const std::string& unixSocketPath) noexcept;
 
-    /** Clears the buffer. */
-    void clear() noexcept;
+    virtual void takeKeys(std::vector<PlayerKey>* keys) noexcept override;
 
 private:
-    std::vector<char> receiveAvailableBytes() noexcept;
+    struct Connection
+    {
+        std::optional<int> dataFd;
+        bool hasReceivedData = false;
+    };
+
+    bool listen() noexcept;
+    void acceptConnections() noexcept;
+    std::vector<char> receiveAvailableBytes(Connection* connection) noexcept;
+    void closeConnection(Connection* connection) noexcept;
     void closeSocket() noexcept;
 
 private:
-    bool m_hasReceivedData = false;
-    int m_port = -1;
+    int m_port = -1; /**< Used if m_unixSocketPath is empty. */
+    std::string m_unixSocketPath;
     int m_socketFd = -1;
-    std::future<int> m_dataFdFuture;
-    std::optional<int> m_dataFd;
-    std::queue<char> m_buffer;
+    std::vector<Connection> m_connections; /**< Indexed by player; has maxConnectionCount items. */
 };
 
 } // namespace ms::vampires_nx_vms_plugin
@@ -0,0 +1,106 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "socket_utils.h"
+
+#include <system_error>
+
+#if !defined(_WIN32)
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+#include <nx/kit/utils.h>
+
+namespace ms::vampires_nx_vms_plugin {
+
+int lastSocketError() noexcept
+{
+    #if defined(_WIN32)
+        return WSAGetLastError();
+    #else
+        return errno;
+    #endif
+}
+
+std::string lastSocketErrorMessage() noexcept
+{
+    return std::system_category().message(lastSocketError());
+}
+
+bool lastSocketErrorIsWouldBlock() noexcept
+{
+    const int error = lastSocketError();
+    #if defined(_WIN32)
+        return error == WSAEWOULDBLOCK;
+    #else
+        return error == EAGAIN || error == EWOULDBLOCK;
+    #endif
+}
+
+bool closeSocketFd(int fd) noexcept
+{
+    #if defined(_WIN32)
+        return closesocket(fd) == 0;
+    #else
+        return close(fd) == 0;
+    #endif
+}
+
+bool setSocketNonBlocking(int fd) noexcept
+{
+    #if defined(_WIN32)
+        u_long argp = 1;
+        return ioctlsocket(fd, FIONBIO, &argp) == 0;
+    #else
+        const int flags = fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    #endif
+}
+
+long long sendBuffers(int fd, const ConstBuffer* buffers, int count) noexcept
+{
+    if (count <= 0 || count > kMaxSendBuffers)
+        return -1;
+
+    #if defined(_WIN32)
+        WSABUF wsaBuffers[kMaxSendBuffers];
+        for (int i = 0; i < count; ++i)
+        {
+            wsaBuffers[i].buf = (CHAR*) buffers[i].data;
+            wsaBuffers[i].len = (ULONG) buffers[i].size;
+        }
+        DWORD sentBytes = 0;
+        if (WSASend(fd, wsaBuffers, (DWORD) count, &sentBytes, /*flags*/ 0,
+            /*overlapped*/ nullptr, /*completionRoutine*/ nullptr) != 0)
+        {
+            return -1;
+        }
+        return (long long) sentBytes;
+    #else
+        iovec ioVectors[kMaxSendBuffers];
+        for (int i = 0; i < count; ++i)
+        {
+            ioVectors[i].iov_base = (void*) buffers[i].data;
+            ioVectors[i].iov_len = buffers[i].size;
+        }
+        msghdr message{};
+        message.msg_iov = ioVectors;
+        message.msg_iovlen = (decltype(message.msg_iovlen)) count;
+        #if defined(MSG_NOSIGNAL)
+            static constexpr int kFlags = MSG_NOSIGNAL;
+        #else
+            static constexpr int kFlags = 0;
+        #endif
+        return (long long) sendmsg(fd, &message, kFlags);
+    #endif
+}
+
+std::string ipv4AddressToString(const sockaddr_in& addr) noexcept
+{
+    const auto* const b = (const unsigned char*) &addr.sin_addr;
+    return nx::kit::utils::format("%d.%d.%d.%d", b[0], b[1], b[2], b[3]);
+}
+
+} // namespace ms::vampires_nx_vms_plugin
@@ -0,0 +1,66 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+/**@file
+ * Thin platform layer over BSD sockets and WinSock, so that the socket-based classes of the
+ * plugin can be written once.
+ */
+
+#include <cstddef>
+#include <string>
+
+#if defined(_WIN32)
+    #include <WinSock2.h>
+    #include <WS2tcpip.h>
+    #include <afunix.h>
+#else
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <sys/types.h>
+    #include <sys/un.h>
+#endif
+
+namespace ms::vampires_nx_vms_plugin {
+
+#if defined(_WIN32)
+    using SocketLen = int;
+#else
+    using SocketLen = socklen_t;
+#endif
+
+/** @return Error code of the last failed socket call: WSAGetLastError() or errno. */
+int lastSocketError() noexcept;
+
+/** @return Human-readable text for lastSocketError(). */
+std::string lastSocketErrorMessage() noexcept;
+
+/** @return Whether the last failed non-blocking socket call has failed only because of EAGAIN. */
+bool lastSocketErrorIsWouldBlock() noexcept;
+
+bool closeSocketFd(int fd) noexcept;
+
+bool setSocketNonBlocking(int fd) noexcept;
+
+struct ConstBuffer
+{
+    const char* data = nullptr;
+    size_t size = 0;
+};
+
+static constexpr int kMaxSendBuffers = 64;
+
+/**
+ * Sends the buffers with a single scatter-gather call (sendmsg() or WSASend()), without copying
+ * them. Does not raise SIGPIPE if the peer has disconnected.
+ * @param count Must not exceed kMaxSendBuffers.
+ * @return Number of bytes sent (possibly less than the total size for a non-blocking socket),
+ *     or -1 on error.
+ */
+long long sendBuffers(int fd, const ConstBuffer* buffers, int count) noexcept;
+
+/** @return The address in the "a.b.c.d" form. */
+std::string ipv4AddressToString(const sockaddr_in& addr) noexcept;
+
+} // namespace ms::vampires_nx_vms_plugin
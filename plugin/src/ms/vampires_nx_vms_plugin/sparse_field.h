@@ -0,0 +1,187 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+#include <nx/kit/debug.h>
+
+namespace ms::vampires_nx_vms_plugin {
+
+/**
+ * 2D grid of nullable values (e.g. shared_ptr) stored as fixed-size square tiles, each allocated
+ * when its first cell becomes occupied and freed when its last cell is vacated, so the memory
+ * depends on the number (and locality) of the occupied cells rather than on the grid area.
+ *
+ * Tiles are found via a hash map fronted by a small direct-mapped cache of recently used tiles:
+ * the lookups of the neighbours of a cell during a game tick almost always hit the cache.
+ */
+template<typename Value>
+class SparseField
+{
+public:
+    static constexpr int kTileSizeLog2 = 4;
+    static constexpr int kTileSize = 1 << kTileSizeLog2;
+
+    SparseField(int width, int height): m_width(width), m_height(height) {}
+
+    /** @return Reference to a null value for an empty cell. */
+    const Value& at(int x, int y) const
+    {
+        if (const Tile* const tile = findTile(x, y))
+            return tile->cells[cellIndex(x, y)];
+        return kEmpty;
+    }
+
+    /** Assigning a null value vacates the cell. */
+    void set(int x, int y, Value value)
+    {
+        Tile* tile = findTile(x, y);
+        if (!tile)
+        {
+            if (!value)
+                return;
+            tile = createTile(x, y);
+        }
+
+        Value& cell = tile->cells[cellIndex(x, y)];
+        tile->occupiedCount += (value ? 1 : 0) - (cell ? 1 : 0);
+        cell = std::move(value);
+        if (tile->occupiedCount == 0)
+            eraseTile(x, y);
+    }
+
+    /** Moves the value from one cell to another one, which must be empty. */
+    void move(int fromX, int fromY, int toX, int toY)
+    {
+        NX_KIT_ASSERT(!at(toX, toY));
+        Value value = at(fromX, fromY);
+        set(toX, toY, std::move(value)); //< First, to keep the tile if it is the same one.
+        set(fromX, fromY, nullptr);
+    }
+
+    int tileCount() const { return (int) m_tiles.size(); }
+
+    /**
+     * Calls `visitor(x, y, value)` for each occupied cell, in no particular order; skips the
+     * unallocated tiles entirely.
+     */
+    template<typename Visitor>
+    void forEachOccupied(Visitor visitor) const
+    {
+        for (const auto& [key, tile]: m_tiles)
+        {
+            const int tileX = (int) (key >> 32) << kTileSizeLog2;
+            const int tileY = (int) (uint32_t) key << kTileSizeLog2;
+            for (int i = 0; i < kTileSize * kTileSize; ++i)
+            {
+                if (const Value& value = tile->cells[i])
+                    visitor(tileX + (i & (kTileSize - 1)), tileY + (i >> kTileSizeLog2), value);
+            }
+        }
+    }
+
+private:
+    struct Tile
+    {
+        std::array<Value, kTileSize * kTileSize> cells{};
+        int occupiedCount = 0;
+    };
+
+    struct CacheEntry
+    {
+        uint64_t key = UINT64_MAX;
+        Tile* tile = nullptr; /**< Null if the tile is known to be absent. */
+    };
+
+    static constexpr int kCacheSize = 64; //< Must be a power of two.
+    using TileCache = std::array<CacheEntry, kCacheSize>;
+
+    static uint64_t tileKey(int x, int y)
+    {
+        return ((uint64_t) (uint32_t) (x >> kTileSizeLog2) << 32)
+            | (uint32_t) (y >> kTileSizeLog2);
+    }
+
+    static int cellIndex(int x, int y)
+    {
+        return ((y & (kTileSize - 1)) << kTileSizeLog2) | (x & (kTileSize - 1));
+    }
+
+    static CacheEntry& cacheEntry(TileCache& cache, uint64_t key)
+    {
+        // Neighbouring tiles map to different entries.
+        return cache[((key >> 32) * 5 + key) & (kCacheSize - 1)];
+    }
+
+    Tile* findTile(int x, int y) const
+    {
+        return findTile(x, y, &m_cache);
+    }
+
+    Tile* findTile(int x, int y, TileCache* cache) const
+    {
+        NX_KIT_ASSERT(x >= 0 && x < m_width && y >= 0 && y < m_height);
+
+        const uint64_t key = tileKey(x, y);
+        CacheEntry& entry = cacheEntry(*cache, key);
+        if (entry.key != key)
+        {
+            const auto it = m_tiles.find(key);
+            entry.key = key;
+            entry.tile = (it == m_tiles.end()) ? nullptr : it->second.get();
+        }
+        return entry.tile;
+    }
+
+    Tile* createTile(int x, int y)
+    {
+        const uint64_t key = tileKey(x, y);
+        Tile* const tile = (m_tiles[key] = std::make_unique<Tile>()).get();
+        cacheEntry(m_cache, key) = {key, tile};
+        return tile;
+    }
+
+    void eraseTile(int x, int y)
+    {
+        const uint64_t key = tileKey(x, y);
+        m_tiles.erase(key);
+        cacheEntry(m_cache, key) = {key, nullptr};
+    }
+
+public:
+    /**
+     * Read-only view with its own tile cache, allowing concurrent lookups from multiple threads
+     * (one Reader per thread), as long as the field is not modified.
+     */
+    class Reader
+    {
+    public:
+        explicit Reader(const SparseField& field): m_field(field) {}
+
+        const Value& at(int x, int y) const
+        {
+            if (const Tile* const tile = m_field.findTile(x, y, &m_cache))
+                return tile->cells[cellIndex(x, y)];
+            return kEmpty;
+        }
+
+    private:
+        const SparseField& m_field;
+        mutable TileCache m_cache;
+    };
+
+private:
+    static inline const Value kEmpty{};
+
+    const int m_width;
+    const int m_height;
+    std::unordered_map<uint64_t, std::unique_ptr<Tile>> m_tiles;
+    mutable TileCache m_cache;
+};
+
+} // namespace ms::vampires_nx_vms_plugin
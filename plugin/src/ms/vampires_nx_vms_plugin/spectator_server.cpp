@@ -0,0 +1,210 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "spectator_server.h"
+
+#include <cstring>
+#include <utility>
+
+#include <nx/kit/debug.h>
+
+#include "socket_utils.h"
+
+namespace ms::vampires_nx_vms_plugin {
+
+using nx::kit::utils::format;
+
+/** Allows to be called as `return error("%1...", args);`. */
+template<typename... Args>
+static bool error(Args&&... args) noexcept
+{
+    NX_PRINT << "ERROR: " << format(std::forward<decltype(args)>(args)...) << ": " +
+        lastSocketErrorMessage();
+    return false;
+}
+
+SpectatorServer::SpectatorServer() noexcept
+{
+}
+
+SpectatorServer::~SpectatorServer()
+{
+    for (const auto& client: m_clients)
+        closeSocketFd(client.fd);
+    if (m_socketFd >= 0)
+        closeSocketFd(m_socketFd);
+}
+
+bool SpectatorServer::startListening(int port) noexcept
+{
+    if (!NX_KIT_ASSERT(port > 0) || !NX_KIT_ASSERT(port <= 65535))
+        return false;
+    if (!NX_KIT_ASSERT(m_socketFd < 0))
+        return false;
+
+    m_port = port;
+
+    if ((m_socketFd = (int) socket(PF_INET, SOCK_STREAM, /*protocol*/ 0)) < 0)
+        return error("Spectator socket creation failed");
+
+    sockaddr_in localAddr;
+    memset(&localAddr, 0, sizeof(localAddr));
+    localAddr.sin_family = AF_INET;
+    localAddr.sin_addr.s_addr = INADDR_ANY;
+    localAddr.sin_port = htons(m_port);
+
+    if (bind(m_socketFd, (sockaddr*) &localAddr, sizeof(localAddr)) < 0)
+        return error("Unable to bind on the spectator socket");
+
+    if (listen(m_socketFd, /*backlog*/ 100) < 0)
+        return error("Unable to listen on the spectator socket");
+
+    if (!setSocketNonBlocking(m_socketFd))
+        return error("Unable to set the spectator socket to non-blocking mode");
+
+    NX_PRINT << "\n####### Spectators may connect to port " << m_port << "\n";
+    return true;
+}
+
+void SpectatorServer::acceptClients() noexcept
+{
+    for (;;)
+    {
+        sockaddr_in clientAddr;
+        SocketLen len = sizeof(sockaddr_in);
+        const int fd = (int) accept(m_socketFd, (sockaddr*) &clientAddr, &len);
+        if (fd < 0)
+        {
+            if (!lastSocketErrorIsWouldBlock())
+                error("Unable to accept on the spectator socket");
+            return;
+        }
+
+        if (!setSocketNonBlocking(fd))
+        {
+            error("Unable to set the spectator connection to non-blocking mode");
+            closeSocketFd(fd);
+            continue;
+        }
+
+        NX_PRINT << "\n####### Spectator connected from " << ipv4AddressToString(clientAddr);
+        Client client;
+        client.fd = fd;
+        m_clients.push_back(std::move(client));
+    }
+}
+
+void SpectatorServer::resync() noexcept
+{
+    for (auto& client: m_clients)
+        client.hasKeyframe = false;
+}
+
+void SpectatorServer::enqueue(Client* client, const FieldEncoder::Buffer& buffer) noexcept
+{
+    client->queuedBytes += buffer->size();
+    client->queue.push_back(buffer);
+}
+
+void SpectatorServer::publish(const Vampires& vampires) noexcept
+{
+    if (m_socketFd < 0)
+        return;
+
+    acceptClients();
+    if (m_clients.empty())
+        return;
+
+    // Each message is encoded lazily, at most once, and shared by all the clients.
+    FieldEncoder::Buffer keyframe;
+    FieldEncoder::Buffer delta;
+    bool isDeltaEncoded = false;
+
+    for (auto& client: m_clients)
+    {
+        if (client.hasKeyframe && client.queuedBytes > kMaxQueuedBytes)
+        {
+            // The client does not keep up; restart it from a keyframe once its queue is sent.
+            client.hasKeyframe = false;
+            while (client.queue.size() > (client.sentBytesOfFront > 0 ? 1U : 0U))
+            {
+                client.queuedBytes -= client.queue.back()->size();
+                client.queue.pop_back();
+            }
+        }
+
+        if (!client.hasKeyframe)
+        {
+            if (client.queuedBytes > kMaxQueuedBytes)
+                continue; //< Wait until the client receives its partially sent message.
+            if (!keyframe)
+                keyframe = FieldEncoder::encodeKeyframe(vampires);
+            enqueue(&client, keyframe);
+            client.hasKeyframe = true;
+            continue;
+        }
+
+        if (!isDeltaEncoded)
+        {
+            delta = FieldEncoder::encodeDelta(vampires);
+            isDeltaEncoded = true;
+        }
+        if (delta)
+            enqueue(&client, delta);
+    }
+
+    for (auto it = m_clients.begin(); it != m_clients.end(); )
+    {
+        if (flush(&*it))
+        {
+            ++it;
+            continue;
+        }
+        NX_PRINT << "\n####### Spectator disconnected";
+        closeSocketFd(it->fd);
+        it = m_clients.erase(it);
+    }
+}
+
+bool SpectatorServer::flush(Client* client) noexcept
+{
+    while (!client->queue.empty())
+    {
+        ConstBuffer buffers[kMaxSendBuffers];
+        int count = 0;
+        for (const auto& buffer: client->queue)
+        {
+            if (count == kMaxSendBuffers)
+                break;
+            const size_t offset = (count == 0) ? client->sentBytesOfFront : 0;
+            buffers[count++] = ConstBuffer{buffer->data() + offset, buffer->size() - offset};
+        }
+
+        long long sentBytes = sendBuffers(client->fd, buffers, count);
+        if (sentBytes < 0)
+        {
+            if (lastSocketErrorIsWouldBlock())
+                return true; //< The socket buffer is full; continue on the next tick.
+            return error("Unable to send to a spectator");
+        }
+
+        // Pop the buffers which have been sent completely.
+        while (sentBytes > 0)
+        {
+            const size_t frontRemainder = client->queue.front()->size() - client->sentBytesOfFront;
+            if ((size_t) sentBytes < frontRemainder)
+            {
+                client->sentBytesOfFront += (size_t) sentBytes;
+                break;
+            }
+            sentBytes -= (long long) frontRemainder;
+            client->queuedBytes -= client->queue.front()->size();
+            client->queue.pop_front();
+            client->sentBytesOfFront = 0;
+        }
+        if (client->sentBytesOfFront > 0)
+            return true; //< Partial write: the socket buffer is full.
+    }
+    return true;
+}
+
+} // namespace ms::vampires_nx_vms_plugin
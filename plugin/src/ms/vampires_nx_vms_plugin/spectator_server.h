@@ -0,0 +1,67 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include "field_encoder.h"
+#include "vampires.h"
+
+namespace ms::vampires_nx_vms_plugin {
+
+/**
+ * Listens to a socket port and streams the game field to any number of read-only clients in the
+ * format of FieldEncoder. Each message is encoded once and the same buffer is queued to every
+ * client, being sent with scatter-gather writes. Never blocks: the listening and client sockets
+ * are non-blocking, and the work is done in publish(). Not thread-safe.
+ */
+class SpectatorServer final
+{
+public:
+    SpectatorServer() noexcept;
+    ~SpectatorServer();
+
+    /** Opens the socket and starts accepting connections in publish(). */
+    bool startListening(int port) noexcept;
+
+    /**
+     * Accepts new clients, sends them a keyframe, sends the changes of the field to the other
+     * clients, and writes out as much of the queued data as the sockets accept. Intended to be
+     * called once per tick, before Vampires::clearChangedCells().
+     */
+    void publish(const Vampires& vampires) noexcept;
+
+    /** Makes every client receive a keyframe on the next publish(), e.g. after a new game. */
+    void resync() noexcept;
+
+private:
+    struct Client
+    {
+        int fd = -1;
+        bool hasKeyframe = false;
+        std::deque<FieldEncoder::Buffer> queue;
+        size_t queuedBytes = 0;
+        size_t sentBytesOfFront = 0; /**< Part of queue.front() already sent. */
+    };
+
+    void acceptClients() noexcept;
+    static void enqueue(Client* client, const FieldEncoder::Buffer& buffer) noexcept;
+
+    /** @return False if the client has disconnected or failed and must be dropped. */
+    static bool flush(Client* client) noexcept;
+
+private:
+    /**
+     * A client which is so slow that it has accumulated more queued data is restarted with a
+     * keyframe instead of queueing further deltas.
+     */
+    static constexpr size_t kMaxQueuedBytes = 4 * 1024 * 1024;
+
+    int m_port = -1;
+    int m_socketFd = -1;
+    std::vector<Client> m_clients;
+};
+
+} // namespace ms::vampires_nx_vms_plugin
@@ -0,0 +1,72 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "tracing.h"
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <system_error>
+
+#include <nx/kit/debug.h>
+#include <nx/sdk/helpers/span_recorder.h>
+
+#include "vampires_nx_vms_plugin_ini.h"
+
+namespace ms::vampires_nx_vms_plugin {
+
+using nx::sdk::SpanRecorder;
+
+static std::mutex s_mutex;
+
+static std::string traceFilePath()
+{
+    if (ini().traceFile[0] != '\0')
+        return ini().traceFile;
+
+    std::error_code errorCode;
+    const std::filesystem::path tempDir = std::filesystem::temp_directory_path(errorCode);
+    return ((errorCode ? std::filesystem::path(".") : tempDir)
+        / "vampires_nx_vms_plugin_trace.json").string();
+}
+
+static void writeTrace()
+{
+    const std::string path = traceFilePath();
+    const std::string error = SpanRecorder::instance().writeChromeTrace(path);
+    if (error.empty())
+        NX_PRINT << "Trace written to " << nx::kit::utils::toString(path);
+    else
+        NX_PRINT << "ERROR: Unable to write the trace: " << error;
+}
+
+void updateTracing()
+{
+    const std::lock_guard<std::mutex> lock(s_mutex);
+    ini().reload();
+    const bool isEnabled = ini().enableTrace;
+    if (isEnabled == SpanRecorder::isEnabled())
+        return;
+
+    if (isEnabled)
+    {
+        SpanRecorder::instance().clear();
+        SpanRecorder::setEnabled(true);
+        NX_PRINT << "Tracing started";
+    }
+    else
+    {
+        SpanRecorder::setEnabled(false);
+        writeTrace();
+    }
+}
+
+void finishTracing()
+{
+    const std::lock_guard<std::mutex> lock(s_mutex);
+    if (!SpanRecorder::isEnabled())
+        return;
+    SpanRecorder::setEnabled(false);
+    writeTrace();
+}
+
+} // namespace ms::vampires_nx_vms_plugin
@@ -0,0 +1,20 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+/**@file
+ * Switches nx::sdk::SpanRecorder according to ini().enableTrace, and writes out the trace.
+ */
+
+namespace ms::vampires_nx_vms_plugin {
+
+/**
+ * Re-reads the .ini file, and enables or disables the span recording accordingly; writes the
+ * trace when the recording gets disabled. Thread-safe; intended to be called periodically.
+ */
+void updateTracing();
+
+/** Writes the trace if the recording is enabled; called on the plugin shutdown. */
+void finishTracing();
+
+} // namespace ms::vampires_nx_vms_plugin
@@ -3,7 +3,11 @@
 #include "vampires.h"
 
 #include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
 #include <cstdlib>
+#include <utility>
 
 namespace ms::vampires_nx_vms_plugin {
 
@@ -39,29 +43,66 @@ std::string Vampires::Item::toString(Kind kind)
     }
 }
 
+static_assert((int) Vampires::Item::Kind::border + 1 == FieldQuadtree::kKindCount);
+
+/**
+ * @return Horizontal offset of the player from the center: 0, 2, -2, 4, -4, ..., so that the
+ *     players are not adjacent.
+ */
+static int playerOffset(int player)
+{
+    const int offset = 2 * ((player + 1) / 2);
+    return (player % 2 == 1) ? offset : -offset;
+}
+
 Vampires::Vampires(
-    int width, int height, int vampireCount, int wallCount,
+    int width, int height, int vampireCount, int wallCount, int playerCount,
     std::shared_ptr<Item::Factory> itemFactory)
     :
+    Vampires(width, height, vampireCount, wallCount, playerCount, std::move(itemFactory),
+        Uninitialized())
+{
+    initGame();
+}
+
+Vampires::Vampires(
+    int width, int height, int vampireCount, int wallCount, int playerCount,
+    std::shared_ptr<Item::Factory> itemFactory, Uninitialized)
+    :
     width(width),
     height(height),
     vampireCount(vampireCount),
     wallCount(wallCount),
-    m_itemFactory(itemFactory)
+    playerCount(playerCount),
+    m_itemFactory(itemFactory),
+    m_field(width, height),
+    m_quadtree(width, height)
 {
     NX_KIT_ASSERT(width >= 7);
     NX_KIT_ASSERT(height >= 7);
     NX_KIT_ASSERT(vampireCount >= 1);
+    NX_KIT_ASSERT(vampireCount <= 2 * (width - 2) + 2 * (height - 4)); //< Inner border circle.
     NX_KIT_ASSERT(wallCount >= 1);
-    NX_KIT_ASSERT(wallCount <= (width - 4) * (height - 4) - /* cell for player */ 1);
+    NX_KIT_ASSERT(wallCount <= (int64_t) (width - 4) * (height - 4) - /*player cells*/ playerCount);
+    NX_KIT_ASSERT(playerCount >= 1);
+    for (int player = 0; player < playerCount; ++player) //< The row fits inside the vampires.
+    {
+        const int x = width / 2 + playerOffset(player);
+        NX_KIT_ASSERT(x >= 2 && x <= width - 3);
+    }
 
     NX_KIT_ASSERT(m_itemFactory);
+}
 
-    m_field.resize(height);
-    for (auto& line: m_field)
-        line.resize(width);
-
-    initGame();
+const Vampires::Item& Vampires::player() const
+{
+    for (const auto& player: m_players)
+    {
+        if (player)
+            return *player;
+    }
+    NX_KIT_ASSERT(false, "All players have been caught.");
+    return *m_players.front();
 }
 
 std::shared_ptr<Vampires::Item> Vampires::itemAt(int x, int y) const
@@ -72,37 +113,44 @@ std::shared_ptr<Vampires::Item> Vampires::itemAt(int x, int y) const
         return nullptr;
     }
 
-    return m_field[y][x];
+    return m_field.at(x, y);
 }
 
 void Vampires::printField() const
 {
     // Print two chars per cell to obtain a visually square field.
 
-    std::string field = "VAMPIRES FIELD:\n";
+    static const std::string kHeader = "VAMPIRES FIELD:\n";
+
+    std::string field;
+    field.reserve(kHeader.size() + (size_t) height * (2 * width + /*newline*/ 1));
+    field += kHeader;
 
     for (int y = 0; y < height; ++y)
     {
-        std::string line;
         for (int x = 0; x < width; x++)
         {
-            if (!m_field[y][x])
+            const auto& item = m_field.at(x, y);
+            if (isBorder(x, y))
+            {
+                field.append("()");
+            }
+            else if (!item)
             {
-                line += "  ";
+                field.append("  ");
             }
             else
             {
-                switch (m_field[y][x]->kind)
+                switch (item->kind)
                 {
-                    case Item::Kind::player: line += "}{"; break;
-                    case Item::Kind::wall: line += "[]"; break;
-                    case Item::Kind::vampire: line += "><"; break;
-                    case Item::Kind::border: line += "()"; break;
+                    case Item::Kind::player: field.append("}{"); break;
+                    case Item::Kind::wall: field.append("[]"); break;
+                    case Item::Kind::vampire: field.append("><"); break;
                     default: NX_KIT_ASSERT(false);
                 }
             }
         }
-        field += line + "\n";
+        field.push_back('\n');
     }
     NX_PRINT << field;
 }
@@ -110,44 +158,65 @@ void Vampires::printField() const
 /** NOTE: The field cell must be empty. */
 std::shared_ptr<Vampires::Item> Vampires::createItem(Item::Kind kind, int x, int y)
 {
-    NX_KIT_ASSERT(!m_field[y][x]);
-
     const std::shared_ptr<Item> item(m_itemFactory->createItem(kind, x, y));
-    m_field[y][x] = item;
-
+    addItem(item);
     return item;
 }
 
+/** NOTE: The field cell must be empty. */
+void Vampires::addItem(std::shared_ptr<Item> item)
+{
+    const int x = item->x();
+    const int y = item->y();
+    NX_KIT_ASSERT(!m_field.at(x, y));
+
+    m_quadtree.add((int) item->kind, x, y);
+    m_field.set(x, y, std::move(item));
+    m_changedCells.push_back({x, y});
+}
+
+void Vampires::removeItem(const std::shared_ptr<Item>& item)
+{
+    NX_KIT_ASSERT(m_field.at(item->x(), item->y()) == item); //< Check the field consistency.
+
+    m_changedCells.push_back({item->x(), item->y()});
+    m_quadtree.remove((int) item->kind, item->x(), item->y());
+    m_field.set(item->x(), item->y(), nullptr);
+}
+
 /** NOTE: The field cell must be empty. */
 void Vampires::moveItem(std::shared_ptr<Item> item, int x, int y)
 {
-    NX_KIT_ASSERT(!m_field[y][x]);
-    NX_KIT_ASSERT(m_field[item->y()][item->x()] == item); //< Check the field consistency.
+    NX_KIT_ASSERT(!m_field.at(x, y));
+    NX_KIT_ASSERT(m_field.at(item->x(), item->y()) == item); //< Check the field consistency.
 
-    std::swap(m_field[item->y()][item->x()], m_field[y][x]);
+    m_changedCells.push_back({item->x(), item->y()});
+    m_changedCells.push_back({x, y});
+    m_quadtree.remove((int) item->kind, item->x(), item->y());
+    m_quadtree.add((int) item->kind, x, y);
+
+    m_field.move(item->x(), item->y(), x, y);
     item->setX(x);
     item->setY(y);
 }
 
 bool Vampires::fieldHas(int x, int y, Item::Kind kind) const
 {
-    const auto& item = m_field[y][x];
+    const auto& item = m_field.at(x, y);
     return item && item->kind == kind;
 }
 
+/** @return Pseudo-random number in range [0, count), even if count exceeds RAND_MAX. */
+static int64_t randomIndex(int64_t count)
+{
+    // At least 45 random bits, even where RAND_MAX is as small as 32767.
+    const uint64_t r = ((uint64_t) rand() << 30) ^ ((uint64_t) rand() << 15) ^ (uint64_t) rand();
+    return (int64_t) (r % (uint64_t) count);
+}
+
 void Vampires::initGame()
 {
-    // Draw the border: the outermost circle of the field.
-    for (int x = 0; x < width; x++)
-    {
-        createItem(Item::Kind::border, x, 0);
-        createItem(Item::Kind::border, x, height - 1);
-    }
-    for (int y = 1; y < height - 1; ++y)
-    {
-        createItem(Item::Kind::border, 0, y);
-        createItem(Item::Kind::border, width - 1, y);
-    }
+    // The border, the outermost circle of the field, is implicit: see isBorder().
 
     // Settle the vampires along the inner circle of the border.
     int position = 0; //< The "integral" part of the next vampire coordinate.
@@ -192,10 +261,39 @@ void Vampires::initGame()
     }
     NX_KIT_ASSERT(m_vampires.size() == vampireCount);
 
-    // Settle the player at the center.
-    m_player = createItem(Item::Kind::player, width / 2, height / 2);
+    // Settle the players in a row at the center; the first one is exactly at the center.
+    for (int player = 0; player < playerCount; ++player)
+    {
+        m_players.push_back(
+            createItem(Item::Kind::player, width / 2 + playerOffset(player), height / 2));
+    }
+    m_remainingPlayerCount = playerCount;
 
-    // Put the walls randomly.
+    // Put the walls randomly, into the cells not adjacent to the border.
+    const int64_t innerWidth = width - 4;
+    const int64_t innerCellCount = innerWidth * (height - 4);
+    if ((int64_t) wallCount * 2 <= innerCellCount)
+    {
+        // A sparse field: pick random cells until an empty one is found, without enumerating
+        // all the cells, which would be prohibitive for a huge field.
+        for (int wallsLeft = wallCount; wallsLeft != 0; --wallsLeft)
+        {
+            for (;;)
+            {
+                const int64_t i = randomIndex(innerCellCount);
+                const int x = 2 + (int) (i % innerWidth);
+                const int y = 2 + (int) (i / innerWidth);
+                if (!m_field.at(x, y))
+                {
+                    createItem(Item::Kind::wall, x, y);
+                    break;
+                }
+            }
+        }
+        return;
+    }
+
+    // A dense field: choose among the empty cells, to guarantee termination.
     struct Wall
     {
         Wall(int x, int y): x(x), y(y) {}
@@ -207,7 +305,7 @@ void Vampires::initGame()
     {
         for (int x = 2; x < width - 2; ++x)
         {
-            if (!m_field[y][x])
+            if (!m_field.at(x, y))
                 walls.emplace_back(x, y);
         }
     }
@@ -215,7 +313,7 @@ void Vampires::initGame()
     int spacesLeft = (int) walls.size();
     for (int wallsLeft = wallCount; wallsLeft != 0; --wallsLeft)
     {
-        int i = (2 * rand() * (spacesLeft - 1) + RAND_MAX) / (2 * RAND_MAX);
+        const int i = (int) randomIndex(spacesLeft);
         createItem(Item::Kind::wall, walls[i].x, walls[i].y);
         if (i != spacesLeft - 1)
             walls.erase(walls.begin() + i);
@@ -248,16 +346,59 @@ static Distance directionToDistance(Vampires::Direction direction)
     return d;
 }
 
-Vampires::PlayerResult Vampires::movePlayer(Vampires::Direction direction)
+bool Vampires::catchPlayer(int x, int y)
+{
+    if (m_remainingPlayerCount == 1)
+        return true;
+
+    for (auto& player: m_players)
+    {
+        if (player && player->x() == x && player->y() == y)
+        {
+            removeItem(player);
+            player.reset();
+            --m_remainingPlayerCount;
+            return false;
+        }
+    }
+    NX_KIT_ASSERT(false, nx::kit::utils::format("No player at (%d, %d).", x, y));
+    return false;
+}
+
+Vampires::PlayerResult Vampires::movePlayers(std::vector<PlayerCommand> commands)
+{
+    std::stable_sort(commands.begin(), commands.end(),
+        [](const PlayerCommand& a, const PlayerCommand& b) { return a.player < b.player; });
+
+    for (const auto& command: commands)
+    {
+        if (movePlayer(command.player, command.direction) == PlayerResult::lost)
+            return PlayerResult::lost;
+    }
+    return PlayerResult::ok;
+}
+
+Vampires::PlayerResult Vampires::movePlayer(int player, Vampires::Direction direction)
 {
+    if (!NX_KIT_ASSERT(player >= 0 && player < (int) m_players.size()))
+        return PlayerResult::ok;
+    const std::shared_ptr<Item> playerItem = m_players[player];
+    if (!playerItem)
+        return PlayerResult::ok; //< The player has been caught.
+
     const Distance d = directionToDistance(direction);
 
-    const int newX = m_player->x() + d.x;
-    const int newY = m_player->y() + d.y;
+    const int newX = playerItem->x() + d.x;
+    const int newY = playerItem->y() + d.y;
     if (fieldHas(newX, newY, Item::Kind::vampire))
-        return PlayerResult::lost;
+    {
+        return catchPlayer(playerItem->x(), playerItem->y())
+            ? PlayerResult::lost
+            : PlayerResult::ok;
+    }
 
-    // Find the cell which should be occupied. The loop is safe because of the border.
+    // Find the cell which should be occupied. The loop stops at the border at the latest, because
+    // there are no walls on it.
     int emptyX = newX;
     int emptyY = newY;
     while (fieldHas(emptyX, emptyY, Item::Kind::wall))
@@ -266,7 +407,8 @@ Vampires::PlayerResult Vampires::movePlayer(Vampires::Direction direction)
         emptyY += d.y;
     }
 
-    if (m_field[emptyY][emptyX]) //< Unable to move: the cell after all walls (if any) is non-empty.
+    // Unable to move: the cell after all walls (if any) is non-empty.
+    if (isBorder(emptyX, emptyY) || m_field.at(emptyX, emptyY))
         return PlayerResult::ok;
 
     // Push the walls if needed, starting with the last one in the row.
@@ -274,71 +416,179 @@ Vampires::PlayerResult Vampires::movePlayer(Vampires::Direction direction)
     {
         const int wallX = emptyX - d.x;
         const int wallY = emptyY - d.y;
-        moveItem(m_field[wallY][wallX], emptyX, emptyY);
+        moveItem(m_field.at(wallX, wallY), emptyX, emptyY);
         emptyX = wallX;
         emptyY = wallY;
     }
 
-    moveItem(m_player, newX, newY);
+    moveItem(playerItem, newX, newY);
     return PlayerResult::ok;
 }
 
 Vampires::VampireResult Vampires::moveVampires()
 {
-    // Calculate the distance to the player for each Vampire.
+    // Choose the player to chase and calculate the distance to it for each Vampire. With a
+    // single player, there is nothing to look up.
+    const Item* const onlyPlayer = (m_remainingPlayerCount == 1) ? &player() : nullptr;
     for (auto& vampire: m_vampires)
     {
-        const int dx = vampire.item->x() - m_player->x();
-        const int dy = vampire.item->y() - m_player->y();
+        if (onlyPlayer)
+        {
+            vampire.targetX = onlyPlayer->x();
+            vampire.targetY = onlyPlayer->y();
+        }
+        else
+        {
+            const auto target = m_quadtree.nearest(
+                (int) Item::Kind::player, vampire.item->x(), vampire.item->y());
+            if (!NX_KIT_ASSERT(target))
+                return VampireResult::lost;
+            vampire.targetX = target->x;
+            vampire.targetY = target->y;
+        }
+        const int64_t dx = vampire.item->x() - vampire.targetX;
+        const int64_t dy = vampire.item->y() - vampire.targetY;
         vampire.d = dx * dx + dy * dy;
     }
 
-    // Sort Vampires by the distance to the player, the closest first.
+    // Sort Vampires by the distance to the target, the closest first.
     std::sort(m_vampires.begin(), m_vampires.end(),
         [](const Vampire& v1, const Vampire& v2)
         {
             return v1.d > v2.d;
         });
 
+    // Only the vampires far from others are independent; the rest are decided in order below.
+    const int threadCount = std::min(
+        m_threadCount, (int) m_vampires.size() / std::max(1, m_minVampiresPerThread));
+    m_isolatedMoves.assign(m_vampires.size(), std::nullopt);
+    m_parallelMoveCount = 0;
+    if (threadCount > 1)
+        decideIsolatedMoves(threadCount);
+
     // Each vampire moves to come closer to the player, and if there is any move, it must move.
     bool hasSomeVampiresMoved = false;
-    for (const auto& vampire: m_vampires)
+    for (int i = 0; i < (int) m_vampires.size(); ++i)
     {
-        int minDd = INT_MAX;
-        Distance minDistance{};
-        for (int dir = 0; dir < (int) Direction::count; ++dir)
+        const Vampire& vampire = m_vampires[i];
+        const Move move = m_isolatedMoves[i] ? *m_isolatedMoves[i] : decideMove(vampire, m_field);
+        if (move.catchesPlayer)
         {
-            const Distance d = directionToDistance((Direction) dir);
-
-            if (fieldHas(vampire.item->x() + d.x, vampire.item->y() + d.y, Item::Kind::player))
+            if (catchPlayer(vampire.item->x() + move.dx, vampire.item->y() + move.dy))
                 return VampireResult::lost;
-
-            if (m_field[vampire.item->y() + d.y][vampire.item->x() + d.x])
-                continue; //< The intended move is impossible: the cell is occupied.
-
-            const int cx = 2 * (vampire.item->x() - m_player->x());
-            const int cy = 2 * (vampire.item->y() - m_player->y());
-            const int dd = ((d.x != 0)
-                ? ((d.x == 1) ? (1 + cx) : (1 - cx))
-                : 0)
-                +
-                ((d.y != 0)
-                ? ((d.y == 1) ? (1 + cy) : (1 - cy))
-                : 0);
-            if (minDd > dd)
-            {
-                minDd = dd;
-                minDistance = d;
-            }
+            hasSomeVampiresMoved = true; //< Catching is the move of this Vampire.
+            continue;
         }
-        if (minDd == INT_MAX) //< There is no move for this Vampire: skip it.
+        if (!move.isPossible) //< There is no move for this Vampire: skip it.
             continue;
 
-        moveItem(
-            vampire.item, vampire.item->x() + minDistance.x, vampire.item->y() + minDistance.y);
+        moveItem(vampire.item, vampire.item->x() + move.dx, vampire.item->y() + move.dy);
         hasSomeVampiresMoved = true;
     }
     return hasSomeVampiresMoved ? VampireResult::ok : VampireResult::win;
 }
 
+template<typename FieldReader>
+Vampires::Move Vampires::decideMove(const Vampire& vampire, const FieldReader& field) const
+{
+    const int x = vampire.item->x();
+    const int y = vampire.item->y();
+
+    Move move;
+    int minDd = INT_MAX;
+    for (int dir = 0; dir < (int) Direction::count; ++dir)
+    {
+        const Distance d = directionToDistance((Direction) dir);
+        if (isBorder(x + d.x, y + d.y))
+            continue; //< The border is impassable, and it is not stored in the field.
+
+        const auto& neighbour = field.at(x + d.x, y + d.y);
+        if (neighbour && neighbour->kind == Item::Kind::player)
+            return Move{.catchesPlayer = true, .dx = d.x, .dy = d.y};
+
+        if (neighbour)
+            continue; //< The intended move is impossible: the cell is occupied.
+
+        const int cx = 2 * (x - vampire.targetX);
+        const int cy = 2 * (y - vampire.targetY);
+        const int dd = ((d.x != 0)
+            ? ((d.x == 1) ? (1 + cx) : (1 - cx))
+            : 0)
+            +
+            ((d.y != 0)
+            ? ((d.y == 1) ? (1 + cy) : (1 - cy))
+            : 0);
+        if (minDd > dd)
+        {
+            minDd = dd;
+            move = Move{.isPossible = true, .dx = d.x, .dy = d.y};
+        }
+    }
+    return move;
+}
+
+static constexpr int kIsolationDistance = 2;
+
+/**
+ * A vampire with no other vampire within kIsolationDistance (in both x and y) is isolated: no
+ * other vampire's move can change the 3x3 cells it depends on, and vice versa, so its move can
+ * be decided up front.
+ */
+template<typename FieldReader>
+bool Vampires::isIsolated(const Item& vampire, const FieldReader& field) const
+{
+    for (int y = vampire.y() - kIsolationDistance; y <= vampire.y() + kIsolationDistance; ++y)
+    {
+        for (int x = vampire.x() - kIsolationDistance; x <= vampire.x() + kIsolationDistance; ++x)
+        {
+            if (isBorder(x, y) || (x == vampire.x() && y == vampire.y()))
+                continue;
+            const auto& item = field.at(x, y);
+            if (item && item->kind == Item::Kind::vampire)
+                return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Decides the moves of the isolated vampires into m_isolatedMoves on the threads of the worker
+ * pool, each thread taking a contiguous range of m_vampires and reading the field via its own
+ * tile cache.
+ */
+void Vampires::decideIsolatedMoves(int threadCount)
+{
+    if (!m_workerPool)
+        m_workerPool = std::make_unique<WorkerPool>(m_threadCount);
+
+    const int vampireCount = (int) m_vampires.size();
+    std::atomic<int> parallelMoveCount{0};
+    m_workerPool->run(threadCount,
+        [&](int threadIndex)
+        {
+            const SparseField<std::shared_ptr<Item>>::Reader field(m_field);
+            const int begin = (int) ((int64_t) vampireCount * threadIndex / threadCount);
+            const int end = (int) ((int64_t) vampireCount * (threadIndex + 1) / threadCount);
+            int count = 0;
+            for (int i = begin; i < end; ++i)
+            {
+                if (isIsolated(*m_vampires[i].item, field))
+                {
+                    m_isolatedMoves[i] = decideMove(m_vampires[i], field);
+                    ++count;
+                }
+            }
+            parallelMoveCount += count;
+        });
+    m_parallelMoveCount = parallelMoveCount;
+}
+
+void Vampires::setParallelism(int threadCount, int minVampiresPerThread)
+{
+    m_threadCount = std::max(1, threadCount);
+    m_minVampiresPerThread = std::max(1, minVampiresPerThread);
+    if (m_workerPool && m_workerPool->threadCount() != m_threadCount)
+        m_workerPool.reset();
+}
+
 } // namespace ms::vampires_nx_vms_plugin
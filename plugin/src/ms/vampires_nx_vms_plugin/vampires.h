@@ -2,11 +2,19 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include <nx/kit/debug.h>
 
+#include "field_quadtree.h"
+#include "sparse_field.h"
+#include "worker_pool.h"
+
 namespace ms::vampires_nx_vms_plugin {
 
 class Vampires
@@ -49,11 +57,14 @@ public:
             player,
             wall,
             vampire,
-            border,
+            border, /**< Not an actual item: the border cells are implicit, see isBorder(). */
         };
 
         static std::string toString(Kind kind);
 
+        /** Opaque bytes stored for each item in a snapshot, e.g. an id of a custom Item. */
+        using PersistentData = std::array<uint8_t, 16>;
+
         /** Inherit to provide a factory for custom Item objects. */
         class Factory
         {
@@ -64,8 +75,18 @@ public:
             {
                 return new Item(kind, x, y);
             }
+
+            /** Called instead of createItem() when restoring a snapshot. */
+            virtual Item* restoreItem(
+                Kind kind, int x, int y, const PersistentData& /*persistentData*/) const
+            {
+                return createItem(kind, x, y);
+            }
         };
 
+        /** Override to store custom data in snapshots; see Factory::restoreItem(). */
+        virtual PersistentData persistentData() const { return {}; }
+
         virtual std::string toString() const
         {
             return nx::kit::utils::format("%s(%d, %d)", toString(kind), m_x, m_y);
@@ -88,47 +109,195 @@ public:
     };
 
 public:
+    /**
+     * @param playerCount The players start in a row at the center of the field; the field width
+     *     must allow for it.
+     */
     Vampires(
-        int width, int height, int vampireCount, int wallCount,
+        int width, int height, int vampireCount, int wallCount, int playerCount = 1,
         std::shared_ptr<Item::Factory> itemFactory = std::make_shared<Item::Factory>());
 
-    PlayerResult movePlayer(Direction direction);
+    /** Moves the first player. */
+    PlayerResult movePlayer(Direction direction) { return movePlayer(/*player*/ 0, direction); }
+
+    /**
+     * A player moving onto a vampire is caught and leaves the field; the game is lost when the
+     * last player is caught. The moves of the caught players are ignored.
+     */
+    PlayerResult movePlayer(int player, Direction direction);
+
+    struct PlayerCommand
+    {
+        int player = 0;
+        Direction direction = Direction::count;
+    };
+
+    /**
+     * Applies the commands gathered from all the controllers during a frame in a single step, in
+     * the order of the player indexes (the commands of a player keep their order), so that the
+     * outcome does not depend on the order in which the controllers have been polled.
+     */
+    PlayerResult movePlayers(std::vector<PlayerCommand> commands);
 
+    /**
+     * Each vampire chases the player nearest to it, found via quadtree(); a vampire next to a
+     * player catches it instead of moving.
+     */
     VampireResult moveVampires();
 
+    static constexpr int kDefaultMinVampiresPerThread = 4096;
+
+    /**
+     * Allows moveVampires() to decide the moves of the vampires which are far from any other
+     * vampire on multiple threads, if there are at least minVampiresPerThread vampires per
+     * thread. The outcome is exactly the same as with a single thread.
+     */
+    void setParallelism(
+        int threadCount, int minVampiresPerThread = kDefaultMinVampiresPerThread);
+
+    /**
+     * @return Number of the vampires whose moves have been decided on multiple threads during
+     *     the last moveVampires().
+     */
+    int parallelMoveCount() const { return m_parallelMoveCount; }
+
+    /**
+     * Writes the game state to a versioned binary snapshot (the format is described in
+     * vampires_snapshot.cpp). The file is replaced atomically: a temporary file is written,
+     * flushed to disk, and renamed.
+     */
+    bool saveSnapshot(const std::string& path, std::string* outError) const;
+
+    /**
+     * Restores the game saved by saveSnapshot(), mapping the file into memory instead of reading
+     * it. The restored game continues exactly as the saved one would.
+     * @return Null on failure, with the reason in outError.
+     */
+    static std::unique_ptr<Vampires> restoreSnapshot(
+        const std::string& path,
+        std::shared_ptr<Item::Factory> itemFactory,
+        std::string* outError);
+
 public:
     const int width = -1;
     const int height = -1;
     const int vampireCount = -1;
     const int wallCount = -1;
+    const int playerCount = -1;
 
+    /** @return Null for an empty cell, including the border cells, which hold no items. */
     std::shared_ptr<Item> itemAt(int x, int y) const;
 
+    /**
+     * @return Whether the cell is on the outermost circle of the field, or beyond the field. The
+     *     border cells are impassable, but they are not stored, so that a huge field does not
+     *     spend memory on its perimeter.
+     */
+    bool isBorder(int x, int y) const
+    {
+        return x <= 0 || y <= 0 || x >= width - 1 || y >= height - 1;
+    }
+
+    /** Calls `visitor(const Item&)` for each item on the field, in no particular order. */
+    template<typename Visitor>
+    void forEachItem(Visitor visitor) const
+    {
+        m_field.forEachOccupied(
+            [&](int /*x*/, int /*y*/, const std::shared_ptr<Item>& item) { visitor(*item); });
+    }
+
+    /** @return Null if the player has been caught. */
+    const Item* player(int index) const { return m_players.at(index).get(); }
+
+    /** The first player which has not been caught; there is one until the game is lost. */
+    const Item& player() const;
+
+    int remainingPlayerCount() const { return m_remainingPlayerCount; }
+
+    /** Kept up to date on each change of the field; item kinds are stored as ints. */
+    const FieldQuadtree& quadtree() const { return m_quadtree; }
+
+    struct Cell
+    {
+        int x = -1;
+        int y = -1;
+    };
+
+    /**
+     * Cells which have been changed (created, vacated or occupied) since the last call to
+     * clearChangedCells(), in the order of changes; the same cell may be listed more than once.
+     */
+    const std::vector<Cell>& changedCells() const { return m_changedCells; }
+
+    void clearChangedCells() { m_changedCells.clear(); }
+
     /** Intended for debug. */
     void printField() const;
 
 private:
+    struct Uninitialized {};
+
+    Vampires(
+        int width, int height, int vampireCount, int wallCount, int playerCount,
+        std::shared_ptr<Item::Factory> itemFactory, Uninitialized);
+
     std::shared_ptr<Item> createItem(Item::Kind kind, int x, int y);
+    void addItem(std::shared_ptr<Item> item);
     void moveItem(std::shared_ptr<Item> item, int x, int y);
+    void removeItem(const std::shared_ptr<Item>& item);
+
+    /** @return Whether the game is lost, i.e. it was the last player, which stays on the field. */
+    bool catchPlayer(int x, int y);
     bool fieldHas(int x, int y, Item::Kind kind) const;
     void initGame();
 
 private:
     const std::shared_ptr<Item::Factory> m_itemFactory;
 
-    std::vector<std::vector<std::shared_ptr<Item>>> m_field; /**< Null item means an empty cell. */
+    SparseField<std::shared_ptr<Item>> m_field; /**< Null item means an empty cell. */
+    FieldQuadtree m_quadtree;
 
     struct Vampire
     {
         std::shared_ptr<Item> item;
-        int d = -1; /**< Distance to the player. */
+        int64_t d = -1; /**< Squared distance to the target; overflows int on huge fields. */
+        int targetX = -1; /**< Position of the player being chased. */
+        int targetY = -1;
 
-        Vampire(std::shared_ptr<Item> item, int d): item(item), d(d) {}
+        Vampire(std::shared_ptr<Item> item, int64_t d): item(item), d(d) {}
     };
 
     std::vector<Vampire> m_vampires;
 
-    std::shared_ptr<Item> m_player;
+    /** Decision of a vampire, which depends only on the 3x3 cells around it. */
+    struct Move
+    {
+        bool catchesPlayer = false;
+        bool isPossible = false;
+        int dx = 0;
+        int dy = 0;
+    };
+
+    template<typename FieldReader>
+    Move decideMove(const Vampire& vampire, const FieldReader& field) const;
+
+    template<typename FieldReader>
+    bool isIsolated(const Item& vampire, const FieldReader& field) const;
+
+    void decideIsolatedMoves(int threadCount);
+
+    int m_threadCount = 1;
+    int m_minVampiresPerThread = kDefaultMinVampiresPerThread;
+    std::unique_ptr<WorkerPool> m_workerPool; /**< Created on the first parallel tick. */
+
+    /** Reused by each tick: the decided move of each isolated vampire, by its index. */
+    std::vector<std::optional<Move>> m_isolatedMoves;
+    int m_parallelMoveCount = 0;
+
+    std::vector<std::shared_ptr<Item>> m_players; /**< Null for the caught players. */
+    int m_remainingPlayerCount = 0;
+
+    std::vector<Cell> m_changedCells;
 };
 
 } // namespace ms::vampires_nx_vms_plugin
@@ -0,0 +1,13 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "vampires_nx_vms_plugin_ini.h"
+
+namespace ms::vampires_nx_vms_plugin {
+
+Ini& ini()
+{
+    static Ini ini;
+    return ini;
+}
+
+} // namespace ms::vampires_nx_vms_plugin
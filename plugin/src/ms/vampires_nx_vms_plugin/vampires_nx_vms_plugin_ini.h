@@ -0,0 +1,25 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <nx/kit/ini_config.h>
+
+namespace ms::vampires_nx_vms_plugin {
+
+/** Debugging options, re-read while the plugin is running; see nx::kit::IniConfig. */
+struct Ini: public nx::kit::IniConfig
+{
+    Ini(): IniConfig("vampires_nx_vms_plugin.ini") { reload(); }
+
+    NX_INI_FLAG(0, enableTrace,
+        "Record the spans of processing each video frame. When turned off, and on the plugin\n"
+        "shutdown, the recorded spans are written to traceFile.");
+
+    NX_INI_STRING("", traceFile,
+        "Path to the Chrome trace-event JSON file, viewable via chrome://tracing or\n"
+        "ui.perfetto.dev. If empty, vampires_nx_vms_plugin_trace.json in the temp dir.");
+};
+
+Ini& ini();
+
+} // namespace ms::vampires_nx_vms_plugin
@@ -0,0 +1,301 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+/**@file
+ * Snapshot of the Vampires game state. All integers are in the native byte order, which is
+ * verified via a marker in the header; the layout:
+ *
+ * - Header (the struct below).
+ * - ItemRecord for each item on the field, in no particular order. The border is implicit; the
+ *     border records, written by the builds which stored the border as items, are ignored.
+ * - uint32 index of an ItemRecord for each vampire, in the order of Vampires::m_vampires, which
+ *     affects the moves of vampires with equal distances to the player.
+ * - uint32 index of an ItemRecord for each player, or kCaughtPlayer.
+ *
+ * The items are read directly from the mapped file. The checksum (64-bit FNV-1a) covers
+ * everything after the header.
+ */
+
+#include "vampires.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_WIN32)
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+#include <nx/kit/utils.h>
+
+#include "mapped_file.h"
+
+namespace ms::vampires_nx_vms_plugin {
+
+using nx::kit::utils::format;
+
+static constexpr char kMagic[8] = {'V', 'A', 'M', 'P', 'S', 'N', 'A', 'P'};
+static constexpr uint32_t kVersion = 2; //< Version 1 had a single player.
+static constexpr uint32_t kByteOrderMarker = 0x01020304;
+static constexpr uint32_t kCaughtPlayer = UINT32_MAX;
+
+namespace {
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrderMarker;
+    int32_t width;
+    int32_t height;
+    int32_t vampireCount;
+    int32_t wallCount;
+    uint32_t itemCount;
+    uint32_t vampireIndexCount;
+    uint32_t playerCount;
+    uint32_t reserved;
+    uint64_t checksum;
+};
+
+struct ItemRecord
+{
+    int32_t x;
+    int32_t y;
+    uint8_t kind;
+    uint8_t reserved[3];
+    Vampires::Item::PersistentData persistentData;
+};
+
+static_assert(sizeof(Header) == 56);
+static_assert(sizeof(ItemRecord) == 28);
+
+class Checksum
+{
+public:
+    void add(const void* data, size_t size)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i)
+            m_value = (m_value ^ bytes[i]) * 0x100000001B3ULL;
+    }
+
+    uint64_t value() const { return m_value; }
+
+private:
+    uint64_t m_value = 0xCBF29CE484222325ULL;
+};
+
+} // namespace
+
+static bool flushToDisk(FILE* file)
+{
+    if (fflush(file) != 0)
+        return false;
+    #if defined(_WIN32)
+        return _commit(_fileno(file)) == 0;
+    #else
+        return fsync(fileno(file)) == 0;
+    #endif
+}
+
+bool Vampires::saveSnapshot(const std::string& path, std::string* outError) const
+{
+    std::vector<ItemRecord> items;
+    std::unordered_map<const Item*, uint32_t> itemIndexes;
+    m_field.forEachOccupied(
+        [&](int x, int y, const std::shared_ptr<Item>& item)
+        {
+            itemIndexes[item.get()] = (uint32_t) items.size();
+            ItemRecord record{};
+            record.x = x;
+            record.y = y;
+            record.kind = (uint8_t) item->kind;
+            record.persistentData = item->persistentData();
+            items.push_back(record);
+        });
+
+    std::vector<uint32_t> vampireIndexes;
+    vampireIndexes.reserve(m_vampires.size());
+    for (const auto& vampire: m_vampires)
+        vampireIndexes.push_back(itemIndexes.at(vampire.item.get()));
+
+    std::vector<uint32_t> playerIndexes;
+    for (const auto& player: m_players)
+        playerIndexes.push_back(player ? itemIndexes.at(player.get()) : kCaughtPlayer);
+
+    Header header{};
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrderMarker = kByteOrderMarker;
+    header.width = width;
+    header.height = height;
+    header.vampireCount = vampireCount;
+    header.wallCount = wallCount;
+    header.itemCount = (uint32_t) items.size();
+    header.vampireIndexCount = (uint32_t) vampireIndexes.size();
+    header.playerCount = (uint32_t) playerIndexes.size();
+
+    Checksum checksum;
+    checksum.add(items.data(), items.size() * sizeof(ItemRecord));
+    checksum.add(vampireIndexes.data(), vampireIndexes.size() * sizeof(uint32_t));
+    checksum.add(playerIndexes.data(), playerIndexes.size() * sizeof(uint32_t));
+    header.checksum = checksum.value();
+
+    const std::string tempPath = path + ".tmp";
+    const std::string quotedTempPath = nx::kit::utils::toString(tempPath);
+    FILE* const file = fopen(tempPath.c_str(), "wb");
+    if (!file)
+    {
+        *outError = "Unable to create " + quotedTempPath + ": " + strerror(errno);
+        return false;
+    }
+    const bool isWritten =
+        fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(items.data(), sizeof(ItemRecord), items.size(), file) == items.size()
+        && fwrite(vampireIndexes.data(), sizeof(uint32_t), vampireIndexes.size(), file)
+            == vampireIndexes.size()
+        && fwrite(playerIndexes.data(), sizeof(uint32_t), playerIndexes.size(), file)
+            == playerIndexes.size()
+        && flushToDisk(file);
+    const int writeErrno = errno;
+    if (fclose(file) != 0 || !isWritten)
+    {
+        *outError = "Unable to write " + quotedTempPath + ": " + strerror(writeErrno);
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    std::error_code errorCode;
+    std::filesystem::rename(tempPath, path, errorCode); //< Atomically replaces the old file.
+    if (errorCode)
+    {
+        *outError = "Unable to rename " + quotedTempPath + ": " + errorCode.message();
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<Vampires> Vampires::restoreSnapshot(
+    const std::string& path,
+    std::shared_ptr<Item::Factory> itemFactory,
+    std::string* outError)
+{
+    const auto invalid =
+        [&](const std::string& reason)
+        {
+            *outError = "Invalid snapshot " + nx::kit::utils::toString(path) + ": " + reason;
+            return nullptr;
+        };
+
+    const std::unique_ptr<MappedFile> file = MappedFile::open(path, outError);
+    if (!file)
+        return nullptr;
+
+    if (file->size() < sizeof(Header))
+        return invalid("The file is too short.");
+    Header header;
+    memcpy(&header, file->data(), sizeof(header));
+    if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+        return invalid("Not a snapshot.");
+    if (header.version != kVersion)
+        return invalid(format("Unsupported version %u.", header.version));
+    if (header.byteOrderMarker != kByteOrderMarker)
+        return invalid("Saved on a platform with another byte order.");
+    if (header.width < 7 || header.height < 7 || header.vampireCount < 1 || header.wallCount < 1
+        || header.playerCount < 1 || header.playerCount > header.itemCount)
+    {
+        return invalid("Invalid game parameters.");
+    }
+
+    const uint64_t expectedSize = sizeof(Header)
+        + (uint64_t) header.itemCount * sizeof(ItemRecord)
+        + (uint64_t) header.vampireIndexCount * sizeof(uint32_t)
+        + (uint64_t) header.playerCount * sizeof(uint32_t);
+    if (file->size() != expectedSize)
+        return invalid("The file size does not match the header.");
+
+    const uint8_t* const itemData = file->data() + sizeof(Header);
+    const uint8_t* const vampireIndexData =
+        itemData + (size_t) header.itemCount * sizeof(ItemRecord);
+    const uint8_t* const playerIndexData =
+        vampireIndexData + (size_t) header.vampireIndexCount * sizeof(uint32_t);
+
+    Checksum checksum;
+    checksum.add(itemData, file->size() - sizeof(Header));
+    if (checksum.value() != header.checksum)
+        return invalid("Checksum mismatch.");
+
+    auto vampires = std::unique_ptr<Vampires>(new Vampires(header.width, header.height,
+        header.vampireCount, header.wallCount, (int) header.playerCount, std::move(itemFactory),
+        Uninitialized()));
+
+    // The records are copied rather than cast, not to rely on the alignment of the mapped bytes.
+    std::vector<std::shared_ptr<Item>> items(header.itemCount);
+    for (uint32_t i = 0; i < header.itemCount; ++i)
+    {
+        ItemRecord record;
+        memcpy(&record, itemData + (size_t) i * sizeof(ItemRecord), sizeof(record));
+        if (record.kind > (uint8_t) Item::Kind::border)
+            return invalid(format("Invalid kind of item %u.", i));
+        if (record.x < 0 || record.x >= header.width || record.y < 0 || record.y >= header.height)
+            return invalid(format("Item %u is out of the field.", i));
+        if (record.kind == (uint8_t) Item::Kind::border)
+            continue; //< Leaves a null item, which no player or vampire index may refer to.
+        if (vampires->isBorder(record.x, record.y))
+            return invalid(format("Item %u is on the border.", i));
+        if (vampires->m_field.at(record.x, record.y))
+            return invalid(format("Item %u overlaps another item.", i));
+
+        items[i].reset(vampires->m_itemFactory->restoreItem(
+            (Item::Kind) record.kind, record.x, record.y, record.persistentData));
+        vampires->addItem(items[i]);
+    }
+
+    std::vector<bool> isPlayerListed(header.itemCount);
+    for (uint32_t i = 0; i < header.playerCount; ++i)
+    {
+        uint32_t index = 0;
+        memcpy(&index, playerIndexData + (size_t) i * sizeof(uint32_t), sizeof(index));
+        if (index == kCaughtPlayer)
+        {
+            vampires->m_players.push_back(nullptr);
+            continue;
+        }
+        if (index >= header.itemCount || !items[index]
+            || items[index]->kind != Item::Kind::player
+            || isPlayerListed[index])
+        {
+            return invalid(format("Invalid index of player %u.", i));
+        }
+        isPlayerListed[index] = true;
+        vampires->m_players.push_back(items[index]);
+        ++vampires->m_remainingPlayerCount;
+    }
+    if (vampires->m_remainingPlayerCount == 0)
+        return invalid("All players have been caught.");
+
+    std::vector<bool> isVampireListed(header.itemCount);
+    vampires->m_vampires.reserve(header.vampireIndexCount);
+    for (uint32_t i = 0; i < header.vampireIndexCount; ++i)
+    {
+        uint32_t index = 0;
+        memcpy(&index, vampireIndexData + (size_t) i * sizeof(uint32_t), sizeof(index));
+        if (index >= header.itemCount || !items[index]
+            || items[index]->kind != Item::Kind::vampire
+            || isVampireListed[index])
+        {
+            return invalid(format("Invalid index of vampire %u.", i));
+        }
+        isVampireListed[index] = true;
+        vampires->m_vampires.push_back(Vampire{items[index], 0});
+    }
+
+    return vampires;
+}
+
+} // namespace ms::vampires_nx_vms_plugin
@@ -0,0 +1,79 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "worker_pool.h"
+
+#include <algorithm>
+
+#include <nx/kit/debug.h>
+
+namespace ms::vampires_nx_vms_plugin {
+
+WorkerPool::WorkerPool(int threadCount): m_threadCount(std::max(1, threadCount))
+{
+    for (int threadIndex = 1; threadIndex < m_threadCount; ++threadIndex)
+        m_threads.emplace_back([this, threadIndex]() { workerLoop(threadIndex); });
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+    }
+    m_taskAdded.notify_all();
+    for (auto& thread: m_threads)
+        thread.join();
+}
+
+void WorkerPool::run(int taskCount, const std::function<void(int threadIndex)>& task)
+{
+    if (!NX_KIT_ASSERT(taskCount >= 1 && taskCount <= m_threadCount))
+        taskCount = std::clamp(taskCount, 1, m_threadCount);
+
+    if (taskCount > 1)
+    {
+        {
+            const std::lock_guard<std::mutex> lock(m_mutex);
+            m_task = &task;
+            m_taskCount = taskCount;
+            m_busyWorkerCount = taskCount - 1;
+            ++m_generation;
+        }
+        m_taskAdded.notify_all();
+    }
+
+    task(/*threadIndex*/ 0);
+
+    if (taskCount > 1)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_workerFinished.wait(lock, [this]() { return m_busyWorkerCount == 0; });
+        m_task = nullptr;
+    }
+}
+
+void WorkerPool::workerLoop(int threadIndex)
+{
+    uint64_t lastGeneration = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+        m_taskAdded.wait(lock,
+            [&]() { return m_isStopping || m_generation != lastGeneration; });
+        if (m_isStopping)
+            return;
+        lastGeneration = m_generation;
+        if (threadIndex >= m_taskCount)
+            continue; //< Not needed for this run.
+
+        const std::function<void(int)>* const task = m_task;
+        lock.unlock();
+        (*task)(threadIndex);
+        lock.lock();
+
+        if (--m_busyWorkerCount == 0)
+            m_workerFinished.notify_one();
+    }
+}
+
+} // namespace ms::vampires_nx_vms_plugin
@@ -0,0 +1,56 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ms::vampires_nx_vms_plugin {
+
+/**
+ * Threads which stay alive between the calls to run(), so that a game tick does not pay for
+ * creating and joining the threads.
+ */
+class WorkerPool
+{
+public:
+    /** @param threadCount Including the thread which calls run(). */
+    explicit WorkerPool(int threadCount);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int threadCount() const { return m_threadCount; }
+
+    /**
+     * Calls `task(threadIndex)` for each threadIndex in [0, taskCount) concurrently, the index 0
+     * on the calling thread, and returns when all the calls have returned.
+     *
+     * @param taskCount At most threadCount().
+     */
+    void run(int taskCount, const std::function<void(int threadIndex)>& task);
+
+private:
+    void workerLoop(int threadIndex);
+
+private:
+    const int m_threadCount;
+
+    std::mutex m_mutex;
+    std::condition_variable m_taskAdded;
+    std::condition_variable m_workerFinished;
+    const std::function<void(int)>* m_task = nullptr;
+    int m_taskCount = 0;
+    uint64_t m_generation = 0; /**< Incremented by each run(), to wake each worker once. */
+    int m_busyWorkerCount = 0;
+    bool m_isStopping = false;
+
+    std::vector<std::thread> m_threads;
+};
+
+} // namespace ms::vampires_nx_vms_plugin
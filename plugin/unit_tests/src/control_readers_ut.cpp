@@ -0,0 +1,297 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nx/kit/test.h>
+
+#include <ms/vampires_nx_vms_plugin/shared_memory_reader.h>
+#include <ms/vampires_nx_vms_plugin/shared_memory_ring.h>
+#include <ms/vampires_nx_vms_plugin/socket_reader.h>
+#include <ms/vampires_nx_vms_plugin/socket_utils.h>
+
+namespace ms::vampires_nx_vms_plugin::test {
+
+static constexpr uint32_t kCapacity = SharedMemoryRing::kCapacity;
+
+static std::unique_ptr<SharedMemoryRing> makeRing()
+{
+    auto ring = std::make_unique<SharedMemoryRing>();
+    ring->init();
+    return ring;
+}
+
+/** @return A name which does not clash with the runs of the test in other processes. */
+static std::string uniqueName(const std::string& prefix)
+{
+    return prefix + std::to_string(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+TEST(SharedMemoryRing, pushAndPopWrapAround)
+{
+    const auto ring = makeRing();
+    ASSERT_TRUE(ring->isValid());
+    ASSERT_TRUE(ring->isDrained());
+    ASSERT_FALSE(ring->pop());
+
+    // Three times the capacity, in chunks not dividing it, so that the chunks straddle the end.
+    constexpr int kChunkSize = 1000;
+    int pushedCount = 0;
+    int poppedCount = 0;
+    while (pushedCount < 3 * (int) kCapacity)
+    {
+        for (int i = 0; i < kChunkSize; ++i)
+            ASSERT_TRUE(ring->push((char) (pushedCount++ % 251)));
+        ASSERT_FALSE(ring->isDrained());
+
+        while (const std::optional<char> c = ring->pop())
+            ASSERT_EQ((int) (char) (poppedCount++ % 251), (int) *c);
+        ASSERT_EQ(pushedCount, poppedCount);
+        ASSERT_TRUE(ring->isDrained());
+    }
+    ASSERT_TRUE(ring->writeIndex.load() > kCapacity);
+}
+
+TEST(SharedMemoryRing, indicesWrapAroundUint32)
+{
+    const auto ring = makeRing();
+    ring->writeIndex = UINT32_MAX - 2;
+    ring->readIndex = UINT32_MAX - 2;
+
+    for (char c = 'a'; c <= 'f'; ++c)
+        ASSERT_TRUE(ring->push(c));
+    ASSERT_EQ(3U, ring->writeIndex.load()); //< Has wrapped around.
+
+    for (char c = 'a'; c <= 'f'; ++c)
+        ASSERT_EQ(c, ring->pop().value_or('\0'));
+    ASSERT_TRUE(ring->isDrained());
+}
+
+TEST(SharedMemoryRing, fullRing)
+{
+    const auto ring = makeRing();
+    for (uint32_t i = 0; i < kCapacity; ++i)
+        ASSERT_TRUE(ring->push('x'));
+    ASSERT_FALSE(ring->push('y'));
+
+    ASSERT_EQ('x', ring->pop().value_or('\0'));
+    ASSERT_TRUE(ring->push('y'));
+    ASSERT_FALSE(ring->push('z'));
+}
+
+TEST(SharedMemoryRing, clear)
+{
+    const auto ring = makeRing();
+    ASSERT_EQ(0U, ring->clear());
+
+    for (char c = 'a'; c <= 'e'; ++c)
+        ring->push(c);
+    ring->pop();
+    ASSERT_FALSE(ring->isDrained());
+    ASSERT_EQ(4U, ring->clear());
+    ASSERT_TRUE(ring->isDrained());
+    ASSERT_FALSE(ring->pop());
+    ASSERT_EQ(0U, ring->clear());
+
+    // The ring stays usable after clearing.
+    ASSERT_TRUE(ring->push('f'));
+    ASSERT_EQ('f', ring->pop().value_or('\0'));
+}
+
+TEST(SharedMemoryReader, takesTheFirstKeyAndDropsTheRest)
+{
+    const std::string name = uniqueName("vampires_nx_vms_plugin_ut_");
+    SharedMemoryReader reader;
+    ASSERT_TRUE(reader.open(name));
+
+    const auto controller = SharedMemoryRingMapping::open(name);
+    ASSERT_TRUE(controller);
+
+    std::vector<ControlReader::PlayerKey> keys;
+    reader.takeKeys(&keys);
+    ASSERT_TRUE(keys.empty());
+
+    for (const char c: std::string("wwd"))
+        ASSERT_TRUE(controller->ring()->push(c));
+    reader.takeKeys(&keys);
+    ASSERT_EQ(1, (int) keys.size());
+    ASSERT_EQ(0, keys[0].player);
+    ASSERT_EQ('w', keys[0].key);
+    ASSERT_TRUE(controller->ring()->isDrained());
+}
+
+/** @return Fd of the connected client socket, or -1 on failure. */
+static int connectToUnixSocket(const std::string& path)
+{
+    const int fd = (int) socket(AF_UNIX, SOCK_STREAM, /*protocol*/ 0);
+    if (fd < 0)
+        return -1;
+
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    if (connect(fd, (sockaddr*) &addr, sizeof(addr)) != 0)
+    {
+        closeSocketFd(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void sendString(int fd, const std::string& s)
+{
+    const ConstBuffer buffer{s.data(), s.size()};
+    ASSERT_EQ((long long) s.size(), sendBuffers(fd, &buffer, /*count*/ 1));
+}
+
+/** Polls the reader, as the video frame thread does, until some keys arrive or the timeout. */
+static std::vector<ControlReader::PlayerKey> pollKeys(
+    SocketReader* reader, std::chrono::milliseconds timeout = std::chrono::seconds(5))
+{
+    std::vector<ControlReader::PlayerKey> keys;
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (keys.empty() && std::chrono::steady_clock::now() < deadline)
+    {
+        reader->takeKeys(&keys);
+        if (keys.empty())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return keys;
+}
+
+TEST(SocketReader, unixSocketConnectionsControlTheirPlayers)
+{
+    const std::string path =
+        (std::filesystem::temp_directory_path() / uniqueName("vampires_ut_")).string();
+
+    {
+        SocketReader reader(/*maxConnectionCount*/ 2);
+        ASSERT_TRUE(reader.startListening(path));
+        ASSERT_TRUE(std::filesystem::exists(path));
+
+        const int firstFd = connectToUnixSocket(path);
+        ASSERT_TRUE(firstFd >= 0);
+        sendString(firstFd, "ab"); //< Only the first key of a frame is taken.
+        auto keys = pollKeys(&reader);
+        ASSERT_EQ(1, (int) keys.size());
+        ASSERT_EQ(0, keys[0].player);
+        ASSERT_EQ('a', keys[0].key);
+
+        const int secondFd = connectToUnixSocket(path);
+        ASSERT_TRUE(secondFd >= 0);
+        sendString(secondFd, "c");
+        keys = pollKeys(&reader);
+        ASSERT_EQ(1, (int) keys.size());
+        ASSERT_EQ(1, keys[0].player);
+        ASSERT_EQ('c', keys[0].key);
+
+        // A reconnection takes the freed player slot.
+        closeSocketFd(firstFd);
+        ASSERT_TRUE(pollKeys(&reader, std::chrono::milliseconds(20)).empty()); //< Disconnects.
+        const int thirdFd = connectToUnixSocket(path);
+        ASSERT_TRUE(thirdFd >= 0);
+        sendString(thirdFd, "d");
+        keys = pollKeys(&reader);
+        ASSERT_EQ(1, (int) keys.size());
+        ASSERT_EQ(0, keys[0].player);
+        ASSERT_EQ('d', keys[0].key);
+
+        closeSocketFd(secondFd);
+        closeSocketFd(thirdFd);
+    }
+
+    ASSERT_FALSE(std::filesystem::exists(path)); //< Removed when the reader is destroyed.
+}
+
+/** @return A TCP port which was free a moment ago, or -1 on failure. */
+static int freeTcpPort()
+{
+    const int fd = (int) socket(AF_INET, SOCK_STREAM, /*protocol*/ 0);
+    if (fd < 0)
+        return -1;
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0; //< Any free port.
+    SocketLen len = sizeof(addr);
+    const bool isBound = bind(fd, (sockaddr*) &addr, sizeof(addr)) == 0
+        && getsockname(fd, (sockaddr*) &addr, &len) == 0;
+    closeSocketFd(fd);
+    return isBound ? ntohs(addr.sin_port) : -1;
+}
+
+/** @return Fd of the connected client socket, or -1 on failure. */
+static int connectToTcpPort(int port)
+{
+    const int fd = (int) socket(AF_INET, SOCK_STREAM, /*protocol*/ 0);
+    if (fd < 0)
+        return -1;
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((uint16_t) port);
+    if (connect(fd, (sockaddr*) &addr, sizeof(addr)) != 0)
+    {
+        closeSocketFd(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/** Closes the socket with a TCP reset, as happens when the controller process is killed. */
+static void resetTcpConnection(int fd)
+{
+    const linger lingerOption{/*l_onoff*/ 1, /*l_linger*/ 0};
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, (const char*) &lingerOption, sizeof(lingerOption));
+    closeSocketFd(fd);
+}
+
+TEST(SocketReader, resetConnectionFreesItsPlayer)
+{
+    const int port = freeTcpPort();
+    ASSERT_TRUE(port > 0);
+
+    SocketReader reader(/*maxConnectionCount*/ 1);
+    ASSERT_TRUE(reader.startListening(port));
+
+    const int firstFd = connectToTcpPort(port);
+    ASSERT_TRUE(firstFd >= 0);
+    sendString(firstFd, "a");
+    auto keys = pollKeys(&reader);
+    ASSERT_EQ(1, (int) keys.size());
+    ASSERT_EQ('a', keys[0].key);
+
+    // The read fails rather than reports the end of the stream, and the failure alone must free
+    // the player: the next poll accepts the reconnection and reads its key at once.
+    resetTcpConnection(firstFd);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20)); //< Let the reset arrive.
+    keys.clear();
+    reader.takeKeys(&keys);
+    ASSERT_TRUE(keys.empty());
+
+    const int secondFd = connectToTcpPort(port);
+    ASSERT_TRUE(secondFd >= 0);
+    sendString(secondFd, "b");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20)); //< Let the key arrive.
+    reader.takeKeys(&keys);
+    ASSERT_EQ(1, (int) keys.size());
+    ASSERT_EQ(0, keys[0].player);
+    ASSERT_EQ('b', keys[0].key);
+
+    closeSocketFd(secondFd);
+}
+
+} // namespace ms::vampires_nx_vms_plugin::test
@@ -0,0 +1,172 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <nx/kit/test.h>
+
+#include <ms/vampires_nx_vms_plugin/field_encoder.h>
+
+namespace ms::vampires_nx_vms_plugin::test {
+
+/** Reads the messages of FieldEncoder, as a spectator would. */
+class MessageReader
+{
+public:
+    explicit MessageReader(const std::string& message): m_message(message) {}
+
+    bool atEnd() const { return m_position == m_message.size(); }
+
+    char byte()
+    {
+        ASSERT_TRUE(!atEnd());
+        return m_message[m_position++];
+    }
+
+    uint64_t varint()
+    {
+        uint64_t result = 0;
+        for (int shift = 0; ; shift += 7)
+        {
+            ASSERT_TRUE(shift < 64);
+            const uint8_t b = (uint8_t) byte();
+            result |= (uint64_t) (b & 0x7F) << shift;
+            if ((b & 0x80) == 0)
+                return result;
+        }
+    }
+
+private:
+    const std::string& m_message;
+    size_t m_position = 0;
+};
+
+/** Cell codes of the field, row by row, as decoded by a spectator. */
+struct DecodedField
+{
+    int width = 0;
+    int height = 0;
+    std::vector<int> cellCodes;
+};
+
+static DecodedField decodeKeyframe(const std::string& message)
+{
+    MessageReader reader(message);
+    ASSERT_EQ('K', reader.byte());
+
+    DecodedField field;
+    field.width = (int) reader.varint();
+    field.height = (int) reader.varint();
+    while (!reader.atEnd())
+    {
+        const uint64_t run = reader.varint();
+        ASSERT_TRUE(run >> 3 > 0);
+        field.cellCodes.insert(field.cellCodes.end(), (size_t) (run >> 3), (int) (run & 7));
+    }
+    ASSERT_EQ((size_t) field.width * field.height, field.cellCodes.size());
+    return field;
+}
+
+/**
+ * Applies the delta to the field, checking that the cells are listed in the row-by-row order,
+ * each one at most once.
+ *
+ * @return Number of the cells in the delta.
+ */
+static int applyDelta(const std::string& message, DecodedField* field)
+{
+    MessageReader reader(message);
+    ASSERT_EQ('D', reader.byte());
+
+    const int count = (int) reader.varint();
+    int64_t previousIndex = -1;
+    for (int i = 0; i < count; ++i)
+    {
+        const int x = (int) reader.varint();
+        const int y = (int) reader.varint();
+        const int cellCode = reader.byte();
+        ASSERT_TRUE(x >= 0 && x < field->width && y >= 0 && y < field->height);
+
+        const int64_t index = (int64_t) y * field->width + x;
+        ASSERT_TRUE(index > previousIndex);
+        previousIndex = index;
+        field->cellCodes[(size_t) index] = cellCode;
+    }
+    ASSERT_TRUE(reader.atEnd());
+    return count;
+}
+
+static std::vector<int> cellCodes(const Vampires& vampires)
+{
+    std::vector<int> result;
+    result.reserve((size_t) vampires.width * vampires.height);
+    for (int y = 0; y < vampires.height; ++y)
+    {
+        for (int x = 0; x < vampires.width; ++x)
+            result.push_back(FieldEncoder::cellCode(vampires, x, y));
+    }
+    return result;
+}
+
+TEST(FieldEncoder, keyframeRoundTrip)
+{
+    srand(1);
+    // The empty rows are runs longer than fit into a single varint byte.
+    const Vampires vampires(/*width*/ 300, /*height*/ 40, /*vampireCount*/ 50, /*wallCount*/ 100);
+
+    const auto keyframe = FieldEncoder::encodeKeyframe(vampires);
+    ASSERT_TRUE(keyframe);
+    ASSERT_TRUE(keyframe->size() < (size_t) vampires.width * vampires.height / 4);
+
+    const DecodedField field = decodeKeyframe(*keyframe);
+    ASSERT_EQ(vampires.width, field.width);
+    ASSERT_EQ(vampires.height, field.height);
+    ASSERT_TRUE(cellCodes(vampires) == field.cellCodes);
+
+    // The border is not stored as items, but it is sent.
+    const int borderCode = FieldEncoder::cellCode(Vampires::Item::Kind::border);
+    ASSERT_EQ(borderCode, field.cellCodes.front());
+    ASSERT_EQ(borderCode, field.cellCodes[(size_t) vampires.width]); //< The left of the 2nd row.
+    ASSERT_EQ(borderCode, field.cellCodes.back());
+}
+
+TEST(FieldEncoder, deltasFollowTheField)
+{
+    srand(2);
+    Vampires vampires(/*width*/ 40, /*height*/ 30, /*vampireCount*/ 60, /*wallCount*/ 150,
+        /*playerCount*/ 3);
+    DecodedField field = decodeKeyframe(*FieldEncoder::encodeKeyframe(vampires));
+
+    vampires.clearChangedCells();
+    ASSERT_FALSE(FieldEncoder::encodeDelta(vampires));
+
+    bool hasRepeatedCells = false;
+    for (int tick = 0; tick < 200; ++tick)
+    {
+        vampires.clearChangedCells();
+        std::vector<Vampires::PlayerCommand> commands;
+        for (int player = 0; player < vampires.playerCount; ++player)
+            commands.push_back({player, (Vampires::Direction) (rand() % 8)});
+        const bool isLost = vampires.movePlayers(commands) == Vampires::PlayerResult::lost
+            || vampires.moveVampires() != Vampires::VampireResult::ok;
+
+        const auto delta = FieldEncoder::encodeDelta(vampires);
+        ASSERT_EQ(vampires.changedCells().empty(), !delta);
+        if (delta)
+        {
+            const int count = applyDelta(*delta, &field);
+            hasRepeatedCells |= count < (int) vampires.changedCells().size();
+        }
+        ASSERT_TRUE(cellCodes(vampires) == field.cellCodes);
+
+        if (isLost)
+            break;
+    }
+
+    // A cell vacated by one item and occupied by another is sent once, with its final state.
+    ASSERT_TRUE(hasRepeatedCells);
+}
+
+} // namespace ms::vampires_nx_vms_plugin::test
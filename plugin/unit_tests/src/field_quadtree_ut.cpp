@@ -0,0 +1,70 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <cstdint>
+#include <cstdlib>
+#include <tuple>
+#include <vector>
+
+#include <nx/kit/test.h>
+
+#include <ms/vampires_nx_vms_plugin/field_quadtree.h>
+
+namespace ms::vampires_nx_vms_plugin::test {
+
+TEST(FieldQuadtree, nearestMatchesBruteForce)
+{
+    constexpr int kWidth = 100;
+    constexpr int kHeight = 70;
+    constexpr int kKind = 0;
+    constexpr int kOtherKind = 1;
+
+    FieldQuadtree quadtree(kWidth, kHeight);
+    ASSERT_FALSE(quadtree.nearest(kKind, 10, 10));
+
+    srand(11);
+    std::vector<FieldQuadtree::Point> points;
+    for (int i = 0; i < 30; ++i)
+    {
+        const FieldQuadtree::Point point{rand() % kWidth, rand() % kHeight};
+        bool isDuplicate = false;
+        for (const auto& p: points)
+            isDuplicate |= p.x == point.x && p.y == point.y;
+        if (isDuplicate)
+            continue;
+        points.push_back(point);
+        quadtree.add(kKind, point.x, point.y);
+    }
+    quadtree.add(kOtherKind, 50, 35); //< Must be ignored.
+
+    for (int y = 0; y < kHeight; y += 3)
+    {
+        for (int x = 0; x < kWidth; x += 3)
+        {
+            FieldQuadtree::Point expected;
+            std::tuple<int64_t, int, int> best{INT64_MAX, 0, 0};
+            for (const auto& p: points)
+            {
+                const int64_t dx = p.x - x;
+                const int64_t dy = p.y - y;
+                const std::tuple<int64_t, int, int> order{dx * dx + dy * dy, p.y, p.x};
+                if (order < best)
+                {
+                    best = order;
+                    expected = p;
+                }
+            }
+
+            const auto nearest = quadtree.nearest(kKind, x, y);
+            ASSERT_TRUE(nearest);
+            ASSERT_EQ(expected.x, nearest->x);
+            ASSERT_EQ(expected.y, nearest->y);
+        }
+    }
+
+    // Removed cells are not found.
+    for (const auto& p: points)
+        quadtree.remove(kKind, p.x, p.y);
+    ASSERT_FALSE(quadtree.nearest(kKind, 10, 10));
+}
+
+} // namespace ms::vampires_nx_vms_plugin::test
@@ -0,0 +1,27 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <string>
+
+#include <ms/vampires_nx_vms_plugin/vampires.h>
+
+namespace ms::vampires_nx_vms_plugin::test {
+
+/** @return The field as one char per cell, for comparing games. */
+inline std::string fieldSnapshot(const Vampires& vampires)
+{
+    std::string result;
+    result.reserve((size_t) vampires.width * vampires.height);
+    for (int y = 0; y < vampires.height; ++y)
+    {
+        for (int x = 0; x < vampires.width; ++x)
+        {
+            const auto item = vampires.itemAt(x, y);
+            result.push_back(item ? (char) ('0' + (int) item->kind) : '.');
+        }
+    }
+    return result;
+}
+
+} // namespace ms::vampires_nx_vms_plugin::test
@@ -0,0 +1,19 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <iostream>
+
+#include <nx/kit/test.h>
+
+int main()
+{
+    const int failedTestsCount = nx::kit::test::runAllTests("vampires_nx_vms_plugin");
+
+    std::cerr << std::endl;
+
+    if (failedTestsCount == 0)
+        std::cerr << "SUCCESS: All test suites PASSED." << std::endl;
+    else
+        std::cerr << failedTestsCount << " test(s) FAILED. See the messages above." << std::endl;
+
+    return failedTestsCount;
+}
@@ -0,0 +1,123 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nx/kit/test.h>
+
+#include <ms/vampires_nx_vms_plugin/metrics.h>
+#include <ms/vampires_nx_vms_plugin/metrics_server.h>
+#include <ms/vampires_nx_vms_plugin/socket_utils.h>
+
+namespace ms::vampires_nx_vms_plugin::test {
+
+TEST(Metrics, counterSumsUpdatesOfAllThreads)
+{
+    Counter counter("test_total", "Test counter.");
+
+    static constexpr int kThreadCount = 2 * Metric::kShardCount + 3; //< Some threads share shards.
+    static constexpr int kAddCount = 10000;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreadCount; ++i)
+    {
+        threads.emplace_back(
+            [&counter]()
+            {
+                for (int j = 0; j < kAddCount; ++j)
+                    counter.add();
+            });
+    }
+    for (auto& thread: threads)
+        thread.join();
+
+    ASSERT_EQ((uint64_t) kThreadCount * kAddCount, counter.value());
+
+    std::string text;
+    counter.appendText(&text);
+    ASSERT_EQ(
+        "# HELP test_total Test counter.\n"
+        "# TYPE test_total counter\n"
+        "test_total " + std::to_string(kThreadCount * kAddCount) + "\n",
+        text);
+}
+
+TEST(Metrics, histogramBucketsAreCumulative)
+{
+    Histogram histogram("test_seconds", "Test histogram.", {0.1, 1, 10});
+    for (const double value: {0.05, 0.1, 0.5, 2.0, 3.0, 100.0})
+        histogram.observe(value);
+
+    ASSERT_EQ(6U, histogram.count());
+    ASSERT_EQ(105.65, histogram.sum());
+
+    std::string text;
+    histogram.appendText(&text);
+    ASSERT_EQ(
+        "# HELP test_seconds Test histogram.\n"
+        "# TYPE test_seconds histogram\n"
+        "test_seconds_bucket{le=\"0.1\"} 2\n" //< The upper bound is inclusive.
+        "test_seconds_bucket{le=\"1\"} 3\n"
+        "test_seconds_bucket{le=\"10\"} 5\n"
+        "test_seconds_bucket{le=\"+Inf\"} 6\n"
+        "test_seconds_sum 105.65\n"
+        "test_seconds_count 6\n",
+        text);
+}
+
+static std::string httpGet(int port, const std::string& path)
+{
+    const int fd = (int) socket(PF_INET, SOCK_STREAM, /*protocol*/ 0);
+    if (fd < 0)
+        return "";
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+
+    std::string response;
+    if (connect(fd, (sockaddr*) &addr, sizeof(addr)) == 0)
+    {
+        const std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        const ConstBuffer buffer{request.data(), request.size()};
+        if (sendBuffers(fd, &buffer, /*count*/ 1) == (long long) request.size())
+        {
+            char data[4096];
+            int r = 0;
+            while ((r = (int) recv(fd, data, sizeof(data), /*flags*/ 0)) > 0)
+                response.append(data, (size_t) r);
+        }
+    }
+    closeSocketFd(fd);
+    return response;
+}
+
+TEST(Metrics, serverExposesMetrics)
+{
+    // Find a free port.
+    std::unique_ptr<MetricsServer> server;
+    for (int port = 39100; port < 39200 && !server; ++port)
+    {
+        server = std::make_unique<MetricsServer>();
+        if (!server->start(port))
+            server.reset();
+    }
+    ASSERT_TRUE(server);
+
+    Metrics::instance().framesReceived.add(3);
+
+    const std::string response = httpGet(server->port(), "/metrics");
+    ASSERT_TRUE(response.starts_with("HTTP/1.1 200 OK\r\n"));
+    ASSERT_TRUE(response.find("\r\n# HELP vampires_frames_received_total ") != std::string::npos);
+    ASSERT_TRUE(response.find("\nvampires_frames_received_total 3\n") != std::string::npos);
+    ASSERT_TRUE(response.find("\nvampires_move_vampires_duration_seconds_bucket{le=\"+Inf\"} ")
+        != std::string::npos);
+
+    ASSERT_TRUE(httpGet(server->port(), "/other").starts_with("HTTP/1.1 404 Not Found\r\n"));
+}
+
+} // namespace ms::vampires_nx_vms_plugin::test
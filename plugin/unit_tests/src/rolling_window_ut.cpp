@@ -0,0 +1,44 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <nx/kit/test.h>
+
+#include <ms/vampires_nx_vms_plugin/rolling_window.h>
+
+namespace ms::vampires_nx_vms_plugin::test {
+
+TEST(RollingWindow, keepsLastSamples)
+{
+    RollingWindow<4> window;
+    ASSERT_TRUE(window.isEmpty());
+    ASSERT_EQ(0.0, window.average());
+    ASSERT_EQ(0.0, window.max());
+
+    window.add(2);
+    window.add(4);
+    ASSERT_EQ(2, window.count());
+    ASSERT_EQ(3.0, window.average());
+    ASSERT_EQ(4.0, window.max());
+
+    for (const double value: {10, 1, 1, 1, 1})
+        window.add(value);
+    ASSERT_EQ(4, window.count());
+    ASSERT_EQ(1.0, window.average()); //< 10 has been pushed out.
+    ASSERT_EQ(1.0, window.max());
+
+    window.clear();
+    ASSERT_TRUE(window.isEmpty());
+    window.add(5);
+    ASSERT_EQ(5.0, window.average());
+}
+
+TEST(RollingWindow, sumDoesNotDrift)
+{
+    RollingWindow<8> window;
+    for (int i = 0; i < 100000; ++i)
+        window.add((i % 2 == 0) ? 1e9 : 0.1);
+    for (int i = 0; i < 8; ++i)
+        window.add(0.5);
+    ASSERT_EQ(0.5, window.average());
+}
+
+} // namespace ms::vampires_nx_vms_plugin::test
@@ -0,0 +1,55 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <cstdlib>
+#include <memory>
+
+#include <nx/kit/test.h>
+
+#include <ms/vampires_nx_vms_plugin/shared_world.h>
+
+namespace ms::vampires_nx_vms_plugin::test {
+
+TEST(SharedWorld, earliestSubscriberDrivesAndNextOneTakesOver)
+{
+    // Only the addresses of the DeviceAgents are used.
+    const auto* const first = reinterpret_cast<const DeviceAgent*>(0x10);
+    const auto* const second = reinterpret_cast<const DeviceAgent*>(0x20);
+
+    SharedWorld world;
+    ASSERT_FALSE(world.isDriver(first));
+    world.subscribe(first);
+    world.subscribe(second);
+    world.subscribe(first); //< Subscribing again keeps the order.
+    ASSERT_TRUE(world.isDriver(first));
+    ASSERT_FALSE(world.isDriver(second));
+
+    srand(1);
+    const auto vampires = std::make_shared<Vampires>(
+        /*width*/ 20, /*height*/ 20, /*vampireCount*/ 5, /*wallCount*/ 30);
+    world.setVampires(vampires);
+    ASSERT_FALSE(world.objects());
+    const auto objects = std::make_shared<const ObjectMetadataList>();
+    world.publish(objects);
+
+    world.unsubscribe(first);
+    ASSERT_TRUE(world.isDriver(second));
+    ASSERT_TRUE(world.vampires() == vampires); //< The game goes on.
+    ASSERT_TRUE(world.objects() == objects);
+
+    world.unsubscribe(second);
+    ASSERT_FALSE(world.isDriver(second));
+}
+
+TEST(SharedWorld, packetsShareObjectsWithOwnTimestamps)
+{
+    const auto objects = std::make_shared<const ObjectMetadataList>(3);
+    const auto packet1 = nx::sdk::makePtr<SharedObjectMetadataPacket>(objects, /*timestampUs*/ 1);
+    const auto packet2 = nx::sdk::makePtr<SharedObjectMetadataPacket>(objects, /*timestampUs*/ 2);
+    ASSERT_EQ(1, packet1->timestampUs());
+    ASSERT_EQ(2, packet2->timestampUs());
+    ASSERT_EQ(3, packet1->count());
+    ASSERT_EQ(3, packet2->count());
+    ASSERT_EQ(3, (int) objects.use_count());
+}
+
+} // namespace ms::vampires_nx_vms_plugin::test
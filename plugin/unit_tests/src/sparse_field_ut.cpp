@@ -0,0 +1,155 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <nx/kit/test.h>
+
+#include <ms/vampires_nx_vms_plugin/sparse_field.h>
+
+namespace ms::vampires_nx_vms_plugin::test {
+
+using Field = SparseField<std::shared_ptr<int>>;
+
+static constexpr int kTileSize = Field::kTileSize;
+
+/** @return Value of the cell, or -1 for an empty cell. */
+static int valueAt(const Field& field, int x, int y)
+{
+    const auto& value = field.at(x, y);
+    return value ? *value : -1;
+}
+
+static std::vector<std::tuple<int, int, int>> occupiedCells(const Field& field)
+{
+    std::vector<std::tuple<int, int, int>> result;
+    field.forEachOccupied(
+        [&](int x, int y, const std::shared_ptr<int>& value)
+        {
+            result.emplace_back(x, y, *value);
+        });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+TEST(SparseField, tilesAreFreedOnVacate)
+{
+    Field field(/*width*/ 100, /*height*/ 50);
+    ASSERT_EQ(0, field.tileCount());
+    ASSERT_EQ(-1, valueAt(field, 99, 49));
+
+    field.set(0, 0, nullptr); //< Vacating an empty cell does not allocate a tile.
+    ASSERT_EQ(0, field.tileCount());
+
+    field.set(1, 2, std::make_shared<int>(1));
+    field.set(kTileSize - 1, kTileSize - 1, std::make_shared<int>(2)); //< The same tile.
+    ASSERT_EQ(1, field.tileCount());
+    field.set(kTileSize, 2, std::make_shared<int>(3)); //< The next tile.
+    field.set(99, 49, std::make_shared<int>(4)); //< The last, partial tile.
+    ASSERT_EQ(3, field.tileCount());
+    ASSERT_EQ(1, valueAt(field, 1, 2));
+    ASSERT_EQ(2, valueAt(field, kTileSize - 1, kTileSize - 1));
+    ASSERT_EQ(3, valueAt(field, kTileSize, 2));
+    ASSERT_EQ(4, valueAt(field, 99, 49));
+    ASSERT_EQ(-1, valueAt(field, 2, 1));
+
+    // Replacing a value keeps the tile.
+    field.set(1, 2, std::make_shared<int>(5));
+    ASSERT_EQ(5, valueAt(field, 1, 2));
+    ASSERT_EQ(3, field.tileCount());
+
+    field.set(1, 2, nullptr);
+    ASSERT_EQ(3, field.tileCount()); //< The tile still has an occupied cell.
+    field.set(kTileSize - 1, kTileSize - 1, nullptr);
+    ASSERT_EQ(2, field.tileCount());
+    ASSERT_EQ(-1, valueAt(field, kTileSize - 1, kTileSize - 1));
+
+    // A freed tile is allocated again, the cached lookups not referring to the freed one.
+    field.set(3, 3, std::make_shared<int>(6));
+    ASSERT_EQ(3, field.tileCount());
+    ASSERT_EQ(6, valueAt(field, 3, 3));
+    ASSERT_EQ(-1, valueAt(field, 1, 2));
+
+    field.set(3, 3, nullptr);
+    field.set(kTileSize, 2, nullptr);
+    field.set(99, 49, nullptr);
+    ASSERT_EQ(0, field.tileCount());
+    ASSERT_TRUE(occupiedCells(field).empty());
+}
+
+TEST(SparseField, move)
+{
+    Field field(/*width*/ 64, /*height*/ 64);
+    const auto value = std::make_shared<int>(7);
+    field.set(5, 5, value);
+
+    field.move(5, 5, 6, 7); //< Within the tile, which must not be freed on the way.
+    ASSERT_EQ(1, field.tileCount());
+    ASSERT_EQ(-1, valueAt(field, 5, 5));
+    ASSERT_TRUE(field.at(6, 7) == value); //< The same value, not a copy.
+
+    field.move(6, 7, kTileSize, 7); //< Across the tiles: the old one is freed.
+    ASSERT_EQ(1, field.tileCount());
+    ASSERT_EQ(-1, valueAt(field, 6, 7));
+    ASSERT_EQ(7, valueAt(field, kTileSize, 7));
+
+    field.set(0, 0, std::make_shared<int>(8));
+    field.move(kTileSize, 7, kTileSize - 1, kTileSize); //< Diagonally, into a third tile.
+    ASSERT_EQ(2, field.tileCount());
+    ASSERT_TRUE(occupiedCells(field) == (std::vector<std::tuple<int, int, int>>{
+        {0, 0, 8}, {kTileSize - 1, kTileSize, 7}}));
+    ASSERT_EQ(2, (int) value.use_count()); //< Held by the field and by the test only.
+}
+
+TEST(SparseField, reader)
+{
+    Field field(/*width*/ 200, /*height*/ 200);
+    for (int i = 0; i < 200; i += 3)
+        field.set(i, 199 - i, std::make_shared<int>(i));
+
+    const Field::Reader reader(field);
+    for (int y = 0; y < 200; ++y)
+    {
+        for (int x = 0; x < 200; ++x)
+        {
+            const auto& value = reader.at(x, y);
+            const bool isExpected = x % 3 == 0 && x + y == 199;
+            ASSERT_EQ(isExpected, (bool) value);
+            if (value)
+                ASSERT_EQ(x, *value);
+        }
+    }
+
+    // Readers on different threads, each with its own cache, see the same field.
+    std::vector<int> sums(4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < (int) sums.size(); ++t)
+    {
+        threads.emplace_back(
+            [&field, &sum = sums[t]]()
+            {
+                const Field::Reader threadReader(field);
+                for (int i = 0; i < 200; ++i)
+                {
+                    if (const auto& value = threadReader.at(i, 199 - i))
+                        sum += *value;
+                }
+            });
+    }
+    for (auto& thread: threads)
+        thread.join();
+    for (const int sum: sums)
+        ASSERT_EQ(3 * (66 * 67 / 2), sum);
+
+    // A Reader created after a change sees it; tiles freed before it was created are absent.
+    field.set(0, 199, nullptr);
+    field.set(10, 10, std::make_shared<int>(-5));
+    const Field::Reader newReader(field);
+    ASSERT_FALSE(newReader.at(0, 199));
+    ASSERT_EQ(-5, *newReader.at(10, 10));
+}
+
+} // namespace ms::vampires_nx_vms_plugin::test
@@ -0,0 +1,201 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <nx/kit/test.h>
+
+#include <ms/vampires_nx_vms_plugin/vampires.h>
+
+#include "field_snapshot.h"
+
+namespace ms::vampires_nx_vms_plugin::test {
+
+namespace {
+
+/** Stores its id in snapshots, like the Items of the plugin store their track ids. */
+class IdentifiedItem: public Vampires::Item
+{
+public:
+    IdentifiedItem(Kind kind, int x, int y, const PersistentData& id):
+        Vampires::Item(kind, x, y), id(id)
+    {
+    }
+
+    virtual PersistentData persistentData() const override { return id; }
+
+    const PersistentData id;
+};
+
+class IdentifiedItemFactory: public Vampires::Item::Factory
+{
+    using PersistentData = Vampires::Item::PersistentData;
+
+public:
+    virtual Vampires::Item* createItem(Vampires::Item::Kind kind, int x, int y) const override
+    {
+        PersistentData id{};
+        id[0] = (uint8_t) ++m_lastId;
+        id[15] = (uint8_t) (m_lastId >> 8);
+        return new IdentifiedItem(kind, x, y, id);
+    }
+
+    virtual Vampires::Item* restoreItem(Vampires::Item::Kind kind, int x, int y,
+        const PersistentData& persistentData) const override
+    {
+        return new IdentifiedItem(kind, x, y, persistentData);
+    }
+
+private:
+    mutable int m_lastId = 0;
+};
+
+} // namespace
+
+static std::string readFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void writeFile(const std::string& path, const std::string& data)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << data;
+}
+
+static void play(Vampires* vampires, int tickCount, int seed)
+{
+    srand(seed);
+    for (int tick = 0; tick < tickCount; ++tick)
+    {
+        std::vector<Vampires::PlayerCommand> commands;
+        for (int player = 0; player < vampires->playerCount; ++player)
+        {
+            commands.push_back({player,
+                (Vampires::Direction) (rand() % (int) Vampires::Direction::count)});
+        }
+        vampires->movePlayers(commands);
+        vampires->moveVampires();
+    }
+}
+
+static void testRestoredGameContinuesIdentically(int playerCount)
+{
+    const std::string path = std::string(nx::kit::test::tempDir()) + "game.snapshot";
+
+    srand(7);
+    Vampires original(/*width*/ 60, /*height*/ 40, /*vampireCount*/ 50, /*wallCount*/ 500,
+        playerCount, std::make_shared<IdentifiedItemFactory>());
+    play(&original, /*tickCount*/ 20, /*seed*/ 1);
+
+    std::string error;
+    ASSERT_TRUE(original.saveSnapshot(path, &error));
+    ASSERT_EQ("", error);
+
+    const auto restored =
+        Vampires::restoreSnapshot(path, std::make_shared<IdentifiedItemFactory>(), &error);
+    ASSERT_TRUE(restored);
+    ASSERT_EQ("", error);
+    ASSERT_EQ(original.width, restored->width);
+    ASSERT_EQ(original.height, restored->height);
+    ASSERT_EQ(original.vampireCount, restored->vampireCount);
+    ASSERT_EQ(original.wallCount, restored->wallCount);
+    ASSERT_EQ(original.playerCount, restored->playerCount);
+    ASSERT_EQ(original.remainingPlayerCount(), restored->remainingPlayerCount());
+    ASSERT_EQ(fieldSnapshot(original), fieldSnapshot(*restored));
+
+    for (int y = 0; y < original.height; ++y)
+    {
+        for (int x = 0; x < original.width; ++x)
+        {
+            if (const auto item = original.itemAt(x, y))
+                ASSERT_TRUE(item->persistentData() == restored->itemAt(x, y)->persistentData());
+        }
+    }
+
+    // The order of the vampires is restored as well, so the games do not diverge.
+    play(&original, /*tickCount*/ 50, /*seed*/ 2);
+    play(restored.get(), /*tickCount*/ 50, /*seed*/ 2);
+    ASSERT_EQ(fieldSnapshot(original), fieldSnapshot(*restored));
+}
+
+TEST(VampiresSnapshot, restoredGameContinuesIdentically)
+{
+    testRestoredGameContinuesIdentically(/*playerCount*/ 1);
+}
+
+TEST(VampiresSnapshot, restoredMultiPlayerGameContinuesIdentically)
+{
+    testRestoredGameContinuesIdentically(/*playerCount*/ 3);
+}
+
+TEST(VampiresSnapshot, saveReplacesExistingFile)
+{
+    const std::string path = std::string(nx::kit::test::tempDir()) + "game.snapshot";
+    std::string error;
+
+    srand(1);
+    Vampires first(/*width*/ 20, /*height*/ 20, /*vampireCount*/ 5, /*wallCount*/ 30);
+    ASSERT_TRUE(first.saveSnapshot(path, &error));
+
+    srand(2);
+    Vampires second(/*width*/ 30, /*height*/ 25, /*vampireCount*/ 9, /*wallCount*/ 60);
+    ASSERT_TRUE(second.saveSnapshot(path, &error));
+
+    const auto restored = Vampires::restoreSnapshot(
+        path, std::make_shared<Vampires::Item::Factory>(), &error);
+    ASSERT_TRUE(restored);
+    ASSERT_EQ(fieldSnapshot(second), fieldSnapshot(*restored));
+    ASSERT_FALSE(std::ifstream(path + ".tmp").good()); //< The temporary file was renamed.
+}
+
+TEST(VampiresSnapshot, invalidSnapshotsAreRejected)
+{
+    const std::string dir = nx::kit::test::tempDir();
+    const std::string path = dir + "game.snapshot";
+    std::string error;
+
+    srand(3);
+    Vampires vampires(/*width*/ 20, /*height*/ 20, /*vampireCount*/ 5, /*wallCount*/ 30);
+    ASSERT_TRUE(vampires.saveSnapshot(path, &error));
+    const std::string data = readFile(path);
+    ASSERT_TRUE(data.size() > 100);
+
+    const auto assertRejected =
+        [&](const std::string& name, const std::string& corruptedData, const std::string& reason)
+        {
+            const std::string corruptedPath = dir + name;
+            writeFile(corruptedPath, corruptedData);
+            error.clear();
+            ASSERT_FALSE(Vampires::restoreSnapshot(
+                corruptedPath, std::make_shared<Vampires::Item::Factory>(), &error));
+            ASSERT_TRUE(error.find(reason) != std::string::npos);
+        };
+
+    assertRejected("empty", "", "too short");
+    assertRejected("truncated", data.substr(0, data.size() - 1), "size does not match");
+
+    std::string badMagic = data;
+    badMagic[0] = 'X';
+    assertRejected("bad_magic", badMagic, "Not a snapshot");
+
+    std::string badVersion = data;
+    badVersion[8] = 99;
+    assertRejected("bad_version", badVersion, "Unsupported version");
+
+    std::string corruptedItem = data;
+    corruptedItem[data.size() / 2] ^= 0x40;
+    assertRejected("corrupted_item", corruptedItem, "Checksum mismatch");
+
+    error.clear();
+    ASSERT_FALSE(Vampires::restoreSnapshot(
+        dir + "missing", std::make_shared<Vampires::Item::Factory>(), &error));
+    ASSERT_FALSE(error.empty());
+}
+
+} // namespace ms::vampires_nx_vms_plugin::test
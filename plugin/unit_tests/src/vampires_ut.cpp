@@ -0,0 +1,419 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <nx/kit/test.h>
+
+#include <ms/vampires_nx_vms_plugin/vampires.h>
+
+#include "field_snapshot.h"
+
+namespace ms::vampires_nx_vms_plugin::test {
+
+static std::string changedCellsSnapshot(const std::vector<Vampires::Cell>& cells)
+{
+    std::string result;
+    for (const auto& cell: cells)
+        result += std::to_string(cell.x) + "," + std::to_string(cell.y) + ";";
+    return result;
+}
+
+static std::vector<Vampires::PlayerCommand> randomCommands(int playerCount)
+{
+    std::vector<Vampires::PlayerCommand> commands;
+    for (int player = 0; player < playerCount; ++player)
+    {
+        commands.push_back(
+            {player, (Vampires::Direction) (rand() % (int) Vampires::Direction::count)});
+    }
+    return commands;
+}
+
+/**
+ * Frozen copy of the single-player moveVampires() as it was before the parallel movement, playing
+ * on its own copy of the field: the movement must stay the same whatever the number of threads.
+ */
+class ReferenceGame
+{
+public:
+    /** Copies a just created game, taking the vampires in the order of their creation. */
+    explicit ReferenceGame(const Vampires& vampires):
+        m_width(vampires.width),
+        m_height(vampires.height),
+        m_cells((size_t) vampires.width * vampires.height, kEmpty)
+    {
+        for (int y = 0; y < m_height; ++y)
+        {
+            for (int x = 0; x < m_width; ++x)
+            {
+                if (vampires.isBorder(x, y))
+                    cell(x, y) = (int8_t) Vampires::Item::Kind::border;
+            }
+        }
+
+        applyChangedCells(vampires);
+        for (const auto& changedCell: vampires.changedCells())
+        {
+            if (cell(changedCell.x, changedCell.y) == (int8_t) Vampires::Item::Kind::vampire)
+                m_vampires.push_back({changedCell.x, changedCell.y});
+        }
+    }
+
+    /** Takes the changes made by the moves of the player, which the reference does not make. */
+    void applyChangedCells(const Vampires& vampires)
+    {
+        for (const auto& changedCell: vampires.changedCells())
+        {
+            const auto item = vampires.itemAt(changedCell.x, changedCell.y);
+            cell(changedCell.x, changedCell.y) = item ? (int8_t) item->kind : kEmpty;
+            if (item && item->kind == Vampires::Item::Kind::player)
+            {
+                m_playerX = item->x();
+                m_playerY = item->y();
+            }
+        }
+    }
+
+    Vampires::VampireResult moveVampires()
+    {
+        m_changedCells.clear();
+
+        // Calculate the distance to the player for each Vampire.
+        for (auto& vampire: m_vampires)
+        {
+            const int dx = vampire.x - m_playerX;
+            const int dy = vampire.y - m_playerY;
+            vampire.d = dx * dx + dy * dy;
+        }
+
+        // Sort Vampires by the distance to the player, the closest first.
+        std::sort(m_vampires.begin(), m_vampires.end(),
+            [](const Vampire& v1, const Vampire& v2)
+            {
+                return v1.d > v2.d;
+            });
+
+        // Each vampire moves to come closer to the player, and if there is any move, it must move.
+        bool hasSomeVampiresMoved = false;
+        for (auto& vampire: m_vampires)
+        {
+            int minDd = INT_MAX;
+            Vampires::Cell minDistance{0, 0};
+            for (const auto& d: kDirections)
+            {
+                const int8_t neighbour = cell(vampire.x + d.x, vampire.y + d.y);
+                if (neighbour == (int8_t) Vampires::Item::Kind::player)
+                    return Vampires::VampireResult::lost;
+
+                if (neighbour != kEmpty)
+                    continue; //< The intended move is impossible: the cell is occupied.
+
+                const int cx = 2 * (vampire.x - m_playerX);
+                const int cy = 2 * (vampire.y - m_playerY);
+                const int dd = ((d.x != 0)
+                    ? ((d.x == 1) ? (1 + cx) : (1 - cx))
+                    : 0)
+                    +
+                    ((d.y != 0)
+                    ? ((d.y == 1) ? (1 + cy) : (1 - cy))
+                    : 0);
+                if (minDd > dd)
+                {
+                    minDd = dd;
+                    minDistance = d;
+                }
+            }
+            if (minDd == INT_MAX) //< There is no move for this Vampire: skip it.
+                continue;
+
+            const int newX = vampire.x + minDistance.x;
+            const int newY = vampire.y + minDistance.y;
+            m_changedCells.push_back({vampire.x, vampire.y});
+            m_changedCells.push_back({newX, newY});
+            cell(newX, newY) = cell(vampire.x, vampire.y);
+            cell(vampire.x, vampire.y) = kEmpty;
+            vampire.x = newX;
+            vampire.y = newY;
+            hasSomeVampiresMoved = true;
+        }
+        return hasSomeVampiresMoved
+            ? Vampires::VampireResult::ok
+            : Vampires::VampireResult::win;
+    }
+
+    const std::vector<Vampires::Cell>& changedCells() const { return m_changedCells; }
+
+    /** @return The field in the format of fieldSnapshot(). */
+    std::string fieldSnapshot() const
+    {
+        std::string result;
+        result.reserve(m_cells.size());
+        for (const int8_t kind: m_cells)
+        {
+            result.push_back((kind == kEmpty || kind == (int8_t) Vampires::Item::Kind::border)
+                ? '.'
+                : (char) ('0' + kind));
+        }
+        return result;
+    }
+
+private:
+    int8_t& cell(int x, int y) { return m_cells[(size_t) y * m_width + x]; }
+
+private:
+    static constexpr int8_t kEmpty = -1;
+
+    /** In the order of Vampires::Direction. */
+    static constexpr Vampires::Cell kDirections[] = {
+        {0, -1}, {1, -1}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}};
+
+    struct Vampire
+    {
+        int x = -1;
+        int y = -1;
+        int d = -1;
+    };
+
+    const int m_width;
+    const int m_height;
+    std::vector<int8_t> m_cells; /**< Item kind of each cell, row by row, or kEmpty. */
+    std::vector<Vampire> m_vampires;
+    int m_playerX = -1;
+    int m_playerY = -1;
+    std::vector<Vampires::Cell> m_changedCells;
+};
+
+struct PlayedGame
+{
+    int tickCount = 0;
+    int64_t parallelMoveCount = 0;
+};
+
+/**
+ * Plays the same single-player game with the parallel vampire movement and with the reference
+ * one, and checks that after each tick the outcome, the changed cells, and the order of the
+ * changes are identical.
+ */
+static PlayedGame testParallelMovementMatchesReference(
+    int width, int height, int vampireCount, int wallCount, int tickCount, int seed)
+{
+    srand(seed);
+    Vampires parallel(width, height, vampireCount, wallCount);
+    parallel.setParallelism(/*threadCount*/ 8, /*minVampiresPerThread*/ 1);
+    ReferenceGame reference(parallel);
+    ASSERT_EQ(fieldSnapshot(parallel), reference.fieldSnapshot());
+
+    PlayedGame playedGame;
+    srand(seed + 1);
+    for (int tick = 0; tick < tickCount; ++tick)
+    {
+        parallel.clearChangedCells();
+        if (parallel.movePlayers(randomCommands(/*playerCount*/ 1))
+            == Vampires::PlayerResult::lost)
+        {
+            break;
+        }
+        reference.applyChangedCells(parallel);
+        parallel.clearChangedCells();
+
+        const auto result = parallel.moveVampires();
+        ASSERT_EQ((int) reference.moveVampires(), (int) result);
+        playedGame.parallelMoveCount += parallel.parallelMoveCount();
+        ++playedGame.tickCount;
+        if (result != Vampires::VampireResult::ok)
+            break;
+
+        ASSERT_EQ(changedCellsSnapshot(reference.changedCells()),
+            changedCellsSnapshot(parallel.changedCells()));
+    }
+    ASSERT_EQ(reference.fieldSnapshot(), fieldSnapshot(parallel));
+    return playedGame;
+}
+
+/**
+ * Plays the same multi-player game with the sequential and the parallel vampire movement, and
+ * checks that after each tick the outcome, the field, and the order of the changes are identical.
+ */
+static void testParallelMovementMatchesSequential(
+    int width, int height, int vampireCount, int wallCount, int tickCount, int seed,
+    int playerCount)
+{
+    srand(seed);
+    Vampires sequential(width, height, vampireCount, wallCount, playerCount);
+    srand(seed);
+    Vampires parallel(width, height, vampireCount, wallCount, playerCount);
+    parallel.setParallelism(/*threadCount*/ 8, /*minVampiresPerThread*/ 1);
+
+    ASSERT_EQ(fieldSnapshot(sequential), fieldSnapshot(parallel));
+
+    srand(seed + 1);
+    for (int tick = 0; tick < tickCount; ++tick)
+    {
+        sequential.clearChangedCells();
+        parallel.clearChangedCells();
+
+        const auto commands = randomCommands(playerCount);
+        const auto sequentialPlayerResult = sequential.movePlayers(commands);
+        ASSERT_EQ((int) sequentialPlayerResult, (int) parallel.movePlayers(commands));
+        if (sequentialPlayerResult == Vampires::PlayerResult::lost)
+            return;
+
+        const auto sequentialResult = sequential.moveVampires();
+        ASSERT_EQ((int) sequentialResult, (int) parallel.moveVampires());
+        ASSERT_EQ(changedCellsSnapshot(sequential.changedCells()),
+            changedCellsSnapshot(parallel.changedCells()));
+        ASSERT_EQ(fieldSnapshot(sequential), fieldSnapshot(parallel));
+        if (sequentialResult != Vampires::VampireResult::ok)
+            return;
+    }
+}
+
+TEST(Vampires, parallelMovementMatchesReferenceOnDenseField)
+{
+    for (int seed = 1; seed <= 5; ++seed)
+    {
+        testParallelMovementMatchesReference(/*width*/ 64, /*height*/ 64, /*vampireCount*/ 200,
+            /*wallCount*/ 1000, /*tickCount*/ 100, seed);
+    }
+}
+
+TEST(Vampires, parallelMovementMatchesReferenceWithIsolatedVampires)
+{
+    // The vampires start about 10 cells apart, and converge on the player from the far border
+    // slowly enough for most of them to stay isolated; the walls are too rare to crowd them.
+    constexpr int kVampireCount = 400;
+    constexpr int kTickCount = 100;
+    const PlayedGame playedGame = testParallelMovementMatchesReference(/*width*/ 1000,
+        /*height*/ 1000, kVampireCount, /*wallCount*/ 2000, kTickCount, /*seed*/ 42);
+
+    ASSERT_EQ(kTickCount, playedGame.tickCount);
+    ASSERT_TRUE(playedGame.parallelMoveCount >= (int64_t) kTickCount * kVampireCount * 4 / 5);
+}
+
+TEST(Vampires, parallelMovementMatchesSequentialWithSeveralPlayers)
+{
+    for (int seed = 1; seed <= 5; ++seed)
+    {
+        testParallelMovementMatchesSequential(/*width*/ 64, /*height*/ 64, /*vampireCount*/ 200,
+            /*wallCount*/ 1000, /*tickCount*/ 100, seed, /*playerCount*/ 5);
+    }
+}
+
+/** @return Sum of the squared distances from the vampires to the only player. */
+static int64_t sumOfVampireDistances2(const Vampires& vampires)
+{
+    const Vampires::Item& player = vampires.player();
+    int64_t result = 0;
+    vampires.forEachItem(
+        [&](const Vampires::Item& item)
+        {
+            if (item.kind != Vampires::Item::Kind::vampire)
+                return;
+            const int64_t dx = item.x() - player.x();
+            const int64_t dy = item.y() - player.y();
+            result += dx * dx + dy * dy;
+        });
+    return result;
+}
+
+TEST(Vampires, hugeField)
+{
+    // The squared distances across such a field do not fit into int.
+    srand(4);
+    Vampires vampires(/*width*/ 100'000, /*height*/ 100'000, /*vampireCount*/ 2000,
+        /*wallCount*/ 2000);
+
+    // The player stands still, so the vampires, being far from everything, come closer each tick.
+    int64_t distances2 = sumOfVampireDistances2(vampires);
+    for (int tick = 0; tick < 5; ++tick)
+    {
+        ASSERT_EQ((int) Vampires::VampireResult::ok, (int) vampires.moveVampires());
+        const int64_t newDistances2 = sumOfVampireDistances2(vampires);
+        ASSERT_TRUE(newDistances2 < distances2);
+        distances2 = newDistances2;
+    }
+}
+
+static int countPlayersOnField(const Vampires& vampires)
+{
+    int count = 0;
+    for (int y = 0; y < vampires.height; ++y)
+    {
+        for (int x = 0; x < vampires.width; ++x)
+        {
+            const auto item = vampires.itemAt(x, y);
+            if (item && item->kind == Vampires::Item::Kind::player)
+                ++count;
+        }
+    }
+    return count;
+}
+
+TEST(Vampires, caughtPlayersLeaveTheFieldUntilTheLastOne)
+{
+    constexpr int kPlayerCount = 4;
+
+    srand(3);
+    Vampires vampires(/*width*/ 24, /*height*/ 24, /*vampireCount*/ 60, /*wallCount*/ 20,
+        kPlayerCount);
+    ASSERT_EQ(kPlayerCount, countPlayersOnField(vampires));
+
+    // The players stand still, so the vampires catch them one by one.
+    bool isLost = false;
+    for (int tick = 0; tick < 1000 && !isLost; ++tick)
+    {
+        isLost = vampires.moveVampires() == Vampires::VampireResult::lost;
+        ASSERT_TRUE(vampires.remainingPlayerCount() >= 1);
+        ASSERT_EQ(vampires.remainingPlayerCount(), countPlayersOnField(vampires));
+
+        int remaining = 0;
+        for (int player = 0; player < kPlayerCount; ++player)
+            remaining += vampires.player(player) ? 1 : 0;
+        ASSERT_EQ(vampires.remainingPlayerCount(), remaining);
+    }
+    ASSERT_TRUE(isLost);
+    ASSERT_EQ(1, vampires.remainingPlayerCount()); //< The last player stays on the field.
+
+    // The moves of the caught players are ignored.
+    for (int player = 0; player < kPlayerCount; ++player)
+    {
+        if (!vampires.player(player))
+        {
+            ASSERT_EQ((int) Vampires::PlayerResult::ok,
+                (int) vampires.movePlayer(player, Vampires::Direction::up));
+        }
+    }
+}
+
+TEST(Vampires, commandsDoNotDependOnPollingOrder)
+{
+    constexpr int kPlayerCount = 3;
+
+    srand(5);
+    Vampires first(/*width*/ 30, /*height*/ 30, /*vampireCount*/ 20, /*wallCount*/ 200,
+        kPlayerCount);
+    srand(5);
+    Vampires second(/*width*/ 30, /*height*/ 30, /*vampireCount*/ 20, /*wallCount*/ 200,
+        kPlayerCount);
+
+    srand(6);
+    for (int tick = 0; tick < 50; ++tick)
+    {
+        auto commands = randomCommands(kPlayerCount);
+        first.movePlayers(commands);
+        std::reverse(commands.begin(), commands.end());
+        second.movePlayers(commands);
+        ASSERT_EQ(fieldSnapshot(first), fieldSnapshot(second));
+
+        first.moveVampires();
+        second.moveVampires();
+    }
+}
+
+} // namespace ms::vampires_nx_vms_plugin::test
@@ -0,0 +1,49 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <nx/kit/test.h>
+
+#include <ms/vampires_nx_vms_plugin/worker_pool.h>
+
+namespace ms::vampires_nx_vms_plugin::test {
+
+TEST(WorkerPool, eachTaskRunsOnceOnItsOwnThread)
+{
+    constexpr int kThreadCount = 4;
+    WorkerPool pool(kThreadCount);
+    ASSERT_EQ(kThreadCount, pool.threadCount());
+
+    // Many runs in a row, with a varying number of tasks, so that the workers not needed by one
+    // run are woken by the next one.
+    for (int run = 0; run < 1000; ++run)
+    {
+        const int taskCount = 1 + run % kThreadCount;
+        std::vector<std::atomic<int>> callCounts(kThreadCount);
+        std::vector<std::thread::id> threadIds(kThreadCount);
+        pool.run(taskCount,
+            [&](int threadIndex)
+            {
+                ++callCounts[threadIndex];
+                threadIds[threadIndex] = std::this_thread::get_id();
+            });
+
+        for (int i = 0; i < kThreadCount; ++i)
+            ASSERT_EQ(i < taskCount ? 1 : 0, callCounts[i].load());
+        ASSERT_TRUE(threadIds[0] == std::this_thread::get_id());
+        for (int i = 1; i < taskCount; ++i)
+            ASSERT_TRUE(threadIds[i] != std::this_thread::get_id());
+    }
+}
+
+TEST(WorkerPool, singleThread)
+{
+    WorkerPool pool(/*threadCount*/ 1);
+    int callCount = 0;
+    pool.run(/*taskCount*/ 1, [&](int threadIndex) { callCount += 1 + threadIndex; });
+    ASSERT_EQ(1, callCount);
+}
+
+} // namespace ms::vampires_nx_vms_plugin::test
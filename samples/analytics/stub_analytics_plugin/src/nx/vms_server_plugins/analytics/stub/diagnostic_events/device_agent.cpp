@@ -1,3 +1,4 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #include "device_agent.h"
@@ -7,7 +8,6 @@
 #include <mutex>
 #include <chrono>
 #include <ctime>
-#include <thread>
 #include <type_traits>
 
 #include <nx/kit/utils.h>
@@ -39,15 +39,15 @@ using namespace nx::sdk;
 using namespace nx::sdk::analytics;
 
 DeviceAgent::DeviceAgent(Engine* engine, const nx::sdk::IDeviceInfo* deviceInfo):
-    ConsumingDeviceAgent(deviceInfo, NX_DEBUG_ENABLE_OUTPUT, engine->integration()->instanceId()),
+    ProducingDeviceAgent(deviceInfo, NX_DEBUG_ENABLE_OUTPUT, engine->integration()->instanceId()),
     m_engine(engine)
 {
-    startEventThread();
+    startProducing();
 }
 
 DeviceAgent::~DeviceAgent()
 {
-    stopEventThread();
+    stopProducing();
 }
 
 std::string DeviceAgent::manifestString() const
@@ -75,14 +75,20 @@ Result<const ISettingsResponse*> DeviceAgent::settingsReceived()
             << "(): Integration Diagnostic Event generation disabled via settings.";
     }
 
-    m_eventThreadCondition.notify_all();
+    wakeProducer(); //< Not to wait for the rest of the event generation period.
 
     return nullptr;
 }
 
-void DeviceAgent::eventThreadLoop()
+/**
+ * Runs on the thread shared by the DeviceAgents of all Devices, so it must not block: it sleeps
+ * via co_await instead. Nothing is yielded, because the events are not metadata packets.
+ */
+ProducerTask DeviceAgent::produce()
 {
-    while (!m_terminated)
+    static const std::chrono::seconds kEventGenerationPeriod{5};
+
+    for (;;)
     {
         if (m_deviceAgentSettings.generateEvents)
         {
@@ -102,33 +108,8 @@ void DeviceAgent::eventThreadLoop()
                 "Error message description");
         }
 
-        // Sleep until the next event needs to be generated, or the thread is ordered to
-        // terminate (hence condition variable instead of sleep()). Return value (whether
-        // the timeout has occurred) and spurious wake-ups are ignored.
-        std::unique_lock<std::mutex> lock(m_eventThreadMutex);
-        if (m_terminated)
-            break;
-        {
-            static const std::chrono::seconds kEventGenerationPeriod{5};
-            m_eventThreadCondition.wait_for(lock, kEventGenerationPeriod);
-        }
-    }
-}
-
-void DeviceAgent::startEventThread()
-{
-    m_eventThread = std::make_unique<std::thread>([this]() { eventThreadLoop(); });
-}
-
-void DeviceAgent::stopEventThread()
-{
-    {
-        std::unique_lock<std::mutex> lock(m_eventThreadMutex);
-        m_terminated = true;
-        m_eventThreadCondition.notify_all();
+        co_await sleepFor(kEventGenerationPeriod);
     }
-
-    m_eventThread->join();
 }
 
 } // namespace diagnostic_events
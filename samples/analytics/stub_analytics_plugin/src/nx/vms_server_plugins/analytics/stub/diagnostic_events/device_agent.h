@@ -1,16 +1,14 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #pragma once
 
 #include <atomic>
-#include <condition_variable>
 #include <deque>
-#include <memory>
 #include <string>
-#include <thread>
 #include <vector>
 
-#include <nx/sdk/analytics/helpers/consuming_device_agent.h>
+#include <nx/sdk/analytics/helpers/producing_device_agent.h>
 #include <nx/sdk/analytics/helpers/object_metadata_packet.h>
 #include <nx/sdk/analytics/helpers/pixel_format.h>
 
@@ -26,7 +24,7 @@ namespace diagnostic_events {
 const std::string kGenerateIntegrationDiagnosticEventsFromDeviceAgentSetting =
     "generateIntegrationDiagnosticEventsFromDeviceAgent";
 
-class DeviceAgent: public nx::sdk::analytics::ConsumingDeviceAgent
+class DeviceAgent: public nx::sdk::analytics::ProducingDeviceAgent
 {
 public:
     DeviceAgent(Engine* engine, const nx::sdk::IDeviceInfo* deviceInfo);
@@ -37,22 +35,15 @@ protected:
 
     virtual nx::sdk::Result<const nx::sdk::ISettingsResponse*> settingsReceived() override;
 
-private:
-    void eventThreadLoop();
-    void startEventThread();
-    void stopEventThread();
+    virtual nx::sdk::analytics::ProducerTask produce() override;
 
+private:
     void processFrameMotion(
         nx::sdk::Ptr<nx::sdk::IList<nx::sdk::analytics::IMetadataPacket>> metadataPacketList);
 
 private:
     Engine* const m_engine;
 
-    std::unique_ptr<std::thread> m_eventThread;
-    std::mutex m_eventThreadMutex;
-    std::condition_variable m_eventThreadCondition;
-    std::atomic<bool> m_terminated{false};
-
     struct DeviceAgentSettings
     {
         std::atomic<bool> generateEvents{true};
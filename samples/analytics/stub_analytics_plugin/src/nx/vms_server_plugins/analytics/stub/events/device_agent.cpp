@@ -1,3 +1,4 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #include "device_agent.h"
@@ -7,7 +8,6 @@
 #include <mutex>
 #include <chrono>
 #include <ctime>
-#include <thread>
 #include <type_traits>
 
 #include <nx/kit/utils.h>
@@ -141,15 +141,15 @@ static const std::vector<EventDescriptor> kEventsToFire = {
 } // namespace
 
 DeviceAgent::DeviceAgent(Engine* engine, const nx::sdk::IDeviceInfo* deviceInfo):
-    ConsumingDeviceAgent(deviceInfo, NX_DEBUG_ENABLE_OUTPUT, engine->integration()->instanceId()),
+    ProducingDeviceAgent(deviceInfo, NX_DEBUG_ENABLE_OUTPUT, engine->integration()->instanceId()),
     m_engine(engine)
 {
-    startEventThread();
+    startProducing();
 }
 
 DeviceAgent::~DeviceAgent()
 {
-    stopEventThread();
+    stopProducing();
 }
 
 /**
@@ -228,6 +228,8 @@ Result<const ISettingsResponse*> DeviceAgent::settingsReceived()
     // The manifest depends on declareAdditionalEventTypes setting, so sending the new manifest.
     pushManifest(manifestString());
 
+    wakeProducer(); //< Not to wait for the rest of the event generation period.
+
     return nullptr;
 }
 
@@ -242,58 +244,39 @@ void DeviceAgent::doSetNeededMetadataTypes(
 
 void DeviceAgent::startFetchingMetadata(const IMetadataTypes* /*metadataTypes*/)
 {
-    std::unique_lock<std::mutex> lock(m_eventThreadMutex);
+    std::unique_lock<std::mutex> lock(m_mutex);
     NX_OUTPUT << __func__ << "() BEGIN";
     NX_PRINT << __func__ << "(): Starting Event generation.";
     m_needToGenerateEvents = true;
-    m_eventThreadCondition.notify_all();
     m_eventTypeId = kLineCrossingEventType; //< First event to produce.
+    wakeProducer();
     NX_OUTPUT << __func__ << "() END -> noError";
 }
 
 void DeviceAgent::stopFetchingMetadata()
 {
-    std::unique_lock<std::mutex> lock(m_eventThreadMutex);
+    std::unique_lock<std::mutex> lock(m_mutex);
     NX_OUTPUT << __func__ << "() BEGIN";
     NX_PRINT << __func__ << "(): Stopping Event generation.";
     m_needToGenerateEvents = false;
     NX_OUTPUT << __func__ << "() END -> noError";
 }
 
-void DeviceAgent::eventThreadLoop()
+/**
+ * Runs on the thread shared by the DeviceAgents of all Devices, so it must not block: it yields
+ * the events and sleeps via co_await instead.
+ */
+ProducerTask DeviceAgent::produce()
 {
-    while (!m_terminated)
+    static const milliseconds kEventGenerationPeriod{500};
+
+    for (;;)
     {
         if (m_deviceAgentSettings.generateEvents && m_needToGenerateEvents)
-            pushMetadataPacket(cookSomeEvents());
-
-        // Sleep until the next event needs to be generated, or the thread is ordered
-        // to terminate (hence condition variable instead of sleep()). Return value
-        // (whether the timeout has occurred) and spurious wake-ups are ignored.
-        {
-            std::unique_lock<std::mutex> lock(m_eventThreadMutex);
-            if (m_terminated)
-                break;
-            static const milliseconds kEventGenerationPeriod{500};
-            m_eventThreadCondition.wait_for(lock, kEventGenerationPeriod);
-        }
-    }
-}
-
-void DeviceAgent::startEventThread()
-{
-    m_eventThread = std::make_unique<std::thread>([this]() { eventThreadLoop(); });
-}
+            co_yield cookSomeEvents();
 
-void DeviceAgent::stopEventThread()
-{
-    {
-        std::unique_lock<std::mutex> lock(m_eventThreadMutex);
-        m_terminated = true;
-        m_eventThreadCondition.notify_all();
+        co_await sleepFor(kEventGenerationPeriod);
     }
-
-    m_eventThread->join();
 }
 
 //-------------------------------------------------------------------------------------------------
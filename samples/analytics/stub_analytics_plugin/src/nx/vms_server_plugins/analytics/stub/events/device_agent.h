@@ -1,16 +1,15 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #pragma once
 
 #include <atomic>
-#include <condition_variable>
-#include <memory>
+#include <mutex>
 #include <string>
-#include <thread>
 #include <vector>
 
 #include <nx/sdk/analytics/i_event_metadata.h>
-#include <nx/sdk/analytics/helpers/consuming_device_agent.h>
+#include <nx/sdk/analytics/helpers/producing_device_agent.h>
 
 #include "engine.h"
 #include "stub_analytics_plugin_events_ini.h"
@@ -24,7 +23,7 @@ namespace events {
 const std::string kDeclareAdditionalEventTypesSetting = "declareAdditionalEventTypesSetting";
 const std::string kGenerateEventsSetting = "generateEvents";
 
-class DeviceAgent: public nx::sdk::analytics::ConsumingDeviceAgent
+class DeviceAgent: public nx::sdk::analytics::ProducingDeviceAgent
 {
 public:
     DeviceAgent(Engine* engine, const nx::sdk::IDeviceInfo* deviceInfo);
@@ -39,6 +38,8 @@ protected:
 
     virtual nx::sdk::Result<const nx::sdk::ISettingsResponse*> settingsReceived() override;
 
+    virtual nx::sdk::analytics::ProducerTask produce() override;
+
 private:
     nx::sdk::Ptr<nx::sdk::analytics::IMetadataPacket> cookSomeEvents();
     nx::sdk::Ptr<nx::sdk::analytics::IEventMetadata> createEventWithImage();
@@ -46,17 +47,11 @@ private:
     void startFetchingMetadata(const nx::sdk::analytics::IMetadataTypes* metadataTypes);
     void stopFetchingMetadata();
     void parseSettings();
-    void eventThreadLoop();
-    void startEventThread();
-    void stopEventThread();
 
 private:
     Engine* const m_engine;
 
-    std::unique_ptr<std::thread> m_eventThread;
-    std::mutex m_eventThreadMutex;
-    std::condition_variable m_eventThreadCondition;
-    std::atomic<bool> m_terminated{false};
+    std::mutex m_mutex;
     std::atomic<bool> m_needToGenerateEvents{false};
     std::string m_eventTypeId;
 
@@ -1,3 +1,4 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #include "device_agent.h"
@@ -7,6 +8,7 @@
 
 #include <nx/kit/utils.h>
 #include <nx/kit/json.h>
+#include <nx/sdk/analytics/helpers/motion_grid.h>
 #include <nx/sdk/analytics/helpers/object_metadata.h>
 #include <nx/sdk/analytics/helpers/object_metadata_packet.h>
 #include <nx/sdk/analytics/helpers/object_track_best_shot_packet.h>
@@ -134,26 +136,13 @@ bool DeviceAgent::pushCompressedVideoFrame(Ptr<const ICompressedVideoPacket> vid
 }
 
 bool DeviceAgent::hasMotionUnderObject(
-    int objectColumn, int objectRow, Ptr<IMotionMetadataPacket> motionMetadataPacket)
+    int objectColumn, int objectRow, const MotionGrid& motionGrid)
 {
-    for (int column = objectColumn * m_deviceAgentSettings.objectWidthInMotionCells;
-        column < std::min(
-            (objectColumn + 1) * m_deviceAgentSettings.objectWidthInMotionCells,
-            motionMetadataPacket->columnCount());
-        ++column)
-    {
-        for (int row = objectRow * m_deviceAgentSettings.objectHeightInMotionCells;
-            row < std::min(
-                (objectRow + 1) * m_deviceAgentSettings.objectHeightInMotionCells,
-                motionMetadataPacket->rowCount());
-            ++row)
-        {
-            if (motionMetadataPacket->isMotionAt(column, row))
-                return true;
-        }
-    }
+    const int objectWidth = m_deviceAgentSettings.objectWidthInMotionCells;
+    const int objectHeight = m_deviceAgentSettings.objectHeightInMotionCells;
 
-    return false;
+    return motionGrid.hasMotion(
+        objectColumn * objectWidth, objectRow * objectHeight, objectWidth, objectHeight);
 }
 
 void DeviceAgent::processFrameMotion(Ptr<IList<IMetadataPacket>> metadataPacketList)
@@ -180,6 +169,9 @@ void DeviceAgent::processFrameMotion(Ptr<IList<IMetadataPacket>> metadataPacketL
         if (!motionPacket)
             continue;
 
+        // Read the grid once rather than calling isMotionAt() for each cell of each object.
+        const MotionGrid motionGrid(motionPacket.get());
+
         auto objectMetadataPacket = makePtr<ObjectMetadataPacket>();
         objectMetadataPacket->setTimestampUs(motionPacket->timestampUs());
 
@@ -202,7 +194,7 @@ void DeviceAgent::processFrameMotion(Ptr<IList<IMetadataPacket>> metadataPacketL
         {
             for (int objectRow = 0; objectRow < objectRowCount; ++objectRow)
             {
-                if (!hasMotionUnderObject(objectColumn, objectRow, motionPacket))
+                if (!hasMotionUnderObject(objectColumn, objectRow, motionGrid))
                     continue;
 
                 const auto objectMetadata = makePtr<ObjectMetadata>();
@@ -1,3 +1,4 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #pragma once
@@ -6,6 +7,7 @@
 #include <chrono>
 
 #include <nx/sdk/analytics/helpers/consuming_device_agent.h>
+#include <nx/sdk/analytics/helpers/motion_grid.h>
 #include <nx/sdk/analytics/i_motion_metadata_packet.h>
 
 #include "engine.h"
@@ -46,7 +48,7 @@ private:
     bool hasMotionUnderObject(
         int objectColumn,
         int objectRow,
-        nx::sdk::Ptr<nx::sdk::analytics::IMotionMetadataPacket> motionMetadataPacket);
+        const nx::sdk::analytics::MotionGrid& motionGrid);
 
 private:
     Engine* const m_engine;
@@ -0,0 +1,250 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "columnar_object_metadata_packet.h"
+
+#include <nx/kit/debug.h>
+
+namespace nx::sdk::analytics {
+
+//-------------------------------------------------------------------------------------------------
+// ObjectView
+
+const char* ColumnarObjectMetadataPacket::ObjectView::typeId() const
+{
+    return m_packet->string(m_packet->m_typeIdOffsets[m_index]);
+}
+
+float ColumnarObjectMetadataPacket::ObjectView::confidence() const
+{
+    return m_packet->m_confidences[m_index];
+}
+
+const char* ColumnarObjectMetadataPacket::ObjectView::subtype() const
+{
+    return m_packet->string(m_packet->m_subtypeOffsets[m_index]);
+}
+
+int ColumnarObjectMetadataPacket::ObjectView::attributeCount() const
+{
+    return m_packet->attributeEnd(m_index) - m_packet->m_attributeBegins[m_index];
+}
+
+const IAttribute* ColumnarObjectMetadataPacket::ObjectView::getAttribute(int index) const
+{
+    if (index < 0 || index >= attributeCount())
+        return nullptr;
+
+    m_packet->addRef();
+    return &m_packet->m_attributeViews[m_packet->m_attributeBegins[m_index] + index];
+}
+
+void ColumnarObjectMetadataPacket::ObjectView::getTrackId(Uuid* outValue) const
+{
+    *outValue = m_packet->m_trackIds[m_index];
+}
+
+void ColumnarObjectMetadataPacket::ObjectView::getBoundingBox(Rect* outValue) const
+{
+    *outValue = m_packet->m_boundingBoxes[m_index];
+}
+
+//-------------------------------------------------------------------------------------------------
+// AttributeView
+
+IAttribute::Type ColumnarObjectMetadataPacket::AttributeView::type() const
+{
+    return m_packet->m_attributeTypes[m_index];
+}
+
+const char* ColumnarObjectMetadataPacket::AttributeView::name() const
+{
+    return m_packet->string(m_packet->m_attributeNameOffsets[m_index]);
+}
+
+const char* ColumnarObjectMetadataPacket::AttributeView::value() const
+{
+    return m_packet->string(m_packet->m_attributeValueOffsets[m_index]);
+}
+
+float ColumnarObjectMetadataPacket::AttributeView::confidence() const
+{
+    return m_packet->m_attributeConfidences[m_index];
+}
+
+//-------------------------------------------------------------------------------------------------
+// ColumnarObjectMetadataPacket
+
+ColumnarObjectMetadataPacket::ColumnarObjectMetadataPacket(RefCountPolicy refCountPolicy):
+    RefCountable(refCountPolicy)
+{
+}
+
+ColumnarObjectMetadataPacket::Flags ColumnarObjectMetadataPacket::flags() const
+{
+    return m_flags;
+}
+
+int64_t ColumnarObjectMetadataPacket::timestampUs() const
+{
+    return m_timestampUs;
+}
+
+int64_t ColumnarObjectMetadataPacket::durationUs() const
+{
+    return m_durationUs;
+}
+
+int ColumnarObjectMetadataPacket::count() const
+{
+    return (int) m_objectViews.size();
+}
+
+const IObjectMetadata* ColumnarObjectMetadataPacket::getAt(int index) const
+{
+    if (index < 0 || index >= (int) m_objectViews.size())
+        return nullptr;
+
+    addRef();
+    return &m_objectViews[index];
+}
+
+void ColumnarObjectMetadataPacket::setFlags(Flags flags)
+{
+    m_flags = flags;
+}
+
+void ColumnarObjectMetadataPacket::setTimestampUs(int64_t timestampUs)
+{
+    m_timestampUs = timestampUs;
+}
+
+void ColumnarObjectMetadataPacket::setDurationUs(int64_t durationUs)
+{
+    m_durationUs = durationUs;
+}
+
+void ColumnarObjectMetadataPacket::reserve(int objectCount, int attributeCount)
+{
+    m_typeIdOffsets.reserve(objectCount);
+    m_subtypeOffsets.reserve(objectCount);
+    m_trackIds.reserve(objectCount);
+    m_boundingBoxes.reserve(objectCount);
+    m_confidences.reserve(objectCount);
+    m_attributeBegins.reserve(objectCount);
+    m_objectViews.reserve(objectCount);
+
+    m_attributeTypes.reserve(attributeCount);
+    m_attributeNameOffsets.reserve(attributeCount);
+    m_attributeValueOffsets.reserve(attributeCount);
+    m_attributeConfidences.reserve(attributeCount);
+    m_attributeViews.reserve(attributeCount);
+}
+
+int ColumnarObjectMetadataPacket::appendString(std::string_view value)
+{
+    const int offset = (int) m_strings.size();
+    m_strings.append(value);
+    m_strings.push_back('\0');
+    return offset;
+}
+
+int ColumnarObjectMetadataPacket::internString(std::string_view value)
+{
+    for (const int offset: m_internedStringOffsets)
+    {
+        if (std::string_view(string(offset)) == value)
+            return offset;
+    }
+
+    const int offset = appendString(value);
+    m_internedStringOffsets.push_back(offset);
+    return offset;
+}
+
+int ColumnarObjectMetadataPacket::attributeEnd(int objectIndex) const
+{
+    return objectIndex + 1 < (int) m_attributeBegins.size()
+        ? m_attributeBegins[objectIndex + 1]
+        : (int) m_attributeTypes.size();
+}
+
+int ColumnarObjectMetadataPacket::addObject(
+    std::string_view typeId,
+    const Uuid& trackId,
+    const Rect& boundingBox,
+    float confidence,
+    std::string_view subtype)
+{
+    const int index = (int) m_objectViews.size();
+    m_typeIdOffsets.push_back(internString(typeId));
+    m_subtypeOffsets.push_back(internString(subtype));
+    m_trackIds.push_back(trackId);
+    m_boundingBoxes.push_back(boundingBox);
+    m_confidences.push_back(confidence);
+    m_attributeBegins.push_back((int) m_attributeTypes.size());
+    m_objectViews.emplace_back(this, index);
+    return index;
+}
+
+void ColumnarObjectMetadataPacket::addObjects(
+    std::string_view typeId,
+    std::span<const Uuid> trackIds,
+    std::span<const Rect> boundingBoxes,
+    float confidence)
+{
+    if (!NX_KIT_ASSERT(trackIds.size() == boundingBoxes.size()))
+        return;
+
+    const int firstIndex = (int) m_objectViews.size();
+    const int addedCount = (int) trackIds.size();
+    const int newCount = firstIndex + addedCount;
+
+    m_typeIdOffsets.resize(newCount, internString(typeId));
+    m_subtypeOffsets.resize(newCount, internString(""));
+    m_trackIds.insert(m_trackIds.end(), trackIds.begin(), trackIds.end());
+    m_boundingBoxes.insert(m_boundingBoxes.end(), boundingBoxes.begin(), boundingBoxes.end());
+    m_confidences.resize(newCount, confidence);
+    m_attributeBegins.resize(newCount, (int) m_attributeTypes.size());
+    m_objectViews.reserve(newCount);
+    for (int i = firstIndex; i < newCount; ++i)
+        m_objectViews.emplace_back(this, i);
+}
+
+void ColumnarObjectMetadataPacket::addAttribute(
+    IAttribute::Type type,
+    std::string_view name,
+    std::string_view value,
+    float confidence)
+{
+    if (!NX_KIT_ASSERT(!m_objectViews.empty(), "No object to add the attribute to."))
+        return;
+
+    const int index = (int) m_attributeTypes.size();
+    m_attributeTypes.push_back(type);
+    m_attributeNameOffsets.push_back(internString(name));
+    m_attributeValueOffsets.push_back(appendString(value));
+    m_attributeConfidences.push_back(confidence);
+    m_attributeViews.emplace_back(this, index);
+}
+
+void ColumnarObjectMetadataPacket::clear()
+{
+    m_strings.clear();
+    m_internedStringOffsets.clear();
+
+    m_typeIdOffsets.clear();
+    m_subtypeOffsets.clear();
+    m_trackIds.clear();
+    m_boundingBoxes.clear();
+    m_confidences.clear();
+    m_attributeBegins.clear();
+    m_objectViews.clear();
+
+    m_attributeTypes.clear();
+    m_attributeNameOffsets.clear();
+    m_attributeValueOffsets.clear();
+    m_attributeConfidences.clear();
+    m_attributeViews.clear();
+}
+
+} // namespace nx::sdk::analytics
@@ -0,0 +1,163 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nx/sdk/analytics/i_object_metadata_packet.h>
+#include <nx/sdk/helpers/ref_countable.h>
+#include <nx/sdk/uuid.h>
+
+namespace nx::sdk::analytics {
+
+/**
+ * Alternative to ObjectMetadataPacket which stores the objects column-wise, in a few flat arrays,
+ * instead of a ref-countable ObjectMetadata (and an Attribute per attribute) per object. Thus,
+ * building a packet of N objects takes a few bulk appends rather than N allocations, and at()
+ * returns a view into the arrays which shares the reference counter of the packet, so reading
+ * the objects allocates nothing and keeps the packet alive as long as any view is referenced.
+ *
+ * Type ids, subtypes and attribute names are interned, assuming there are few distinct ones.
+ *
+ * The packet must not be modified after any of its objects have been read, because appending may
+ * move the arrays which the views refer to.
+ */
+class ColumnarObjectMetadataPacket: public RefCountable<IObjectMetadataPacket>
+{
+public:
+    /** @param refCountPolicy Applies to the objects as well, because they share the counter. */
+    explicit ColumnarObjectMetadataPacket(RefCountPolicy refCountPolicy = RefCountPolicy::atomic);
+
+    virtual Flags flags() const override;
+    virtual int64_t timestampUs() const override;
+    virtual int64_t durationUs() const override;
+    virtual int count() const override;
+
+    void setFlags(Flags flags);
+    void setTimestampUs(int64_t timestampUs);
+    void setDurationUs(int64_t durationUs);
+
+    /** Preallocates the arrays, so that adding the given number of items does not reallocate. */
+    void reserve(int objectCount, int attributeCount = 0);
+
+    /** @return Index of the added object. */
+    int addObject(
+        std::string_view typeId,
+        const Uuid& trackId,
+        const Rect& boundingBox,
+        float confidence = 1.0F,
+        std::string_view subtype = {});
+
+    /** Adds objects of the same type and confidence, without attributes. */
+    void addObjects(
+        std::string_view typeId,
+        std::span<const Uuid> trackIds,
+        std::span<const Rect> boundingBoxes,
+        float confidence = 1.0F);
+
+    /** Adds an attribute to the last added object. */
+    void addAttribute(
+        IAttribute::Type type,
+        std::string_view name,
+        std::string_view value,
+        float confidence = 1.0F);
+
+    int attributeCount() const { return (int) m_attributeTypes.size(); }
+
+    /** Removes all objects, keeping the allocated memory, so that the packet can be rebuilt. */
+    void clear();
+
+protected:
+    virtual const IObjectMetadata* getAt(int index) const override;
+
+private:
+    /** Object at the given index; its reference counter is the one of the packet. */
+    class ObjectView: public IObjectMetadata
+    {
+    public:
+        ObjectView(const ColumnarObjectMetadataPacket* packet, int index):
+            m_packet(packet), m_index(index)
+        {
+        }
+
+        virtual int addRef() const override { return m_packet->addRef(); }
+        virtual int releaseRef() const override { return m_packet->releaseRef(); }
+
+        virtual const char* typeId() const override;
+        virtual float confidence() const override;
+        virtual const char* subtype() const override;
+        virtual int attributeCount() const override;
+
+    protected:
+        virtual const IAttribute* getAttribute(int index) const override;
+        virtual void getTrackId(Uuid* outValue) const override;
+        virtual void getBoundingBox(Rect* outValue) const override;
+
+    private:
+        const ColumnarObjectMetadataPacket* const m_packet;
+        const int m_index;
+    };
+
+    /** Attribute at the given index; its reference counter is the one of the packet. */
+    class AttributeView: public IAttribute
+    {
+    public:
+        AttributeView(const ColumnarObjectMetadataPacket* packet, int index):
+            m_packet(packet), m_index(index)
+        {
+        }
+
+        virtual int addRef() const override { return m_packet->addRef(); }
+        virtual int releaseRef() const override { return m_packet->releaseRef(); }
+
+        virtual Type type() const override;
+        virtual const char* name() const override;
+        virtual const char* value() const override;
+        virtual float confidence() const override;
+
+    private:
+        const ColumnarObjectMetadataPacket* const m_packet;
+        const int m_index;
+    };
+
+    /** @return Offset of the zero-terminated copy of the string in m_strings. */
+    int appendString(std::string_view value);
+
+    /** @return Offset of the string in m_strings, appending it if it was not interned yet. */
+    int internString(std::string_view value);
+
+    const char* string(int offset) const { return m_strings.data() + offset; }
+
+    /** @return End of the attribute range of the object: the beginning of the next one. */
+    int attributeEnd(int objectIndex) const;
+
+private:
+    Flags m_flags = Flags::none;
+    int64_t m_timestampUs = -1;
+    int64_t m_durationUs = -1;
+
+    std::string m_strings; //< Zero-terminated strings referred to by the offsets below.
+    std::vector<int> m_internedStringOffsets;
+
+    // Object columns.
+    std::vector<int> m_typeIdOffsets;
+    std::vector<int> m_subtypeOffsets;
+    std::vector<Uuid> m_trackIds;
+    std::vector<Rect> m_boundingBoxes;
+    std::vector<float> m_confidences;
+    std::vector<int> m_attributeBegins; //< Index of the first attribute of the object.
+    std::vector<ObjectView> m_objectViews;
+
+    // Attribute columns, the attributes of each object being adjacent.
+    std::vector<IAttribute::Type> m_attributeTypes;
+    std::vector<int> m_attributeNameOffsets;
+    std::vector<int> m_attributeValueOffsets;
+    std::vector<float> m_attributeConfidences;
+    std::vector<AttributeView> m_attributeViews;
+};
+
+} // namespace nx::sdk::analytics
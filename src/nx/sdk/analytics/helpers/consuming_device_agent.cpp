@@ -1,13 +1,17 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #include "consuming_device_agent.h"
 
+#include <utility>
+
 #include <nx/sdk/helpers/log_utils.h>
 #include <nx/sdk/ptr.h>
 #include <nx/sdk/helpers/string.h>
 #include <nx/sdk/helpers/to_string.h>
 #include <nx/sdk/helpers/error.h>
 #include <nx/sdk/helpers/integration_diagnostic_event.h>
+#include <nx/sdk/helpers/span_recorder.h>
 #include <nx/sdk/analytics/helpers/engine.h>
 
 #include <nx/sdk/analytics/i_event_metadata_packet.h>
@@ -45,6 +49,8 @@ ConsumingDeviceAgent::ConsumingDeviceAgent(
 
 ConsumingDeviceAgent::~ConsumingDeviceAgent()
 {
+    // Normally, the derived class has already disabled the pipeline.
+    disablePipeline();
     NX_PRINT << "Destroyed " << this;
 }
 
@@ -53,8 +59,17 @@ ConsumingDeviceAgent::~ConsumingDeviceAgent()
 
 void ConsumingDeviceAgent::setHandler(IDeviceAgent::IHandler* handler)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_handler = shareToPtr(handler);
+    {
+        const std::lock_guard<std::mutex> lock(m_handlersMutex);
+        Ptr<IDeviceAgent::IHandler> previousHandler =
+            std::exchange(m_currentHandler, shareToPtr(handler));
+        m_handler.store(handler);
+        if (!previousHandler)
+            return;
+        m_retiredHandlers.push_back(std::move(previousHandler));
+        m_hasRetiredHandlers = true;
+    }
+    releaseRetiredHandlers();
 }
 
 void ConsumingDeviceAgent::doPushDataPacket(
@@ -69,6 +84,8 @@ void ConsumingDeviceAgent::doPushDataPacket(
             return;
         };
 
+    const Span span("ConsumingDeviceAgent::doPushDataPacket");
+
     NX_OUTPUT << __func__ << "() BEGIN";
 
     if (!dataPacket)
@@ -80,36 +97,72 @@ void ConsumingDeviceAgent::doPushDataPacket(
             + nx::kit::utils::toString(dataPacket->timestampUs()) + "; discarding the packet.");
     }
 
-    if (const auto compressedFrame = dataPacket->queryInterface<ICompressedVideoPacket>())
+    if (const auto currentPipeline = pipeline())
     {
-        if (!pushCompressedVideoFrame(compressedFrame))
-            return logError(ErrorCode::otherError, "pushCompressedVideoFrame() failed.");
-    }
-    else if (const auto uncompressedFrame = dataPacket->queryInterface<IUncompressedVideoFrame>())
-    {
-        if (!pushUncompressedVideoFrame(uncompressedFrame))
-            return logError(ErrorCode::otherError, "pushUncompressedVideoFrame() failed.");
-    }
-    else if (const auto customMetadataPacket = dataPacket->queryInterface<ICustomMetadataPacket>())
-    {
-        if (!pushCustomMetadataPacket(customMetadataPacket))
-            return logError(ErrorCode::otherError, "pushCustomMetadataPacket() failed.");
+        currentPipeline->push(shareToPtr(dataPacket));
+        NX_OUTPUT << __func__ << "() END: Queued the packet.";
+        return;
     }
-    else
+
+    processDataPacket(outResult, dataPacket);
+
+    NX_OUTPUT << __func__ << "() END";
+}
+
+void ConsumingDeviceAgent::processDataPacket(Result<void>* outResult, IDataPacket* dataPacket)
+{
+    const auto logError =
+        [this, outResult, func = __func__](ErrorCode errorCode, const std::string& message)
+        {
+            NX_PRINT << func << "() -> " << errorCode << ": " << message;
+            *outResult = error(errorCode, message);
+            return;
+        };
+
+    // The self time of the dispatch span is the time of querying the packet type.
     {
-        return logError(ErrorCode::invalidParams, "Unsupported frame supplied; ignored.");
+        const Span dispatchSpan("ConsumingDeviceAgent::dispatch");
+
+        if (const auto compressedFrame = dataPacket->queryInterface<ICompressedVideoPacket>())
+        {
+            const Span pushSpan("pushCompressedVideoFrame");
+            if (!pushCompressedVideoFrame(compressedFrame))
+                return logError(ErrorCode::otherError, "pushCompressedVideoFrame() failed.");
+        }
+        else if (const auto uncompressedFrame =
+            dataPacket->queryInterface<IUncompressedVideoFrame>())
+        {
+            const Span pushSpan("pushUncompressedVideoFrame");
+            if (!pushUncompressedVideoFrame(uncompressedFrame))
+                return logError(ErrorCode::otherError, "pushUncompressedVideoFrame() failed.");
+        }
+        else if (const auto customMetadataPacket =
+            dataPacket->queryInterface<ICustomMetadataPacket>())
+        {
+            const Span pushSpan("pushCustomMetadataPacket");
+            if (!pushCustomMetadataPacket(customMetadataPacket))
+                return logError(ErrorCode::otherError, "pushCustomMetadataPacket() failed.");
+        }
+        else
+        {
+            return logError(ErrorCode::invalidParams, "Unsupported frame supplied; ignored.");
+        }
     }
 
-    if (!m_handler)
+    if (!m_handler.load())
         return logError(ErrorCode::internalError, "setHandler() was not called.");
 
     std::vector<Ptr<IMetadataPacket>> metadataPackets;
-    if (!pullMetadataPackets(&metadataPackets))
-        return logError(ErrorCode::otherError, "pullMetadataPackets() failed.");
-
-    processMetadataPackets(metadataPackets);
+    {
+        const Span pullSpan("pullMetadataPackets");
+        if (!pullMetadataPackets(&metadataPackets))
+            return logError(ErrorCode::otherError, "pullMetadataPackets() failed.");
+    }
 
-    NX_OUTPUT << __func__ << "() END";
+    {
+        const Span processSpan("ConsumingDeviceAgent::processMetadataPackets");
+        processMetadataPackets(metadataPackets);
+    }
 }
 
 void ConsumingDeviceAgent::processMetadataPackets(
@@ -121,11 +174,9 @@ void ConsumingDeviceAgent::processMetadataPackets(
             << " metadata packet(s).";
     }
 
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        for (int i = 0; i < (int) metadataPackets.size(); ++i)
-            processMetadataPacket(metadataPackets.at(i), i);
-    }
+    const PinnedHandler currentHandler(this);
+    for (int i = 0; i < (int) metadataPackets.size(); ++i)
+        processMetadataPacket(currentHandler.get(), metadataPackets.at(i), i);
 }
 
 static std::string packetIndexName(int packetIndex)
@@ -134,9 +185,11 @@ static std::string packetIndexName(int packetIndex)
 }
 
 void ConsumingDeviceAgent::processMetadataPacket(
-    Ptr<IMetadataPacket> metadataPacket, int packetIndex /*= -1*/)
+    IDeviceAgent::IHandler* handler,
+    Ptr<IMetadataPacket> metadataPacket,
+    int packetIndex /*= -1*/)
 {
-    if (!m_handler)
+    if (!handler)
     {
         NX_PRINT << __func__ << "(): "
             << "INTERNAL ERROR: setHandler() was not called; ignoring the packet";
@@ -151,7 +204,14 @@ void ConsumingDeviceAgent::processMetadataPacket(
 
     logMetadataPacketIfNeeded(metadataPacket, packetIndex);
     NX_KIT_ASSERT(metadataPacket->timestampUs() >= 0);
-    m_handler->handleMetadata(metadataPacket.get());
+
+    // The Server may use the packet on any thread, so a thread-confined packet is published here.
+    if (const auto objectMetadataPacket =
+        dynamic_cast<const RefCountable<IObjectMetadataPacket>*>(metadataPacket.get()))
+    {
+        objectMetadataPacket->publish();
+    }
+    handler->handleMetadata(metadataPacket.get());
 }
 
 void ConsumingDeviceAgent::getManifest(Result<const IString*>* outResult) const
@@ -179,8 +239,8 @@ void ConsumingDeviceAgent::finalize()
 void ConsumingDeviceAgent::pushMetadataPacket(
     Ptr<IMetadataPacket> metadataPacket)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    processMetadataPacket(metadataPacket);
+    const PinnedHandler currentHandler(this);
+    processMetadataPacket(currentHandler.get(), metadataPacket);
 }
 
 void ConsumingDeviceAgent::pushIntegrationDiagnosticEvent(
@@ -188,8 +248,8 @@ void ConsumingDeviceAgent::pushIntegrationDiagnosticEvent(
     std::string caption,
     std::string description) const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    if (!m_handler)
+    const PinnedHandler currentHandler(this);
+    if (!currentHandler.get())
     {
         NX_PRINT << __func__ << "(): INTERNAL ERROR: "
             << "setHandler() was not called; ignoring Integration Diagnostic Event.";
@@ -201,7 +261,7 @@ void ConsumingDeviceAgent::pushIntegrationDiagnosticEvent(
 
     NX_OUTPUT << "Producing Integration Diagnostic Event:\n" + event->toString();
 
-    m_handler->handleIntegrationDiagnosticEvent(event.get());
+    currentHandler.get()->handleIntegrationDiagnosticEvent(event.get());
 }
 
 // TODO: Consider making a template with param type, checked according to the manifest.
@@ -221,10 +281,64 @@ std::map<std::string, std::string> ConsumingDeviceAgent::currentSettings() const
     return m_settings;
 }
 
+void ConsumingDeviceAgent::enablePipeline(DataPacketPipeline::Options options)
+{
+    disablePipeline();
+
+    auto newPipeline = std::make_shared<DataPacketPipeline>(options,
+        [this](Ptr<IDataPacket> dataPacket)
+        {
+            Result<void> result;
+            processDataPacket(&result, dataPacket.get());
+            if (!result.isOk())
+                Ptr(result.error().errorMessage()); //< releaseRef
+        });
+
+    const std::lock_guard<std::mutex> lock(m_pipelineMutex);
+    m_pipeline = std::move(newPipeline);
+}
+
+void ConsumingDeviceAgent::disablePipeline()
+{
+    std::shared_ptr<DataPacketPipeline> oldPipeline;
+    {
+        const std::lock_guard<std::mutex> lock(m_pipelineMutex);
+        oldPipeline = std::move(m_pipeline);
+    }
+    // The pipeline is destroyed here, stopping the workers, unless doPushDataPacket() is running
+    // concurrently, which the Server never does.
+}
+
+std::optional<DataPacketPipeline::Counters> ConsumingDeviceAgent::pipelineCounters() const
+{
+    if (const auto currentPipeline = pipeline())
+        return currentPipeline->counters();
+    return std::nullopt;
+}
+
+std::shared_ptr<DataPacketPipeline> ConsumingDeviceAgent::pipeline() const
+{
+    const std::lock_guard<std::mutex> lock(m_pipelineMutex);
+    return m_pipeline;
+}
+
 void ConsumingDeviceAgent::pushManifest(const std::string& manifest)
 {
     const auto manifestSdkString = nx::sdk::makePtr<nx::sdk::String>(manifest);
-    m_handler->pushManifest(manifestSdkString.get());
+    const PinnedHandler currentHandler(this);
+    currentHandler.get()->pushManifest(manifestSdkString.get());
+}
+
+void ConsumingDeviceAgent::releaseRetiredHandlers() const
+{
+    const std::lock_guard<std::mutex> lock(m_handlersMutex);
+
+    // The retired handlers have been replaced in m_handler before being retired, so a
+    // PinnedHandler created after the count is seen to be zero points to none of them.
+    if (m_pinnedHandlerCount.load() != 0)
+        return;
+    m_retiredHandlers.clear();
+    m_hasRetiredHandlers = false;
 }
 
 void ConsumingDeviceAgent::logMetadataPacketIfNeeded(
@@ -280,4 +394,21 @@ void ConsumingDeviceAgent::logMetadataPacketIfNeeded(
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+// PinnedHandler
+
+ConsumingDeviceAgent::PinnedHandler::PinnedHandler(const ConsumingDeviceAgent* deviceAgent):
+    m_deviceAgent(deviceAgent)
+{
+    // Counted before the pointer is loaded, to be seen by releaseRetiredHandlers().
+    ++m_deviceAgent->m_pinnedHandlerCount;
+    m_handler = m_deviceAgent->m_handler.load();
+}
+
+ConsumingDeviceAgent::PinnedHandler::~PinnedHandler()
+{
+    if (--m_deviceAgent->m_pinnedHandlerCount == 0 && m_deviceAgent->m_hasRetiredHandlers)
+        m_deviceAgent->releaseRetiredHandlers();
+}
+
 } // namespace nx::sdk::analytics
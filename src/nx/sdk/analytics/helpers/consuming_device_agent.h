@@ -1,12 +1,17 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #pragma once
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 
+#include <nx/sdk/analytics/helpers/data_packet_pipeline.h>
 #include <nx/sdk/analytics/i_compound_metadata_packet.h>
 #include <nx/sdk/analytics/i_compressed_video_packet.h>
 #include <nx/sdk/analytics/i_consuming_device_agent.h>
@@ -97,7 +102,9 @@ protected:
 
     /**
      * Sends a newly constructed metadata packet to Server. Can be called at any time, from any
-     * thread. As an alternative, send metadata to Server by implementing pullMetadataPackets().
+     * thread, concurrently with the other calls and with doPushDataPacket(): the Server handler
+     * is thread-safe, so no lock is held while it is called. As an alternative, send metadata to
+     * Server by implementing pullMetadataPackets().
      */
     void pushMetadataPacket(Ptr<IMetadataPacket> metadataPacket);
 
@@ -134,6 +141,27 @@ protected:
 
     std::map<std::string, std::string> currentSettings() const;
 
+    /**
+     * Switches to the pipeline mode, in which doPushDataPacket() only queues the packet, and the
+     * packet is passed to pushCompressedVideoFrame() etc., followed by pullMetadataPackets(), on
+     * a worker thread of the pipeline; thus, a slow processing does not stall the Server thread.
+     * The errors of these methods are logged instead of being returned to the Server. If already
+     * enabled, the pipeline is restarted with the new options, dropping the queued packets. Must
+     * not be called on a worker thread, i.e. from the methods the pipeline calls.
+     */
+    void enablePipeline(DataPacketPipeline::Options options);
+
+    /**
+     * Switches back to the synchronous mode, waiting for the packets being processed, and
+     * dropping the queued ones. Must be called in the destructor of the derived class if the
+     * pipeline is enabled, because the workers call its methods. Must not be called on a worker
+     * thread.
+     */
+    void disablePipeline();
+
+    /** @return Nothing if the pipeline mode is off. */
+    std::optional<DataPacketPipeline::Counters> pipelineCounters() const;
+
     void pushManifest(const std::string& pushManifest);
 
     virtual void finalize() override;
@@ -176,12 +204,57 @@ private:
         Ptr<const IMetadataPacket> metadataPacket,
         int packetIndex) const;
 
+    /** Passes the packet to the derived class and sends the metadata it has produced, if any. */
+    void processDataPacket(Result<void>* outResult, IDataPacket* dataPacket);
+
+    std::shared_ptr<DataPacketPipeline> pipeline() const;
+
     void processMetadataPackets(const std::vector<Ptr<IMetadataPacket>>& metadataPackets);
-    void processMetadataPacket(Ptr<IMetadataPacket> metadataPacket, int packetIndex = -1);
+    void processMetadataPacket(
+        IDeviceAgent::IHandler* handler,
+        Ptr<IMetadataPacket> metadataPacket,
+        int packetIndex = -1);
+
+    /**
+     * The current handler, which is not released while this object exists, even if setHandler()
+     * replaces it meanwhile.
+     */
+    class PinnedHandler
+    {
+    public:
+        explicit PinnedHandler(const ConsumingDeviceAgent* deviceAgent);
+        ~PinnedHandler();
+
+        PinnedHandler(const PinnedHandler&) = delete;
+        PinnedHandler& operator=(const PinnedHandler&) = delete;
+
+        IDeviceAgent::IHandler* get() const { return m_handler; }
+
+    private:
+        const ConsumingDeviceAgent* const m_deviceAgent;
+        IDeviceAgent::IHandler* m_handler = nullptr;
+    };
+
+    /** Releases the replaced handlers, unless some PinnedHandler may still point to them. */
+    void releaseRetiredHandlers() const;
 
 private:
-    mutable std::mutex m_mutex;
-    Ptr<IDeviceAgent::IHandler> m_handler;
+    /**
+     * The handler is read without locking: the pointer is published atomically, and a replaced
+     * handler is kept in m_retiredHandlers until no PinnedHandler exists, so a thread which has
+     * just loaded the pointer can still call the handler (the replacement normally never
+     * happens).
+     */
+    std::atomic<IDeviceAgent::IHandler*> m_handler{nullptr};
+    mutable std::atomic<int> m_pinnedHandlerCount{0};
+    mutable std::atomic<bool> m_hasRetiredHandlers{false};
+    mutable std::mutex m_handlersMutex; //< Guards m_currentHandler and m_retiredHandlers.
+    Ptr<IDeviceAgent::IHandler> m_currentHandler; //< Owns the handler of m_handler.
+    mutable std::vector<Ptr<IDeviceAgent::IHandler>> m_retiredHandlers;
+
+    mutable std::mutex m_pipelineMutex;
+    std::shared_ptr<DataPacketPipeline> m_pipeline;
+
     std::map<std::string, std::string> m_settings;
 };
 
@@ -0,0 +1,121 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "data_packet_pipeline.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <nx/kit/debug.h>
+
+namespace nx::sdk::analytics {
+
+DataPacketPipeline::DataPacketPipeline(Options options, Processor processor):
+    m_options(std::move(options)),
+    m_processor(std::move(processor))
+{
+    NX_KIT_ASSERT(m_options.queueCapacity > 0);
+    NX_KIT_ASSERT(m_options.workerCount > 0);
+
+    for (int i = 0; i < std::max(1, m_options.workerCount); ++i)
+        m_workers.emplace_back([this]() { run(); });
+}
+
+DataPacketPipeline::~DataPacketPipeline()
+{
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+        m_counters.droppedCount += (int64_t) m_queue.size();
+        m_queue.clear();
+        m_counters.queueDepth = 0;
+    }
+    m_packetPushedCondition.notify_all();
+    m_packetTakenCondition.notify_all();
+    m_idleCondition.notify_all();
+
+    for (auto& worker: m_workers)
+        worker.join();
+}
+
+void DataPacketPipeline::push(Ptr<IDataPacket> packet)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    ++m_counters.pushedCount;
+
+    if ((int) m_queue.size() >= std::max(1, m_options.queueCapacity))
+    {
+        switch (m_options.overflowPolicy)
+        {
+            case OverflowPolicy::dropOldest:
+                m_queue.pop_front();
+                ++m_counters.droppedCount;
+                break;
+
+            case OverflowPolicy::dropNewest:
+                ++m_counters.droppedCount;
+                return;
+
+            case OverflowPolicy::block:
+                m_packetTakenCondition.wait(lock,
+                    [this]()
+                    {
+                        return m_isStopping
+                            || (int) m_queue.size() < std::max(1, m_options.queueCapacity);
+                    });
+                if (m_isStopping)
+                {
+                    ++m_counters.droppedCount;
+                    return;
+                }
+                break;
+        }
+    }
+
+    m_queue.push_back(std::move(packet));
+    m_counters.queueDepth = (int) m_queue.size();
+    m_counters.peakQueueDepth = std::max(m_counters.peakQueueDepth, m_counters.queueDepth);
+    lock.unlock();
+
+    m_packetPushedCondition.notify_one();
+}
+
+DataPacketPipeline::Counters DataPacketPipeline::counters() const
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    return m_counters;
+}
+
+void DataPacketPipeline::waitUntilIdle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idleCondition.wait(lock,
+        [this]() { return m_isStopping || (m_queue.empty() && m_busyWorkerCount == 0); });
+}
+
+void DataPacketPipeline::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+        m_packetPushedCondition.wait(lock, [this]() { return m_isStopping || !m_queue.empty(); });
+        if (m_isStopping)
+            return;
+
+        Ptr<IDataPacket> packet = std::move(m_queue.front());
+        m_queue.pop_front();
+        m_counters.queueDepth = (int) m_queue.size();
+        ++m_busyWorkerCount;
+        lock.unlock();
+        m_packetTakenCondition.notify_one();
+
+        m_processor(std::move(packet));
+
+        lock.lock();
+        --m_busyWorkerCount;
+        ++m_counters.processedCount;
+        if (m_queue.empty() && m_busyWorkerCount == 0)
+            m_idleCondition.notify_all();
+    }
+}
+
+} // namespace nx::sdk::analytics
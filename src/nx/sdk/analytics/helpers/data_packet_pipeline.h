@@ -0,0 +1,90 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <nx/sdk/analytics/i_data_packet.h>
+#include <nx/sdk/ptr.h>
+
+namespace nx::sdk::analytics {
+
+/**
+ * Bounded queue of data packets processed by worker threads, so that the thread which pushes the
+ * packets (e.g. the Server thread ingesting video) is not stalled by a slow processing. Used by
+ * ConsumingDeviceAgent in the pipeline mode.
+ */
+class DataPacketPipeline
+{
+public:
+    /** What push() does when the queue is full. */
+    enum class OverflowPolicy
+    {
+        dropOldest, //< Discards the packet at the head of the queue, keeping the latest ones.
+        dropNewest, //< Discards the pushed packet.
+        block, //< Waits until a worker takes a packet from the queue.
+    };
+
+    struct Options
+    {
+        int queueCapacity = 8;
+
+        /** If greater than 1, the packets may be processed concurrently and out of order. */
+        int workerCount = 1;
+
+        OverflowPolicy overflowPolicy = OverflowPolicy::dropOldest;
+    };
+
+    struct Counters
+    {
+        int queueDepth = 0;
+        int peakQueueDepth = 0;
+        int64_t pushedCount = 0;
+        int64_t processedCount = 0;
+        int64_t droppedCount = 0;
+    };
+
+    using Processor = std::function<void(Ptr<IDataPacket> packet)>;
+
+    /** @param processor Called on the worker threads. */
+    DataPacketPipeline(Options options, Processor processor);
+
+    /** Stops the workers, waiting for the packets being processed; the queued ones are dropped. */
+    ~DataPacketPipeline();
+
+    DataPacketPipeline(const DataPacketPipeline&) = delete;
+    DataPacketPipeline& operator=(const DataPacketPipeline&) = delete;
+
+    void push(Ptr<IDataPacket> packet);
+
+    Counters counters() const;
+
+    /** Waits until the queue is empty and no packet is being processed. */
+    void waitUntilIdle();
+
+private:
+    void run();
+
+private:
+    const Options m_options;
+    const Processor m_processor;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_packetPushedCondition;
+    std::condition_variable m_packetTakenCondition;
+    std::condition_variable m_idleCondition;
+    std::deque<Ptr<IDataPacket>> m_queue;
+    int m_busyWorkerCount = 0;
+    Counters m_counters;
+    bool m_isStopping = false;
+
+    std::vector<std::thread> m_workers;
+};
+
+} // namespace nx::sdk::analytics
@@ -0,0 +1,149 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "motion_grid.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+#include <nx/kit/debug.h>
+
+namespace nx::sdk::analytics {
+
+/** Bytes with the reversed order of bits. */
+static constexpr std::array<uint8_t, 256> kReversedBytes =
+    []()
+    {
+        std::array<uint8_t, 256> result{};
+        for (int byte = 0; byte < 256; ++byte)
+        {
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                if (byte & (1 << bit))
+                    result[byte] |= (uint8_t) (0x80 >> bit);
+            }
+        }
+        return result;
+    }();
+
+/** For each byte, the number of its set bits [0, i], for each i. */
+static constexpr std::array<std::array<uint8_t, 8>, 256> kPrefixCounts =
+    []()
+    {
+        std::array<std::array<uint8_t, 8>, 256> result{};
+        for (int byte = 0; byte < 256; ++byte)
+        {
+            int count = 0;
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                count += (byte >> bit) & 1;
+                result[byte][bit] = (uint8_t) count;
+            }
+        }
+        return result;
+    }();
+
+/**
+ * @return Bits [bitIndex, bitIndex + bitCount) of the motion data, bitCount <= 32, the first one
+ *     being the least significant; the bits beyond the data are zero.
+ */
+static uint32_t readBits(const uint8_t* data, int dataSize, int bitIndex, int bitCount)
+{
+    // Big-endian window of 5 bytes in the most significant ones, enough for 32 bits at any offset.
+    uint64_t window = 0;
+    const int firstByte = bitIndex / 8;
+    const int byteCount = std::min(5, dataSize - firstByte);
+    for (int i = 0; i < byteCount; ++i)
+        window |= (uint64_t) data[firstByte + i] << (56 - 8 * i);
+    const uint32_t bits = (uint32_t) ((window << (bitIndex % 8)) >> 32);
+
+    // The first cell is the most significant bit of the data byte, thus reverse the bit order.
+    const uint32_t reversedBits = (uint32_t) kReversedBytes[bits >> 24]
+        | ((uint32_t) kReversedBytes[(bits >> 16) & 0xFF] << 8)
+        | ((uint32_t) kReversedBytes[(bits >> 8) & 0xFF] << 16)
+        | ((uint32_t) kReversedBytes[bits & 0xFF] << 24);
+    return bitCount == 32 ? reversedBits : reversedBits & ((uint32_t{1} << bitCount) - 1);
+}
+
+MotionGrid::MotionGrid(const IMotionMetadataPacket* packet)
+{
+    if (!NX_KIT_ASSERT(packet))
+        return;
+
+    *this = MotionGrid(
+        packet->motionData(), packet->motionDataSize(), packet->columnCount(), packet->rowCount());
+}
+
+MotionGrid::MotionGrid(const uint8_t* data, int dataSize, int columnCount, int rowCount)
+{
+    if (!NX_KIT_ASSERT(columnCount >= 0 && rowCount >= 0 && dataSize >= 0)
+        || !NX_KIT_ASSERT(data || dataSize == 0))
+    {
+        return;
+    }
+
+    m_columnCount = columnCount;
+    m_rowCount = rowCount;
+    m_wordsPerColumn = (rowCount + 63) / 64;
+    m_bitmap.assign((size_t) columnCount * m_wordsPerColumn, 0);
+
+    for (int column = 0; column < columnCount; ++column)
+    {
+        uint64_t* const words = m_bitmap.data() + column * m_wordsPerColumn;
+        for (int row = 0; row < rowCount; row += 32)
+        {
+            const uint64_t bits = readBits(
+                data, dataSize, rowCount * column + row, std::min(32, rowCount - row));
+            words[row / 64] |= bits << (row % 64);
+        }
+    }
+
+    m_sums.assign((size_t) (columnCount + 1) * (rowCount + 1), 0);
+    for (int column = 0; column < columnCount; ++column)
+    {
+        const int* const left = m_sums.data() + column * (rowCount + 1);
+        int* const sums = m_sums.data() + (column + 1) * (rowCount + 1);
+        const uint64_t* const words = m_bitmap.data() + column * m_wordsPerColumn;
+        int columnSum = 0;
+        for (int row = 0; row < rowCount; row += 8)
+        {
+            const auto& prefixCounts = kPrefixCounts[(words[row / 64] >> (row % 64)) & 0xFF];
+            const int count = std::min(8, rowCount - row);
+            for (int i = 0; i < count; ++i)
+                sums[row + i + 1] = left[row + i + 1] + columnSum + prefixCounts[i];
+            columnSum += prefixCounts[7]; //< The bits beyond the grid are zero.
+        }
+    }
+}
+
+int MotionGrid::motionCellCount() const
+{
+    return sum(m_columnCount, m_rowCount);
+}
+
+int MotionGrid::columnMotionCellCount(int column, int rowBegin, int rowEnd) const
+{
+    if (!NX_KIT_ASSERT(column >= 0 && column < m_columnCount))
+        return 0;
+
+    rowBegin = std::max(rowBegin, 0);
+    rowEnd = std::min(rowEnd, m_rowCount);
+    if (rowBegin >= rowEnd)
+        return 0;
+
+    const uint64_t* const words = m_bitmap.data() + column * m_wordsPerColumn;
+    int result = 0;
+    for (int wordIndex = rowBegin / 64; wordIndex <= (rowEnd - 1) / 64; ++wordIndex)
+    {
+        uint64_t word = words[wordIndex];
+        const int firstRow = wordIndex * 64;
+        if (rowBegin > firstRow)
+            word &= ~uint64_t{0} << (rowBegin - firstRow);
+        if (rowEnd < firstRow + 64)
+            word &= ~uint64_t{0} >> (firstRow + 64 - rowEnd);
+        result += std::popcount(word);
+    }
+    return result;
+}
+
+} // namespace nx::sdk::analytics
@@ -0,0 +1,100 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <nx/sdk/analytics/i_motion_metadata_packet.h>
+
+namespace nx::sdk::analytics {
+
+/**
+ * Snapshot of the motion grid of an IMotionMetadataPacket, for the plugins which check the grid
+ * cell-wise, e.g. under each object: the buffer of the packet is read once, instead of a virtual
+ * isMotionAt() call per cell, and any rectangle is checked in O(1) via the summed-area table.
+ *
+ * The cells are stored column by column, like in the packet, each column as rowCount() bits of
+ * wordsPerColumn() 64-bit words, the row r being the bit (r % 64) of the word (r / 64).
+ */
+class MotionGrid
+{
+public:
+    /** Empty grid of no cells. */
+    MotionGrid() = default;
+
+    explicit MotionGrid(const IMotionMetadataPacket* packet);
+
+    /**
+     * @param data Buffer in the format of IMotionMetadataPacket::motionData(): the cell (column,
+     *     row) is the bit (rowCount * column + row), the bits of each byte going from the most
+     *     significant one. If the buffer is shorter than the grid, the rest of the cells have no
+     *     motion.
+     */
+    MotionGrid(const uint8_t* data, int dataSize, int columnCount, int rowCount);
+
+    int columnCount() const { return m_columnCount; }
+    int rowCount() const { return m_rowCount; }
+    int wordsPerColumn() const { return m_wordsPerColumn; }
+
+    /** @return Words of the column, see the class description. */
+    std::span<const uint64_t> column(int column) const
+    {
+        return {m_bitmap.data() + column * m_wordsPerColumn, (size_t) m_wordsPerColumn};
+    }
+
+    bool isMotionAt(int column, int row) const
+    {
+        return (m_bitmap[column * m_wordsPerColumn + row / 64] >> (row % 64)) & 1;
+    }
+
+    bool isEmpty() const { return motionCellCount() == 0; }
+
+    int motionCellCount() const;
+
+    /**
+     * @return Number of the cells with motion in the rectangle, which is clipped to the grid.
+     *     Takes O(1).
+     */
+    int motionCellCount(int column, int row, int width, int height) const
+    {
+        // The 64-bit arithmetic makes huge rectangles be clipped rather than overflow.
+        const int columnBegin = std::clamp(column, 0, m_columnCount);
+        const int columnEnd = (int) std::clamp<int64_t>((int64_t) column + width, 0, m_columnCount);
+        const int rowBegin = std::clamp(row, 0, m_rowCount);
+        const int rowEnd = (int) std::clamp<int64_t>((int64_t) row + height, 0, m_rowCount);
+        if (columnBegin >= columnEnd || rowBegin >= rowEnd)
+            return 0;
+
+        return sum(columnEnd, rowEnd) - sum(columnBegin, rowEnd)
+            - sum(columnEnd, rowBegin) + sum(columnBegin, rowBegin);
+    }
+
+    bool hasMotion(int column, int row, int width, int height) const
+    {
+        return motionCellCount(column, row, width, height) > 0;
+    }
+
+    /**
+     * @return Number of the cells with motion in the rows [rowBegin, rowEnd) of the column, by
+     *     counting the bits of the bitmap rather than via the summed-area table.
+     */
+    int columnMotionCellCount(int column, int rowBegin, int rowEnd) const;
+
+private:
+    /** Summed-area table value: the number of the cells with motion above and left of the cell. */
+    int sum(int column, int row) const { return m_sums[column * (m_rowCount + 1) + row]; }
+
+private:
+    int m_columnCount = 0;
+    int m_rowCount = 0;
+    int m_wordsPerColumn = 0;
+    std::vector<uint64_t> m_bitmap;
+
+    /** (columnCount + 1) x (rowCount + 1), column by column, with the zero first row and column. */
+    std::vector<int> m_sums{0};
+};
+
+} // namespace nx::sdk::analytics
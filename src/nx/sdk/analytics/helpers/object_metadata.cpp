@@ -1,3 +1,4 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #include "object_metadata.h"
@@ -28,6 +29,13 @@ const char* ObjectMetadata::subtype() const
     return m_subtype.data();
 }
 
+void ObjectMetadata::publish() const
+{
+    RefCountable::publish();
+    for (const auto& attribute: m_attributes)
+        attribute->publish();
+}
+
 const IAttribute* ObjectMetadata::getAttribute(int index) const
 {
     if (index >= (int) m_attributes.size() || index < 0)
@@ -1,3 +1,4 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #pragma once
@@ -16,6 +17,11 @@ namespace nx::sdk::analytics {
 class ObjectMetadata: public RefCountable<IObjectMetadata>
 {
 public:
+    explicit ObjectMetadata(RefCountPolicy refCountPolicy = RefCountPolicy::atomic):
+        RefCountable(refCountPolicy)
+    {
+    }
+
     virtual const char* typeId() const override;
     virtual float confidence() const override;
     virtual const char* subtype() const override;
@@ -30,6 +36,9 @@ public:
     void addAttributes(std::vector<nx::sdk::Ptr<Attribute>>&& value);
     void setBoundingBox(const Rect& rect);
 
+    /** Publishes the object and its attributes; see RefCountPolicy::threadConfined. */
+    virtual void publish() const override;
+
 protected:
     virtual const IAttribute* getAttribute(int index) const override;
     virtual void getTrackId(Uuid* outValue) const override;
@@ -1,3 +1,4 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #include "object_metadata_packet.h"
@@ -21,6 +22,19 @@ int64_t ObjectMetadataPacket::durationUs() const
     return m_durationUs;
 }
 
+void ObjectMetadataPacket::publish() const
+{
+    RefCountable::publish();
+    for (const auto& object: m_objects)
+    {
+        if (const auto refCountable = dynamic_cast<const RefCountable<IObjectMetadata>*>(
+            object.get()))
+        {
+            refCountable->publish();
+        }
+    }
+}
+
 int ObjectMetadataPacket::count() const
 {
     return (int) m_objects.size();
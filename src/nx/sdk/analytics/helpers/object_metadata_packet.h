@@ -1,3 +1,4 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #pragma once
@@ -13,6 +14,15 @@ namespace nx::sdk::analytics {
 class ObjectMetadataPacket: public RefCountable<IObjectMetadataPacket>
 {
 public:
+    /**
+     * @param refCountPolicy If threadConfined, publish() must be called before the packet is sent,
+     *     which ConsumingDeviceAgent does.
+     */
+    explicit ObjectMetadataPacket(RefCountPolicy refCountPolicy = RefCountPolicy::atomic):
+        RefCountable(refCountPolicy)
+    {
+    }
+
     virtual Flags flags() const override;
     virtual int64_t timestampUs() const override;
     virtual int64_t durationUs() const override;
@@ -24,6 +34,12 @@ public:
     void addItem(Ptr<const IObjectMetadata> object);
     void clear();
 
+    /**
+     * Publishes the packet and its objects, unless they are not RefCountable; see
+     * RefCountPolicy::threadConfined.
+     */
+    virtual void publish() const override;
+
 protected:
     virtual const IObjectMetadata* getAt(int index) const override;
 
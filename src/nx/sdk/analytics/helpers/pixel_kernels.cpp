@@ -0,0 +1,340 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "pixel_kernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define NX_SDK_PIXEL_KERNELS_AVX2
+    #include <immintrin.h>
+#endif
+
+#include <nx/kit/debug.h>
+
+namespace nx::sdk::analytics {
+
+using PixelFormat = IUncompressedVideoFrame::PixelFormat;
+
+SimdLevel bestSimdLevel()
+{
+    #if defined(NX_SDK_PIXEL_KERNELS_AVX2)
+        static const SimdLevel simdLevel =
+            __builtin_cpu_supports("avx2") ? SimdLevel::avx2 : SimdLevel::scalar;
+        return simdLevel;
+    #else
+        return SimdLevel::scalar;
+    #endif
+}
+
+/** @return The requested level, or the best supported one if it is not supported. */
+static SimdLevel supportedSimdLevel(SimdLevel simdLevel)
+{
+    if (simdLevel == SimdLevel::scalar)
+        return SimdLevel::scalar;
+    return bestSimdLevel();
+}
+
+//-------------------------------------------------------------------------------------------------
+// Yuv420Image
+
+Yuv420Image Yuv420Image::fromFrame(const IUncompressedVideoFrame* frame)
+{
+    if (!NX_KIT_ASSERT(frame) || frame->pixelFormat() != PixelFormat::yuv420
+        || frame->planeCount() != 3)
+    {
+        return {};
+    }
+
+    Yuv420Image image;
+    ImagePlane* const planes[] = {&image.y, &image.u, &image.v};
+    for (int plane = 0; plane < 3; ++plane)
+    {
+        if (frame->lineSize(plane) <= 0 || !frame->data(plane))
+            return {};
+        *planes[plane] = {(const uint8_t*) frame->data(plane), frame->lineSize(plane)};
+    }
+    image.width = frame->width();
+    image.height = frame->height();
+    return image;
+}
+
+Yuv420Image Yuv420Image::cropped(int x, int y, int width, int height) const
+{
+    x &= ~1;
+    y &= ~1;
+    if (!NX_KIT_ASSERT(x >= 0 && y >= 0 && width >= 0 && height >= 0
+        && x + width <= this->width && y + height <= this->height))
+    {
+        return {};
+    }
+
+    Yuv420Image image;
+    image.y = this->y.cropped(x, y, /*bytesPerPixel*/ 1);
+    image.u = u.cropped(x / 2, y / 2, /*bytesPerPixel*/ 1);
+    image.v = v.cropped(x / 2, y / 2, /*bytesPerPixel*/ 1);
+    image.width = width;
+    image.height = height;
+    return image;
+}
+
+//-------------------------------------------------------------------------------------------------
+// yuv420 conversion
+
+void yuv420ToGray(const Yuv420Image& image, MutableImagePlane gray)
+{
+    for (int row = 0; row < image.height; ++row)
+    {
+        memcpy(gray.data + row * gray.lineSize, image.y.data + row * image.y.lineSize,
+            image.width);
+    }
+}
+
+static uint8_t clampToByte(int value)
+{
+    return (uint8_t) std::clamp(value, 0, 255);
+}
+
+static void yuv420RowToRgbScalar(
+    const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* rgb, int begin, int end)
+{
+    for (int x = begin; x < end; ++x)
+    {
+        const int c = 298 * (y[x] - 16) + 128; //< Including the rounding.
+        const int d = u[x / 2] - 128;
+        const int e = v[x / 2] - 128;
+        rgb[3 * x] = clampToByte((c + 409 * e) >> 8);
+        rgb[3 * x + 1] = clampToByte((c - 100 * d - 208 * e) >> 8);
+        rgb[3 * x + 2] = clampToByte((c + 516 * d) >> 8);
+    }
+}
+
+#if defined(NX_SDK_PIXEL_KERNELS_AVX2)
+
+/**
+ * Masks for _mm_shuffle_epi8() which interleave 16 bytes of each of r, g and b into 48 bytes of
+ * rgb: the mask of the output block k and the channel c is at index (3 * k + c); -128 (the high
+ * bit set) makes the byte zero.
+ */
+static constexpr std::array<std::array<int8_t, 16>, 9> kRgbInterleaveMasks =
+    []()
+    {
+        std::array<std::array<int8_t, 16>, 9> masks{};
+        for (int block = 0; block < 3; ++block)
+        {
+            for (int channel = 0; channel < 3; ++channel)
+            {
+                for (int i = 0; i < 16; ++i)
+                {
+                    const int outputIndex = 16 * block + i;
+                    masks[3 * block + channel][i] = (outputIndex % 3 == channel)
+                        ? (int8_t) (outputIndex / 3)
+                        : (int8_t) -128;
+                }
+            }
+        }
+        return masks;
+    }();
+
+/** Saturates two vectors of 8 int32 values to 16 bytes in the same order. */
+__attribute__((target("avx2")))
+static __m128i packToBytes(__m256i first, __m256i second)
+{
+    // The packing is done within the 128-bit lanes, thus the 64-bit quarters are reordered.
+    const __m256i packed =
+        _mm256_permute4x64_epi64(_mm256_packs_epi32(first, second), _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm_packus_epi16(
+        _mm256_castsi256_si128(packed), _mm256_extracti128_si256(packed, 1));
+}
+
+/**
+ * Converts 16 pixels per iteration, in 32-bit arithmetic, so that the result is the same as the
+ * one of yuv420RowToRgbScalar().
+ *
+ * @return Number of the converted pixels; the rest are left for the scalar code.
+ */
+__attribute__((target("avx2")))
+static int yuv420RowToRgbAvx2(
+    const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* rgb, int width)
+{
+    const __m256i k16 = _mm256_set1_epi32(16);
+    const __m256i k128 = _mm256_set1_epi32(128);
+    const __m256i k298 = _mm256_set1_epi32(298);
+    const __m256i k409 = _mm256_set1_epi32(409);
+    const __m256i k100 = _mm256_set1_epi32(100);
+    const __m256i k208 = _mm256_set1_epi32(208);
+    const __m256i k516 = _mm256_set1_epi32(516);
+
+    __m128i masks[9];
+    for (int i = 0; i < 9; ++i)
+        masks[i] = _mm_loadu_si128((const __m128i*) kRgbInterleaveMasks[i].data());
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        const __m128i y8 = _mm_loadu_si128((const __m128i*) (y + x));
+        const __m128i u8 = _mm_loadl_epi64((const __m128i*) (u + x / 2));
+        const __m128i v8 = _mm_loadl_epi64((const __m128i*) (v + x / 2));
+        const __m128i uu8 = _mm_unpacklo_epi8(u8, u8); //< Each chroma sample is for 2 pixels.
+        const __m128i vv8 = _mm_unpacklo_epi8(v8, v8);
+
+        __m256i r32[2];
+        __m256i g32[2];
+        __m256i b32[2];
+        for (int half = 0; half < 2; ++half)
+        {
+            const __m128i yHalf = half == 0 ? y8 : _mm_srli_si128(y8, 8);
+            const __m128i uHalf = half == 0 ? uu8 : _mm_srli_si128(uu8, 8);
+            const __m128i vHalf = half == 0 ? vv8 : _mm_srli_si128(vv8, 8);
+
+            const __m256i c = _mm256_add_epi32(
+                _mm256_mullo_epi32(_mm256_sub_epi32(_mm256_cvtepu8_epi32(yHalf), k16), k298),
+                k128);
+            const __m256i d = _mm256_sub_epi32(_mm256_cvtepu8_epi32(uHalf), k128);
+            const __m256i e = _mm256_sub_epi32(_mm256_cvtepu8_epi32(vHalf), k128);
+
+            r32[half] = _mm256_srai_epi32(
+                _mm256_add_epi32(c, _mm256_mullo_epi32(e, k409)), 8);
+            g32[half] = _mm256_srai_epi32(_mm256_sub_epi32(c, _mm256_add_epi32(
+                _mm256_mullo_epi32(d, k100), _mm256_mullo_epi32(e, k208))), 8);
+            b32[half] = _mm256_srai_epi32(
+                _mm256_add_epi32(c, _mm256_mullo_epi32(d, k516)), 8);
+        }
+
+        const __m128i r = packToBytes(r32[0], r32[1]);
+        const __m128i g = packToBytes(g32[0], g32[1]);
+        const __m128i b = packToBytes(b32[0], b32[1]);
+
+        for (int block = 0; block < 3; ++block)
+        {
+            const __m128i interleaved = _mm_or_si128(
+                _mm_or_si128(
+                    _mm_shuffle_epi8(r, masks[3 * block]),
+                    _mm_shuffle_epi8(g, masks[3 * block + 1])),
+                _mm_shuffle_epi8(b, masks[3 * block + 2]));
+            _mm_storeu_si128((__m128i*) (rgb + 3 * x + 16 * block), interleaved);
+        }
+    }
+    return x;
+}
+
+#endif // defined(NX_SDK_PIXEL_KERNELS_AVX2)
+
+void yuv420ToRgb(const Yuv420Image& image, MutableImagePlane rgb, SimdLevel simdLevel)
+{
+    simdLevel = supportedSimdLevel(simdLevel);
+
+    for (int row = 0; row < image.height; ++row)
+    {
+        const uint8_t* const y = image.y.data + row * image.y.lineSize;
+        const uint8_t* const u = image.u.data + (row / 2) * image.u.lineSize;
+        const uint8_t* const v = image.v.data + (row / 2) * image.v.lineSize;
+        uint8_t* const rgbRow = rgb.data + row * rgb.lineSize;
+
+        int convertedCount = 0;
+        #if defined(NX_SDK_PIXEL_KERNELS_AVX2)
+            if (simdLevel == SimdLevel::avx2)
+                convertedCount = yuv420RowToRgbAvx2(y, u, v, rgbRow, image.width);
+        #endif
+        yuv420RowToRgbScalar(y, u, v, rgbRow, convertedCount, image.width);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// Downscaling
+
+static void accumulateRowScalar(const uint8_t* row, uint16_t* sums, int begin, int end)
+{
+    for (int i = begin; i < end; ++i)
+        sums[i] += row[i];
+}
+
+#if defined(NX_SDK_PIXEL_KERNELS_AVX2)
+
+/** @return Number of the accumulated bytes; the rest are left for the scalar code. */
+__attribute__((target("avx2")))
+static int accumulateRowAvx2(const uint8_t* row, uint16_t* sums, int size)
+{
+    int i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        const __m256i bytes = _mm256_loadu_si256((const __m256i*) (row + i));
+        __m256i* const sums0 = (__m256i*) (sums + i);
+        __m256i* const sums1 = (__m256i*) (sums + i + 16);
+        _mm256_storeu_si256(sums0, _mm256_add_epi16(_mm256_loadu_si256(sums0),
+            _mm256_cvtepu8_epi16(_mm256_castsi256_si128(bytes))));
+        _mm256_storeu_si256(sums1, _mm256_add_epi16(_mm256_loadu_si256(sums1),
+            _mm256_cvtepu8_epi16(_mm256_extracti128_si256(bytes, 1))));
+    }
+    return i;
+}
+
+#endif // defined(NX_SDK_PIXEL_KERNELS_AVX2)
+
+void downscaleArea(
+    ImagePlane source,
+    int sourceWidth,
+    int sourceHeight,
+    int channelCount,
+    MutableImagePlane destination,
+    int destinationWidth,
+    int destinationHeight,
+    SimdLevel simdLevel)
+{
+    // The limit on the scale keeps the column sums of up to 256 rows within 16 bits.
+    if (!NX_KIT_ASSERT(destinationWidth > 0 && destinationHeight > 0
+        && destinationWidth <= sourceWidth && destinationHeight <= sourceHeight
+        && sourceWidth <= 256 * destinationWidth && sourceHeight <= 256 * destinationHeight
+        && channelCount > 0))
+    {
+        return;
+    }
+    // See the function description.
+    simdLevel = (channelCount == 1) ? supportedSimdLevel(simdLevel) : SimdLevel::scalar;
+
+    const int rowSize = sourceWidth * channelCount;
+    std::vector<uint16_t> columnSums(rowSize);
+
+    // Source column range of each destination column is [columnBegins[x], columnBegins[x + 1]).
+    std::vector<int> columnBegins(destinationWidth + 1);
+    for (int x = 0; x <= destinationWidth; ++x)
+        columnBegins[x] = (int) ((int64_t) x * sourceWidth / destinationWidth);
+
+    for (int y = 0; y < destinationHeight; ++y)
+    {
+        const int rowBegin = (int) ((int64_t) y * sourceHeight / destinationHeight);
+        const int rowEnd = (int) ((int64_t) (y + 1) * sourceHeight / destinationHeight);
+
+        std::fill(columnSums.begin(), columnSums.end(), 0);
+        for (int sourceY = rowBegin; sourceY < rowEnd; ++sourceY)
+        {
+            const uint8_t* const row = source.data + sourceY * source.lineSize;
+            int accumulatedCount = 0;
+            #if defined(NX_SDK_PIXEL_KERNELS_AVX2)
+                if (simdLevel == SimdLevel::avx2)
+                    accumulatedCount = accumulateRowAvx2(row, columnSums.data(), rowSize);
+            #endif
+            accumulateRowScalar(row, columnSums.data(), accumulatedCount, rowSize);
+        }
+
+        uint8_t* const destinationRow = destination.data + y * destination.lineSize;
+        for (int x = 0; x < destinationWidth; ++x)
+        {
+            const int columnBegin = columnBegins[x];
+            const int columnEnd = columnBegins[x + 1];
+            const int pixelCount = (columnEnd - columnBegin) * (rowEnd - rowBegin);
+            for (int channel = 0; channel < channelCount; ++channel)
+            {
+                int sum = 0;
+                for (int sourceX = columnBegin; sourceX < columnEnd; ++sourceX)
+                    sum += columnSums[sourceX * channelCount + channel];
+                destinationRow[x * channelCount + channel] =
+                    (uint8_t) ((sum + pixelCount / 2) / pixelCount);
+            }
+        }
+    }
+}
+
+} // namespace nx::sdk::analytics
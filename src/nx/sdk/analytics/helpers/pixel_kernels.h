@@ -0,0 +1,98 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <cstdint>
+
+#include <nx/sdk/analytics/i_uncompressed_video_frame.h>
+
+namespace nx::sdk::analytics {
+
+/**
+ * Instruction set used by the pixel kernels below. The scalar implementation is the reference:
+ * the vectorized ones produce exactly the same result.
+ *
+ * The vectorized kernels are compiled only by GCC and Clang for x86; elsewhere, including MSVC,
+ * bestSimdLevel() is SimdLevel::scalar.
+ */
+enum class SimdLevel
+{
+    scalar,
+    avx2,
+    best, //< The best level supported by the CPU, detected at runtime.
+};
+
+SimdLevel bestSimdLevel();
+
+/** Image plane of 8-bit samples, which is not owned; lineSize can exceed the row size. */
+struct ImagePlane
+{
+    const uint8_t* data = nullptr;
+    int lineSize = 0;
+
+    /** @return The plane starting at the given pixel, sharing the data. */
+    ImagePlane cropped(int x, int y, int bytesPerPixel) const
+    {
+        return {data + y * lineSize + x * bytesPerPixel, lineSize};
+    }
+};
+
+struct MutableImagePlane
+{
+    uint8_t* data = nullptr;
+    int lineSize = 0;
+};
+
+/** Planes of a yuv420 image (see IUncompressedVideoFrame::PixelFormat::yuv420), not owned. */
+struct Yuv420Image
+{
+    ImagePlane y;
+    ImagePlane u; //< Half the width and the height of y, rounded up.
+    ImagePlane v;
+    int width = 0;
+    int height = 0;
+
+    /** @return Image with null planes if the frame is not yuv420 or its data is not accessible. */
+    static Yuv420Image fromFrame(const IUncompressedVideoFrame* frame);
+
+    bool isNull() const { return !y.data || !u.data || !v.data; }
+
+    /**
+     * @return Image of the rectangle, sharing the data. The rectangle position is rounded down to
+     *     even coordinates, because a chroma sample covers 2x2 luma samples.
+     */
+    Yuv420Image cropped(int x, int y, int width, int height) const;
+};
+
+/** Copies the luma plane, which is the grayscale image. */
+void yuv420ToGray(const Yuv420Image& image, MutableImagePlane gray);
+
+/**
+ * Converts to 24-bit rgb (see IUncompressedVideoFrame::PixelFormat::rgb) using the BT.601
+ * limited-range coefficients in 8-bit fixed point.
+ */
+void yuv420ToRgb(
+    const Yuv420Image& image, MutableImagePlane rgb, SimdLevel simdLevel = SimdLevel::best);
+
+/**
+ * Downscales an image with interleaved channels by averaging the source pixels covered by each
+ * destination pixel; the source area of a destination pixel is rounded to whole pixels. The
+ * destination must not be larger than the source, and not smaller than 1/256 of it.
+ *
+ * Only the single-channel images are vectorized: with interleaved channels, the time goes to the
+ * per-channel averaging of the columns, so the vectorized row accumulation does not pay off, and
+ * the scalar code is used at any simdLevel.
+ *
+ * @param channelCount Number of bytes per pixel, e.g. 1 for the grayscale, 3 for rgb.
+ */
+void downscaleArea(
+    ImagePlane source,
+    int sourceWidth,
+    int sourceHeight,
+    int channelCount,
+    MutableImagePlane destination,
+    int destinationWidth,
+    int destinationHeight,
+    SimdLevel simdLevel = SimdLevel::best);
+
+} // namespace nx::sdk::analytics
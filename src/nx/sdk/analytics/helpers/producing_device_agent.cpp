@@ -0,0 +1,221 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "producing_device_agent.h"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+#include <nx/kit/debug.h>
+
+namespace nx::sdk::analytics {
+
+//-------------------------------------------------------------------------------------------------
+// ProducerExecutor
+
+ProducerExecutor& ProducerExecutor::instance()
+{
+    static ProducerExecutor executor;
+    return executor;
+}
+
+ProducerExecutor::ProducerExecutor()
+{
+    m_thread = std::thread([this]() { run(); });
+}
+
+ProducerExecutor::~ProducerExecutor()
+{
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+}
+
+void ProducerExecutor::schedule(std::coroutine_handle<> coroutine, Clock::time_point time)
+{
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        if (coroutine == m_runningCoroutine && std::exchange(m_isRunningCoroutineWoken, false))
+            time = Clock::now();
+        m_queue.emplace(time, coroutine);
+    }
+    m_condition.notify_all();
+}
+
+void ProducerExecutor::cancel(std::coroutine_handle<> coroutine)
+{
+    NX_KIT_ASSERT(!isExecutorThread());
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // A running coroutine may schedule itself again before suspending, so it is unscheduled after
+    // that.
+    m_condition.wait(lock, [&]() { return m_runningCoroutine != coroutine; });
+
+    for (auto it = m_queue.begin(); it != m_queue.end();)
+    {
+        if (it->second == coroutine)
+            it = m_queue.erase(it);
+        else
+            ++it;
+    }
+}
+
+void ProducerExecutor::wake(std::coroutine_handle<> coroutine)
+{
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        if (coroutine == m_runningCoroutine)
+        {
+            m_isRunningCoroutineWoken = true; //< Taken into account by schedule().
+            return;
+        }
+
+        const auto it = std::find_if(m_queue.begin(), m_queue.end(),
+            [&](const auto& entry) { return entry.second == coroutine; });
+        if (it == m_queue.end())
+            return;
+        m_queue.erase(it);
+        m_queue.emplace(Clock::now(), coroutine);
+    }
+    m_condition.notify_all();
+}
+
+void ProducerExecutor::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_isStopping)
+    {
+        if (m_queue.empty())
+        {
+            m_condition.wait(lock);
+            continue;
+        }
+
+        const auto first = m_queue.begin();
+        if (first->first > Clock::now())
+        {
+            // Woken up earlier if an earlier coroutine is scheduled, or on stopping.
+            m_condition.wait_until(lock, first->first);
+            continue;
+        }
+
+        m_runningCoroutine = first->second;
+        m_queue.erase(first);
+        lock.unlock();
+
+        m_runningCoroutine.resume();
+
+        lock.lock();
+        m_runningCoroutine = nullptr;
+        m_isRunningCoroutineWoken = false; //< The coroutine has finished without sleeping.
+        m_condition.notify_all(); //< Wakes up cancel().
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// ProducerTask
+
+void ProducerTask::promise_type::unhandled_exception()
+{
+    try
+    {
+        throw;
+    }
+    catch (const std::exception& e)
+    {
+        NX_PRINT << "ERROR: Metadata producer coroutine has thrown an exception: " << e.what();
+    }
+    catch (...)
+    {
+        NX_PRINT << "ERROR: Metadata producer coroutine has thrown an unknown exception.";
+    }
+}
+
+ProducerTask::ProducerTask(ProducerTask&& other) noexcept:
+    m_coroutine(std::exchange(other.m_coroutine, nullptr)),
+    m_isStarted(std::exchange(other.m_isStarted, false))
+{
+}
+
+ProducerTask& ProducerTask::operator=(ProducerTask&& other) noexcept
+{
+    if (this != &other)
+    {
+        stop();
+        m_coroutine = std::exchange(other.m_coroutine, nullptr);
+        m_isStarted = std::exchange(other.m_isStarted, false);
+    }
+    return *this;
+}
+
+ProducerTask::~ProducerTask()
+{
+    stop();
+}
+
+void ProducerTask::start(ProducerExecutor* executor, Sink sink)
+{
+    if (!NX_KIT_ASSERT(m_coroutine && !m_isStarted))
+        return;
+
+    m_coroutine.promise().executor = executor;
+    m_coroutine.promise().sink = std::move(sink);
+    m_isStarted = true;
+    executor->schedule(m_coroutine, ProducerExecutor::Clock::now());
+}
+
+void ProducerTask::stop()
+{
+    if (!m_coroutine)
+        return;
+
+    if (m_isStarted)
+        m_coroutine.promise().executor->cancel(m_coroutine);
+    m_coroutine.destroy();
+    m_coroutine = nullptr;
+    m_isStarted = false;
+}
+
+void ProducerTask::wake()
+{
+    if (m_coroutine && m_isStarted)
+        m_coroutine.promise().executor->wake(m_coroutine);
+}
+
+//-------------------------------------------------------------------------------------------------
+// ProducingDeviceAgent
+
+ProducingDeviceAgent::~ProducingDeviceAgent()
+{
+    // Normally, the derived class has already stopped the coroutine.
+    stopProducing();
+}
+
+void ProducingDeviceAgent::startProducing()
+{
+    const std::lock_guard<std::mutex> lock(m_taskMutex);
+    if (m_task.isValid() && !m_task.isDone())
+        return;
+
+    m_task = produce();
+    m_task.start(&ProducerExecutor::instance(),
+        [this](Ptr<IMetadataPacket> packet) { pushMetadataPacket(std::move(packet)); });
+}
+
+void ProducingDeviceAgent::stopProducing()
+{
+    const std::lock_guard<std::mutex> lock(m_taskMutex);
+    m_task.stop();
+}
+
+void ProducingDeviceAgent::wakeProducer()
+{
+    const std::lock_guard<std::mutex> lock(m_taskMutex);
+    m_task.wake();
+}
+
+} // namespace nx::sdk::analytics
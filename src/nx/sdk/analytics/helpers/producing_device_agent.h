@@ -0,0 +1,206 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include <nx/sdk/analytics/helpers/consuming_device_agent.h>
+#include <nx/sdk/analytics/i_metadata_packet.h>
+#include <nx/sdk/ptr.h>
+
+namespace nx::sdk::analytics {
+
+/**
+ * Runs coroutines (see ProducerTask) on a single thread, resuming each one when its sleep is
+ * over. Thus, any number of DeviceAgents which produce metadata on a schedule need neither a
+ * thread each nor any synchronization with each other.
+ */
+class ProducerExecutor
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /** The executor shared by all ProducingDeviceAgents of the process. */
+    static ProducerExecutor& instance();
+
+    ProducerExecutor();
+
+    /** Stops the thread; the coroutines which are still scheduled are not resumed. */
+    ~ProducerExecutor();
+
+    ProducerExecutor(const ProducerExecutor&) = delete;
+    ProducerExecutor& operator=(const ProducerExecutor&) = delete;
+
+    void schedule(std::coroutine_handle<> coroutine, Clock::time_point time);
+
+    /**
+     * Unschedules the coroutine, waiting for it to suspend if it is running. After that, the
+     * coroutine can be destroyed. Must not be called from the executor thread.
+     */
+    void cancel(std::coroutine_handle<> coroutine);
+
+    /**
+     * Resumes the scheduled coroutine now rather than after its sleep. If the coroutine is
+     * running, its next sleep is skipped instead, so that the wake-up is not lost.
+     */
+    void wake(std::coroutine_handle<> coroutine);
+
+    bool isExecutorThread() const { return std::this_thread::get_id() == m_thread.get_id(); }
+
+private:
+    void run();
+
+private:
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::multimap<Clock::time_point, std::coroutine_handle<>> m_queue;
+    std::coroutine_handle<> m_runningCoroutine;
+    bool m_isRunningCoroutineWoken = false;
+    bool m_isStopping = false;
+    std::thread m_thread;
+};
+
+/**
+ * Return type of a coroutine which produces metadata packets: the coroutine sends a packet via
+ * `co_yield packet`, and waits via `co_await sleepFor(...)`. The coroutine does not start until
+ * start() is called, and runs on the thread of the ProducerExecutor.
+ */
+class ProducerTask
+{
+public:
+    using Sink = std::function<void(Ptr<IMetadataPacket>)>;
+
+    struct promise_type
+    {
+        ProducerExecutor* executor = nullptr;
+        Sink sink;
+
+        ProducerTask get_return_object()
+        {
+            return ProducerTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+
+        std::suspend_never yield_value(Ptr<IMetadataPacket> packet)
+        {
+            if (packet)
+                sink(std::move(packet));
+            return {};
+        }
+
+        void return_void() {}
+
+        /** Logs the exception and finishes the coroutine. */
+        void unhandled_exception();
+    };
+
+    ProducerTask() = default;
+    ProducerTask(ProducerTask&& other) noexcept;
+    ProducerTask& operator=(ProducerTask&& other) noexcept;
+
+    /** Stops the coroutine, if any. */
+    ~ProducerTask();
+
+    /** @param sink Receives the packets yielded by the coroutine, on the executor thread. */
+    void start(ProducerExecutor* executor, Sink sink);
+
+    /** Stops and destroys the coroutine; see ProducerExecutor::cancel(). */
+    void stop();
+
+    /** Cuts the current sleep of the started coroutine short; see ProducerExecutor::wake(). */
+    void wake();
+
+    bool isValid() const { return (bool) m_coroutine; }
+
+    /** @return Whether the coroutine has returned (or has thrown). */
+    bool isDone() const { return m_coroutine && m_coroutine.done(); }
+
+private:
+    explicit ProducerTask(std::coroutine_handle<promise_type> coroutine): m_coroutine(coroutine) {}
+
+private:
+    std::coroutine_handle<promise_type> m_coroutine;
+    bool m_isStarted = false;
+};
+
+/** Awaitable which resumes the ProducerTask coroutine after the given time. */
+class SleepFor
+{
+public:
+    explicit SleepFor(ProducerExecutor::Clock::duration duration): m_duration(duration) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<ProducerTask::promise_type> coroutine) const
+    {
+        coroutine.promise().executor->schedule(
+            coroutine, ProducerExecutor::Clock::now() + m_duration);
+    }
+
+    void await_resume() const noexcept {}
+
+private:
+    const ProducerExecutor::Clock::duration m_duration;
+};
+
+inline SleepFor sleepFor(ProducerExecutor::Clock::duration duration)
+{
+    return SleepFor(duration);
+}
+
+/**
+ * Base class for a DeviceAgent which produces metadata on its own schedule rather than in
+ * response to video frames. Instead of running a thread, the derived class implements produce()
+ * as a coroutine, e.g.:
+ * <pre><code>
+ *     virtual ProducerTask produce() override
+ *     {
+ *         for (;;)
+ *         {
+ *             co_yield makeSomePacket();
+ *             co_await sleepFor(std::chrono::milliseconds(500));
+ *         }
+ *     }
+ * </code></pre>
+ * The coroutines of all DeviceAgents run on the shared ProducerExecutor thread, so they should
+ * not block. The yielded packets are sent via pushMetadataPacket().
+ */
+class ProducingDeviceAgent: public ConsumingDeviceAgent
+{
+protected:
+    using ConsumingDeviceAgent::ConsumingDeviceAgent;
+
+    virtual ProducerTask produce() = 0;
+
+    /** Starts a new produce() coroutine, unless it is already running. */
+    void startProducing();
+
+    /**
+     * Stops the coroutine, waiting for it to suspend if it is running. Must be called in the
+     * destructor of the derived class, because the coroutine uses its members.
+     */
+    void stopProducing();
+
+    /**
+     * Makes the coroutine resume now rather than after its current sleep, e.g. when the state it
+     * checks has changed. Does nothing if the coroutine is not running.
+     */
+    void wakeProducer();
+
+public:
+    virtual ~ProducingDeviceAgent() override;
+
+private:
+    std::mutex m_taskMutex;
+    ProducerTask m_task;
+};
+
+} // namespace nx::sdk::analytics
@@ -1,3 +1,4 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #include "attribute.h"
@@ -8,8 +9,10 @@ Attribute::Attribute(
     Type type,
     std::string name,
     std::string value,
-    float confidence)
+    float confidence,
+    RefCountPolicy refCountPolicy)
     :
+    RefCountable(refCountPolicy),
     m_type(type),
     m_name(std::move(name)),
     m_value(std::move(value)),
@@ -1,3 +1,4 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #pragma once
@@ -16,7 +17,8 @@ public:
         Type type,
         std::string name,
         std::string value,
-        float confidence = 1.0);
+        float confidence = 1.0,
+        RefCountPolicy refCountPolicy = RefCountPolicy::atomic);
 
     Attribute(std::string name, std::string value, float confidence = 1.0);
 
@@ -1,3 +1,4 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #pragma once
@@ -9,6 +10,23 @@
 
 namespace nx::sdk {
 
+/** How the reference counter of a RefCountable object is updated. */
+enum class RefCountPolicy
+{
+    /** Each change is an atomic read-modify-write, so the object can be shared between threads. */
+    atomic,
+
+    /**
+     * Changes are plain loads and stores until the object is published via publish(), and atomic
+     * after that. Intended for objects which are built in bulk on one thread, e.g. metadata
+     * packets with their objects and attributes. The object must be published before it becomes
+     * reachable from another thread, including being passed to the Server; the synchronization of
+     * the hand-over makes the publication visible to the other threads. ConsumingDeviceAgent
+     * publishes the object metadata packets it sends to the Server.
+     */
+    threadConfined,
+};
+
 /**
  * Not recommended to be used directly - use RefCountable, unless there is some special case.
  *
@@ -35,7 +53,13 @@ public:
      *
      * NOTE: After creation, the reference counter is 1.
      */
-    RefCountableHolder(const IRefCountable* refCountable): m_refCountable(refCountable) {}
+    RefCountableHolder(
+        const IRefCountable* refCountable, RefCountPolicy policy = RefCountPolicy::atomic)
+        :
+        m_isThreadConfined(policy == RefCountPolicy::threadConfined),
+        m_refCountable(refCountable)
+    {
+    }
 
     /**
      * Delegates reference counting to another object. Does not change the reference counter.
@@ -44,7 +68,12 @@ public:
 
     int addRef() const
     {
-        return m_refCountHolderDelegate ? m_refCountHolderDelegate->addRef() : ++m_refCount;
+        if (m_refCountHolderDelegate)
+            return m_refCountHolderDelegate->addRef();
+
+        if (m_isThreadConfined.load(std::memory_order_relaxed))
+            return addToThreadConfinedRefCount(1);
+        return ++m_refCount;
     }
 
     /**
@@ -55,7 +84,9 @@ public:
         if (m_refCountHolderDelegate)
             return m_refCountHolderDelegate->releaseRef();
 
-        const int newRefCounter = --m_refCount;
+        const int newRefCounter = m_isThreadConfined.load(std::memory_order_relaxed)
+            ? addToThreadConfinedRefCount(-1)
+            : --m_refCount;
         if (newRefCounter == 0)
             delete m_refCountable;
         return newRefCounter;
@@ -68,8 +99,36 @@ public:
         return m_refCount;
     }
 
+    /**
+     * Switches the reference counting to atomic, see RefCountPolicy::threadConfined. Must be
+     * called on the thread which owns the object. Does nothing if the object is already published.
+     */
+    void publish() const
+    {
+        if (m_refCountHolderDelegate)
+            return m_refCountHolderDelegate->publish();
+        m_isThreadConfined.store(false, std::memory_order_relaxed);
+    }
+
+    bool isPublished() const
+    {
+        if (m_refCountHolderDelegate)
+            return m_refCountHolderDelegate->isPublished();
+        return !m_isThreadConfined.load(std::memory_order_relaxed);
+    }
+
+private:
+    /** Compiles to a plain increment or decrement: a relaxed load and store are not an RMW. */
+    int addToThreadConfinedRefCount(int delta) const
+    {
+        const int newRefCount = m_refCount.load(std::memory_order_relaxed) + delta;
+        m_refCount.store(newRefCount, std::memory_order_relaxed);
+        return newRefCount;
+    }
+
 private:
     mutable std::atomic<int> m_refCount{1};
+    mutable std::atomic<bool> m_isThreadConfined{false}; /**< Accessed by the owner thread only. */
     const IRefCountable* const m_refCountable = nullptr;
     const RefCountableHolder* const m_refCountHolderDelegate = nullptr;
 };
@@ -78,6 +137,10 @@ private:
  * Recommended base class for objects implementing an interface.
  *
  * Supports tracking the ref-countable objects via RefCountableRegistry.
+ *
+ * The reference counting is atomic, unless the derived class passes
+ * RefCountPolicy::threadConfined to the constructor; then the object must be published via
+ * publish() before it is shared with another thread.
  */
 template<class RefCountableInterface>
 class RefCountable: public RefCountableInterface
@@ -99,8 +162,18 @@ public:
 
     int refCount() const { return m_refCountableHolder.refCount(); }
 
+    /**
+     * See RefCountPolicy::threadConfined. Does nothing for an atomically counted object. Virtual,
+     * so that an object which owns other thread-confined objects publishes them as well, whatever
+     * type it is published via.
+     */
+    virtual void publish() const { m_refCountableHolder.publish(); }
+
+    bool isPublished() const { return m_refCountableHolder.isPublished(); }
+
 protected:
-    RefCountable(): m_refCountableHolder(static_cast<const IRefCountable*>(this))
+    explicit RefCountable(RefCountPolicy refCountPolicy = RefCountPolicy::atomic):
+        m_refCountableHolder(static_cast<const IRefCountable*>(this), refCountPolicy)
     {
         if (const auto refCountableRegistry = libContext().refCountableRegistry())
             refCountableRegistry->notifyCreated(this, refCount());
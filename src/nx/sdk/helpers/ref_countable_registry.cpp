@@ -0,0 +1,198 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "ref_countable_registry.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+
+#if defined(__GNUC__)
+    #include <cxxabi.h>
+#endif
+
+#include <nx/kit/utils.h>
+
+#undef NX_PRINT_PREFIX
+#define NX_PRINT_PREFIX "[nx::sdk::RefCountableRegistry " << m_name << "] "
+#include <nx/kit/debug.h>
+
+namespace nx::sdk {
+
+static std::string demangledTypeName(const std::type_info& type)
+{
+    #if defined(__GNUC__)
+        int status = -1;
+        char* const demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+        if (status == 0 && demangled)
+        {
+            const std::string result = demangled;
+            free(demangled);
+            return result;
+        }
+        free(demangled);
+    #endif
+    return type.name();
+}
+
+RefCountableRegistry::RefCountableRegistry(std::string name): m_name(std::move(name))
+{
+}
+
+RefCountableRegistry::~RefCountableRegistry()
+{
+    const int64_t leakedCount = liveCount();
+    if (leakedCount == 0)
+        return;
+
+    NX_PRINT << leakedCount << " ref-countable object(s) leaked:\n" << leakReport();
+    NX_KIT_ASSERT(leakedCount == 0);
+}
+
+RefCountableRegistry::Shard& RefCountableRegistry::shard(const IRefCountable* refCountable) const
+{
+    // The low bits are the same for all objects because of the alignment.
+    const auto address = reinterpret_cast<uintptr_t>(refCountable);
+    return m_shards[((address >> 4) ^ (address >> 12)) % kShardCount];
+}
+
+RefCountableRegistry::TypeCounters* RefCountableRegistry::typeCounters(const std::type_info& type)
+{
+    const std::type_index typeIndex(type);
+    {
+        const std::shared_lock<std::shared_mutex> lock(m_typesMutex);
+        if (const auto it = m_types.find(typeIndex); it != m_types.end())
+            return it->second.get();
+    }
+
+    const std::unique_lock<std::shared_mutex> lock(m_typesMutex);
+    auto& counters = m_types[typeIndex];
+    if (!counters)
+    {
+        counters = std::make_unique<TypeCounters>();
+        counters->typeName = demangledTypeName(type);
+    }
+    return counters.get();
+}
+
+void RefCountableRegistry::notifyCreated(const IRefCountable* refCountable, int /*refCount*/)
+{
+    TypeCounters* const counters = typeCounters(typeid(*refCountable));
+
+    Shard& objectShard = shard(refCountable);
+    {
+        const std::lock_guard<std::mutex> lock(objectShard.mutex);
+        if (!NX_KIT_ASSERT(objectShard.objects.emplace(refCountable, counters).second,
+            nx::kit::utils::format("Object %p of %s is created twice.",
+                refCountable, counters->typeName.c_str())))
+        {
+            return;
+        }
+    }
+
+    counters->createdCount.fetch_add(1, std::memory_order_relaxed);
+    const int64_t liveCount = counters->liveCount.fetch_add(1, std::memory_order_relaxed) + 1;
+    int64_t peakLiveCount = counters->peakLiveCount.load(std::memory_order_relaxed);
+    while (liveCount > peakLiveCount
+        && !counters->peakLiveCount.compare_exchange_weak(
+            peakLiveCount, liveCount, std::memory_order_relaxed))
+    {
+    }
+}
+
+void RefCountableRegistry::notifyDestroyed(const IRefCountable* refCountable, int refCount)
+{
+    TypeCounters* counters = nullptr;
+
+    Shard& objectShard = shard(refCountable);
+    {
+        const std::lock_guard<std::mutex> lock(objectShard.mutex);
+        const auto it = objectShard.objects.find(refCountable);
+        if (!NX_KIT_ASSERT(it != objectShard.objects.end(),
+            nx::kit::utils::format(
+                "Unknown object %p is destroyed: destroyed twice, or created before the registry.",
+                refCountable)))
+        {
+            return;
+        }
+        counters = it->second;
+        objectShard.objects.erase(it);
+    }
+
+    NX_KIT_ASSERT(refCount == 0, nx::kit::utils::format(
+        "Object %p of %s is destroyed with the reference count %d.",
+        refCountable, counters->typeName.c_str(), refCount));
+
+    counters->destroyedCount.fetch_add(1, std::memory_order_relaxed);
+    counters->liveCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+int64_t RefCountableRegistry::liveCount() const
+{
+    int64_t count = 0;
+    for (Shard& objectShard: m_shards)
+    {
+        const std::lock_guard<std::mutex> lock(objectShard.mutex);
+        count += (int64_t) objectShard.objects.size();
+    }
+    return count;
+}
+
+std::vector<RefCountableRegistry::TypeStats> RefCountableRegistry::typeStats() const
+{
+    std::vector<TypeStats> result;
+    {
+        const std::shared_lock<std::shared_mutex> lock(m_typesMutex);
+        for (const auto& [typeIndex, counters]: m_types)
+        {
+            result.push_back({
+                counters->typeName,
+                counters->createdCount.load(std::memory_order_relaxed),
+                counters->destroyedCount.load(std::memory_order_relaxed),
+                counters->liveCount.load(std::memory_order_relaxed),
+                counters->peakLiveCount.load(std::memory_order_relaxed)});
+        }
+    }
+
+    std::sort(result.begin(), result.end(),
+        [](const TypeStats& a, const TypeStats& b)
+        {
+            return a.createdCount != b.createdCount
+                ? a.createdCount > b.createdCount
+                : a.typeName < b.typeName;
+        });
+    return result;
+}
+
+std::string RefCountableRegistry::leakReport() const
+{
+    std::string report;
+    for (Shard& objectShard: m_shards)
+    {
+        const std::lock_guard<std::mutex> lock(objectShard.mutex);
+        for (const auto& [refCountable, counters]: objectShard.objects)
+        {
+            report += nx::kit::utils::format(
+                "    %p %s\n", refCountable, counters->typeName.c_str());
+        }
+    }
+    return report;
+}
+
+std::string RefCountableRegistry::report() const
+{
+    std::string report = nx::kit::utils::format(
+        "%10s %10s %10s %10s  %s\n", "Created", "Destroyed", "Live", "Peak live", "Type");
+    for (const TypeStats& stats: typeStats())
+    {
+        report += nx::kit::utils::format("%10lld %10lld %10lld %10lld  %s\n",
+            (long long) stats.createdCount, (long long) stats.destroyedCount,
+            (long long) stats.liveCount, (long long) stats.peakLiveCount,
+            stats.typeName.c_str());
+    }
+
+    if (const std::string leaks = leakReport(); !leaks.empty())
+        report += "Live objects:\n" + leaks;
+    return report;
+}
+
+} // namespace nx::sdk
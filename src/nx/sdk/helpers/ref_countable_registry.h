@@ -0,0 +1,91 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#include <nx/sdk/helpers/i_ref_countable_registry.h>
+
+namespace nx::sdk {
+
+/**
+ * Implementation of IRefCountableRegistry for unit tests and debugging: tracks the live objects
+ * to detect leaks and double-frees, and counts the objects of each type, so that the per-frame
+ * object churn of a plugin can be measured. Set it via LibContext::setRefCountableRegistry().
+ *
+ * The live objects are kept in kShardCount maps selected by the object address, each with its own
+ * mutex, so the threads creating objects rarely contend. The per-type counters are atomic.
+ *
+ * The type of an object is the RefCountable<Interface> instantiation, because the registry is
+ * notified from the RefCountable constructor and destructor, where the derived part of the object
+ * does not exist.
+ */
+class RefCountableRegistry: public IRefCountableRegistry
+{
+public:
+    static constexpr int kShardCount = 16;
+
+    struct TypeStats
+    {
+        std::string typeName;
+        int64_t createdCount = 0;
+        int64_t destroyedCount = 0;
+        int64_t liveCount = 0;
+        int64_t peakLiveCount = 0;
+    };
+
+    /** @param name Used in the log messages, e.g. the name of the library. */
+    explicit RefCountableRegistry(std::string name);
+
+    /** Logs the leaked objects, failing an assertion if there are any. */
+    virtual ~RefCountableRegistry() override;
+
+    virtual void notifyCreated(const IRefCountable* refCountable, int refCount) override;
+    virtual void notifyDestroyed(const IRefCountable* refCountable, int refCount) override;
+
+    int64_t liveCount() const;
+
+    /** @return Statistics of each type created so far, the most created first. */
+    std::vector<TypeStats> typeStats() const;
+
+    /** @return Human-readable table of the types, followed by the leaked objects, if any. */
+    std::string report() const;
+
+private:
+    struct TypeCounters
+    {
+        std::string typeName;
+        std::atomic<int64_t> createdCount{0};
+        std::atomic<int64_t> destroyedCount{0};
+        std::atomic<int64_t> liveCount{0};
+        std::atomic<int64_t> peakLiveCount{0};
+    };
+
+    struct alignas(64) Shard
+    {
+        std::mutex mutex;
+        std::unordered_map<const IRefCountable*, TypeCounters*> objects;
+    };
+
+    Shard& shard(const IRefCountable* refCountable) const;
+    TypeCounters* typeCounters(const std::type_info& type);
+    std::string leakReport() const;
+
+private:
+    const std::string m_name;
+    mutable std::array<Shard, kShardCount> m_shards;
+
+    mutable std::shared_mutex m_typesMutex;
+    std::unordered_map<std::type_index, std::unique_ptr<TypeCounters>> m_types;
+};
+
+} // namespace nx::sdk
@@ -0,0 +1,166 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "span_recorder.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include <nx/kit/utils.h>
+
+namespace nx::sdk {
+
+std::atomic<bool> SpanRecorder::s_isEnabled{false};
+
+/** Releases the buffer of the thread on the thread exit. */
+class SpanRecorder::ThreadBufferOwner
+{
+public:
+    ~ThreadBufferOwner()
+    {
+        if (buffer)
+            buffer->isOwned.store(false, std::memory_order_release);
+    }
+
+    ThreadBuffer* buffer = nullptr;
+    uint32_t threadId = 0;
+};
+
+SpanRecorder& SpanRecorder::instance()
+{
+    // Never deleted, because the threads may record spans (and release their buffers) while the
+    // static objects are being destroyed.
+    static SpanRecorder* const recorder = new SpanRecorder();
+    return *recorder;
+}
+
+int64_t SpanRecorder::nowUs()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+SpanRecorder::ThreadBufferOwner& SpanRecorder::threadBufferOwner()
+{
+    static thread_local ThreadBufferOwner owner;
+    return owner;
+}
+
+SpanRecorder::ThreadBuffer* SpanRecorder::threadBuffer()
+{
+    ThreadBufferOwner& owner = threadBufferOwner();
+    if (owner.buffer)
+        return owner.buffer;
+
+    // The first span of the thread.
+    owner.threadId = ++m_lastThreadId;
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& buffer: m_buffers)
+    {
+        if (!buffer->isOwned.load(std::memory_order_acquire))
+        {
+            buffer->isOwned.store(true, std::memory_order_relaxed);
+            return owner.buffer = buffer.get();
+        }
+    }
+    m_buffers.push_back(std::make_unique<ThreadBuffer>());
+    return owner.buffer = m_buffers.back().get();
+}
+
+void SpanRecorder::record(const char* name, int64_t beginUs, int64_t endUs) noexcept
+{
+    ThreadBuffer* const buffer = threadBuffer();
+    const uint64_t index = buffer->writtenCount.load(std::memory_order_relaxed);
+    Event& event = buffer->events[index % ThreadBuffer::kRingSize];
+    event.name.store(name, std::memory_order_relaxed);
+    event.beginUs.store(beginUs, std::memory_order_relaxed);
+    event.durationUs.store(endUs - beginUs, std::memory_order_relaxed);
+    event.threadId.store(threadBufferOwner().threadId, std::memory_order_relaxed);
+    buffer->writtenCount.store(index + 1, std::memory_order_release); //< Publishes the event.
+}
+
+std::string SpanRecorder::chromeTraceJson() const
+{
+    struct Copy
+    {
+        const char* name;
+        int64_t beginUs;
+        int64_t durationUs;
+        uint32_t threadId;
+    };
+    std::vector<Copy> copies;
+
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& buffer: m_buffers)
+        {
+            const uint64_t endCount = buffer->writtenCount.load(std::memory_order_acquire);
+            const uint64_t beginCount =
+                endCount > (uint64_t) kSpansPerThread ? endCount - kSpansPerThread : 0;
+            const size_t firstCopy = copies.size();
+            for (uint64_t i = beginCount; i < endCount; ++i)
+            {
+                const Event& event = buffer->events[i % ThreadBuffer::kRingSize];
+                copies.push_back({
+                    event.name.load(std::memory_order_relaxed),
+                    event.beginUs.load(std::memory_order_relaxed),
+                    event.durationUs.load(std::memory_order_relaxed),
+                    event.threadId.load(std::memory_order_relaxed)});
+            }
+
+            // Drop the events which the writer may have overwritten while they were copied,
+            // including the one it may be writing now (the event after newEndCount - 1).
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t newEndCount = buffer->writtenCount.load(std::memory_order_relaxed);
+            const uint64_t firstIntactIndex =
+                (newEndCount + 1 > (uint64_t) ThreadBuffer::kRingSize)
+                    ? newEndCount + 1 - ThreadBuffer::kRingSize
+                    : 0;
+            const uint64_t overwrittenCount =
+                std::min(endCount, std::max(beginCount, firstIntactIndex)) - beginCount;
+            copies.erase(copies.begin() + (ptrdiff_t) firstCopy,
+                copies.begin() + (ptrdiff_t) (firstCopy + overwrittenCount));
+        }
+    }
+
+    std::sort(copies.begin(), copies.end(),
+        [](const Copy& a, const Copy& b) { return a.beginUs < b.beginUs; });
+
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (int i = 0; i < (int) copies.size(); ++i)
+    {
+        const Copy& copy = copies[i];
+        json += (i == 0 ? "\n" : ",\n");
+        json += nx::kit::utils::format(
+            R"({"name":%s,"ph":"X","pid":1,"tid":%u,"ts":%lld,"dur":%lld})",
+            nx::kit::utils::toString(copy.name).c_str(), copy.threadId,
+            (long long) copy.beginUs, (long long) copy.durationUs);
+    }
+    json += "\n]}\n";
+    return json;
+}
+
+std::string SpanRecorder::writeChromeTrace(const std::string& path) const
+{
+    const std::string json = chromeTraceJson();
+
+    FILE* const file = fopen(path.c_str(), "wb");
+    if (!file)
+        return "Unable to create " + nx::kit::utils::toString(path) + ": " + strerror(errno);
+    const bool isWritten = fwrite(json.data(), 1, json.size(), file) == json.size();
+    const int writeErrno = errno;
+    if (fclose(file) != 0 || !isWritten)
+        return "Unable to write " + nx::kit::utils::toString(path) + ": " + strerror(writeErrno);
+    return "";
+}
+
+void SpanRecorder::clear()
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& buffer: m_buffers)
+        buffer->writtenCount.store(0, std::memory_order_relaxed);
+}
+
+} // namespace nx::sdk
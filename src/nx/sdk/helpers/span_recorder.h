@@ -0,0 +1,126 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace nx::sdk {
+
+/**
+ * Process-wide recorder of timed spans (e.g. the stages of processing a video frame), which can be
+ * exported in the Chrome trace-event JSON format, viewable via chrome://tracing or
+ * https://ui.perfetto.dev.
+ *
+ * Each thread writes to its own fixed-size ring buffer, keeping the most recent spans, without
+ * locks or allocations; the buffer is allocated on the first span of the thread. When disabled,
+ * which is the default, a span costs a single relaxed atomic load.
+ *
+ * Usage:
+ * <pre><code>
+ *     void f()
+ *     {
+ *         nx::sdk::Span span("f");
+ *         ...
+ *     }
+ * </code></pre>
+ */
+class SpanRecorder
+{
+public:
+    /** Number of the most recent spans kept for each thread. */
+    static constexpr int kSpansPerThread = 16384;
+
+    static SpanRecorder& instance();
+
+    static bool isEnabled() { return s_isEnabled.load(std::memory_order_relaxed); }
+
+    /** The already recorded spans are kept when disabling. */
+    static void setEnabled(bool value) { s_isEnabled.store(value, std::memory_order_relaxed); }
+
+    /** @return Microseconds of a monotonic clock, as used for the span timestamps. */
+    static int64_t nowUs();
+
+    /**
+     * @param name Must be a string literal, or otherwise live until the recorder is cleared: only
+     *     the pointer is stored.
+     */
+    void record(const char* name, int64_t beginUs, int64_t endUs) noexcept;
+
+    /** Can be called concurrently with recording; the spans being overwritten are skipped. */
+    std::string chromeTraceJson() const;
+
+    /** @return Error message, or an empty string on success. */
+    std::string writeChromeTrace(const std::string& path) const;
+
+    /** Discards the recorded spans. Must not be called concurrently with recording. */
+    void clear();
+
+private:
+    struct Event
+    {
+        std::atomic<const char*> name{nullptr};
+        std::atomic<int64_t> beginUs{0};
+        std::atomic<int64_t> durationUs{0};
+        std::atomic<uint32_t> threadId{0};
+    };
+
+    /**
+     * Single-writer ring; the writer is the thread which currently owns the buffer. Has a spare
+     * slot, so that the slot being written is never among the kSpansPerThread read ones.
+     */
+    struct ThreadBuffer
+    {
+        static constexpr int kRingSize = kSpansPerThread + 1;
+
+        std::atomic<bool> isOwned{true};
+        std::atomic<uint64_t> writtenCount{0}; /**< Free-running; the ring index is `% size`. */
+        std::vector<Event> events = std::vector<Event>(kRingSize);
+    };
+
+    class ThreadBufferOwner;
+
+    SpanRecorder() = default;
+
+    static ThreadBufferOwner& threadBufferOwner();
+    ThreadBuffer* threadBuffer();
+
+private:
+    static std::atomic<bool> s_isEnabled;
+
+    /** Buffers of the exited threads are reused by the new threads, so the count stays bounded. */
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+    std::atomic<uint32_t> m_lastThreadId{0};
+};
+
+/** Records the span from its construction to its destruction, if SpanRecorder is enabled. */
+class Span
+{
+public:
+    /** @param name Must be a string literal. */
+    explicit Span(const char* name) noexcept:
+        m_name(SpanRecorder::isEnabled() ? name : nullptr),
+        m_beginUs(m_name ? SpanRecorder::nowUs() : 0)
+    {
+    }
+
+    ~Span()
+    {
+        if (m_name)
+            SpanRecorder::instance().record(m_name, m_beginUs, SpanRecorder::nowUs());
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* const m_name;
+    const int64_t m_beginUs;
+};
+
+} // namespace nx::sdk
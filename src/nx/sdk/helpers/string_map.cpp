@@ -1,47 +1,115 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #include "string_map.h"
 
-#include <iterator>
+#include <algorithm>
 
 #include <nx/kit/debug.h>
 
 namespace nx::sdk {
 
+StringMap::StringMap(const Map& map)
+{
+    int bufferSize = 0;
+    for (const auto& [key, value]: map)
+        bufferSize += (int) (key.size() + value.size()) + 2;
+    m_buffer.reserve(bufferSize);
+    m_items.reserve(map.size());
+
+    for (const auto& [key, value]: map)
+    {
+        NX_KIT_ASSERT(!key.empty());
+        m_items.push_back({
+            appendString(key), (int) key.size(), appendString(value), (int) value.size()});
+    }
+}
+
+int StringMap::appendString(std::string_view value)
+{
+    const int offset = (int) m_buffer.size();
+    m_buffer.append(value);
+    m_buffer.push_back('\0');
+    return offset;
+}
+
+std::string_view StringMap::keyOf(const Item& item) const
+{
+    return std::string_view(m_buffer.data() + item.keyOffset, item.keySize);
+}
+
+std::vector<StringMap::Item>::const_iterator StringMap::lowerBound(std::string_view key) const
+{
+    return std::lower_bound(m_items.cbegin(), m_items.cend(), key,
+        [this](const Item& item, std::string_view key) { return keyOf(item) < key; });
+}
+
 void StringMap::setItem(std::string key, std::string value)
 {
     NX_KIT_ASSERT(!key.empty());
-    m_map[std::move(key)] = std::move(value);
-    m_lookupCache.clear();
+
+    const auto it = lowerBound(key);
+    if (it != m_items.cend() && keyOf(*it) == key)
+    {
+        Item& item = m_items[it - m_items.cbegin()];
+        m_unusedBufferSize += item.valueSize + 1;
+        item.valueOffset = appendString(value);
+        item.valueSize = (int) value.size();
+        if (m_unusedBufferSize > (int) m_buffer.size() / 2)
+            compact();
+        return;
+    }
+
+    const int keyOffset = appendString(key);
+    m_items.insert(it, {keyOffset, (int) key.size(), appendString(value), (int) value.size()});
+}
+
+void StringMap::compact()
+{
+    std::string buffer;
+    buffer.reserve(m_buffer.size() - m_unusedBufferSize);
+    for (Item& item: m_items)
+    {
+        const auto append =
+            [&buffer, this](int* offset, int size)
+            {
+                const int newOffset = (int) buffer.size();
+                buffer.append(m_buffer, *offset, size + 1); //< Including the terminating zero.
+                *offset = newOffset;
+            };
+        append(&item.keyOffset, item.keySize);
+        append(&item.valueOffset, item.valueSize);
+    }
+    m_buffer = std::move(buffer);
+    m_unusedBufferSize = 0;
 }
 
 void StringMap::clear()
 {
-    m_map.clear();
-    m_lookupCache.clear();
+    m_items.clear();
+    m_buffer.clear();
+    m_unusedBufferSize = 0;
 }
 
 int StringMap::count() const
 {
-    return (int) m_map.size();
+    return (int) m_items.size();
 }
 
 const char* StringMap::key(int i) const
 {
-    if (i < 0 || i >= (int) m_map.size())
+    if (i < 0 || i >= (int) m_items.size())
         return nullptr;
 
-    initLookupCache();
-    return m_lookupCache[i * 2];
+    return m_buffer.data() + m_items[i].keyOffset;
 }
 
 const char* StringMap::value(int i) const
 {
-    if (i < 0 || i >= (int) m_map.size())
+    if (i < 0 || i >= (int) m_items.size())
         return nullptr;
 
-    initLookupCache();
-    return m_lookupCache[i * 2 + 1];
+    return m_buffer.data() + m_items[i].valueOffset;
 }
 
 const char* StringMap::value(const char* key) const
@@ -49,24 +117,11 @@ const char* StringMap::value(const char* key) const
     if (key == nullptr)
         return nullptr;
 
-    const Map::const_iterator it = m_map.find(key);
-    if (it == m_map.cend())
+    const auto it = lowerBound(key);
+    if (it == m_items.cend() || keyOf(*it) != key)
         return nullptr;
 
-    return it->second.c_str();
-}
-
-void StringMap::initLookupCache() const
-{
-    if (m_lookupCache.empty())
-    {
-        m_lookupCache.reserve(m_map.size() * 2);
-        for (const auto& [key, value]: m_map)
-        {
-            m_lookupCache.push_back(key.c_str());
-            m_lookupCache.push_back(value.c_str());
-        }
-    }
+    return m_buffer.data() + it->valueOffset;
 }
 
 } // namespace nx::sdk
@@ -1,8 +1,11 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #pragma once
 
 #include <map>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include <nx/sdk/helpers/ref_countable.h>
@@ -10,6 +13,11 @@
 
 namespace nx::sdk {
 
+/**
+ * Keeps the items sorted by key in a flat array, with all the keys and values in a single buffer
+ * of zero-terminated strings, so that both the access by index and the lookup by key do not
+ * depend on the preceding changes, and building the map takes a few allocations in total.
+ */
 class StringMap: public RefCountable<IStringMap>
 {
 public:
@@ -17,7 +25,7 @@ public:
 
     StringMap() = default;
 
-    StringMap(Map map): m_map(std::move(map)) {}
+    StringMap(const Map& map);
 
     void setItem(std::string key, std::string value);
 
@@ -34,13 +42,29 @@ public:
     virtual const char* value(const char* key) const override;
 
 private:
-    void initLookupCache() const;
+    struct Item
+    {
+        int keyOffset = 0;
+        int keySize = 0;
+        int valueOffset = 0;
+        int valueSize = 0;
+    };
 
-private:
-    Map m_map;
+    /** @return Offset of the zero-terminated copy of the string in m_buffer. */
+    int appendString(std::string_view value);
+
+    std::string_view keyOf(const Item& item) const;
+
+    /** @return The first item with the key not less than the given one. */
+    std::vector<Item>::const_iterator lowerBound(std::string_view key) const;
 
-    // Cache for lookup by index to avoid O(N^2).
-    mutable std::vector<const char*> m_lookupCache;
+    /** Rebuilds the buffer without the strings of the overwritten values. */
+    void compact();
+
+private:
+    std::vector<Item> m_items; //< Sorted by key.
+    std::string m_buffer;
+    int m_unusedBufferSize = 0; //< Occupied by the overwritten values.
 };
 
 } // namespace nx::sdk
@@ -1,22 +1,41 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #include "uuid_helper.h"
 
-#include <limits>
-#include <sstream>
-#include <iomanip>
-#include <cstdlib>
-
-#include <nx/kit/debug.h>
+#include <array>
 #include <chrono>
+#include <cstdint>
 #include <random>
-#include <stdint.h>
-#include <mutex>
 
 namespace nx::sdk {
 
 namespace UuidHelper {
 
+static constexpr int8_t kInvalidChar = -1;
+static constexpr int8_t kSeparatorChar = -2; //< Skipped when parsing.
+
+/** Value of each hex digit character, or one of the constants above for the other characters. */
+static constexpr std::array<int8_t, 256> kCharValues =
+    []()
+    {
+        std::array<int8_t, 256> values{};
+        values.fill(kInvalidChar);
+        for (const char c: {'{', '}', '-', '\t', '\n', 'r', ' '})
+            values[(uint8_t) c] = kSeparatorChar;
+        for (int i = 0; i < 10; ++i)
+            values['0' + i] = (int8_t) i;
+        for (int i = 0; i < 6; ++i)
+        {
+            values['a' + i] = (int8_t) (10 + i);
+            values['A' + i] = (int8_t) (10 + i);
+        }
+        return values;
+    }();
+
+static constexpr char kLowercaseHexDigits[] = "0123456789abcdef";
+static constexpr char kUppercaseHexDigits[] = "0123456789ABCDEF";
+
 Uuid fromStdString(const std::string& str)
 {
     static const int kMinUuidStrSize = 32;
@@ -25,41 +44,21 @@ Uuid fromStdString(const std::string& str)
         return Uuid();
 
     Uuid uuid;
-    int currentByteIndex = 0;
-    std::string currentByteString;
+    int digitCount = 0;
     for (const char c: str)
     {
-        switch (c)
-        {
-            case '{': case '}': case '-': case '\t': case '\n': case 'r': case ' ':
-                continue;
-        }
-
-        if (currentByteIndex >= (int) sizeof(Uuid))
+        const int digitValue = kCharValues[(uint8_t) c];
+        if (digitValue == kSeparatorChar)
+            continue;
+        if (digitValue == kInvalidChar || digitCount >= 2 * (int) sizeof(Uuid))
             return Uuid();
 
-        currentByteString += c;
-        if (currentByteString.size() == 2)
-        {
-            char* pEnd = nullptr;
-            errno = 0; //< Required before strtol().
-            const long v = std::strtol(currentByteString.c_str(), &pEnd, /*base*/ 16);
-            const bool hasError =
-                v > std::numeric_limits<uint8_t>::max()
-                || v < std::numeric_limits<uint8_t>::min()
-                || errno != 0
-                || *pEnd != '\0';
-
-            if (hasError)
-                return Uuid();
-
-            uuid[currentByteIndex] = (uint8_t) v;
-            ++currentByteIndex;
-            currentByteString.clear();
-        }
+        uint8_t& byte = uuid[digitCount / 2];
+        byte = (uint8_t) ((byte << 4) | digitValue);
+        ++digitCount;
     }
 
-    if (currentByteIndex != sizeof(Uuid))
+    if (digitCount != 2 * (int) sizeof(Uuid))
         return Uuid();
 
     return uuid;
@@ -67,56 +66,42 @@ Uuid fromStdString(const std::string& str)
 
 std::string toStdString(const Uuid& uuid, FormatOptions formatOptions)
 {
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-
-    if (formatOptions & FormatOptions::braces)
-        ss << '{';
-    if (formatOptions & FormatOptions::uppercase)
-        ss << std::uppercase;
-    for (int i = 0; i < 4; ++i)
-        ss << std::setw(2) << (int) uuid[i];
-    if (formatOptions & FormatOptions::hyphens)
-        ss << '-';
-    for (int i = 0; i < 2; ++i)
-        ss << std::setw(2) << (int) uuid[4 + i];
-    if (formatOptions & FormatOptions::hyphens)
-        ss << "-";
-    for (int i = 0; i < 2; ++i)
-        ss << std::setw(2) << (int) uuid[6 + i];
-    if (formatOptions & FormatOptions::hyphens)
-        ss << "-";
-    for (int i = 0; i < 2; ++i)
-        ss << std::setw(2) << (int) uuid[8 + i];
-    if (formatOptions & FormatOptions::hyphens)
-        ss << "-";
-    for (int i = 0; i < 6; ++i)
-        ss << std::setw(2) << (int) uuid[10 + i];
-    if (formatOptions & FormatOptions::braces)
-        ss << '}';
-
-    return ss.str();
+    const char* const hexDigits = (formatOptions & FormatOptions::uppercase)
+        ? kUppercaseHexDigits
+        : kLowercaseHexDigits;
+    const bool hasHyphens = formatOptions & FormatOptions::hyphens;
+    const bool hasBraces = formatOptions & FormatOptions::braces;
+
+    char buffer[2 * sizeof(Uuid) + /*hyphens*/ 4 + /*braces*/ 2];
+    char* p = buffer;
+
+    if (hasBraces)
+        *p++ = '{';
+    for (int i = 0; i < (int) sizeof(Uuid); ++i)
+    {
+        if (hasHyphens && (i == 4 || i == 6 || i == 8 || i == 10))
+            *p++ = '-';
+        *p++ = hexDigits[uuid[i] >> 4];
+        *p++ = hexDigits[uuid[i] & 0x0F];
+    }
+    if (hasBraces)
+        *p++ = '}';
+
+    return std::string(buffer, p);
 }
 
+/**
+ * One generator per thread, so that the threads generating uuids do not contend for a lock. The
+ * generator is seeded on the first use in the thread.
+ */
 class RandomGenerator64Bit
 {
 public:
-    RandomGenerator64Bit():
-        m_generator(getSeed()),
-        m_distibution(0, std::numeric_limits<uint64_t>::max())
-    {
-    }
-
-    uint64_t value64()
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        return m_distibution(m_generator);
-    }
+    RandomGenerator64Bit(): m_generator(getSeed()) {}
 
     std::array<uint64_t, 2> value128()
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        return { m_distibution(m_generator), m_distibution(m_generator) };
+        return {m_generator(), m_generator()};
     }
 
 private:
@@ -128,19 +113,17 @@ private:
             return time.count() ^ (uintptr_t) this;
         #else
             std::random_device r;
-            return r();
+            return ((uint64_t) r() << 32) ^ r();
         #endif
     }
 
 private:
     std::mt19937_64 m_generator;
-    std::uniform_int_distribution<uint64_t> m_distibution;
-    std::mutex m_mutex;
 };
 
 Uuid randomUuid()
 {
-    static RandomGenerator64Bit generator;
+    static thread_local RandomGenerator64Bit generator;
 
     Uuid uuid;
     memcpy(uuid.data(), generator.value128().data(), sizeof(Uuid));
@@ -1,7 +1,9 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #pragma once
 
+#include <array>
 #include <cstring>
 #include <vector>
 #include <string>
@@ -67,7 +69,14 @@ public:
 
         InterfaceId() = delete; //< No instances - only InterfaceId* are used via reinterpret_cast.
 
-        bool operator==(const InterfaceId& other) const { return strcmp(value, other.value) == 0; }
+        /**
+         * The ids coming from the same binary usually point to the same string literal, so the
+         * pointers are compared before the strings.
+         */
+        bool operator==(const InterfaceId& other) const
+        {
+            return this == &other || strcmp(value, other.value) == 0;
+        }
         bool operator!=(const InterfaceId& other) const { return !(*this == other); }
     };
 
@@ -82,9 +91,12 @@ protected:
         return reinterpret_cast<const InterfaceId*>(charArray);
     }
 
-    /** Intended to be used in interfaceId(). Can be called only with two string literals. */
+    /**
+     * Intended to be used in interfaceId(). Can be called only with two string literals. The ids
+     * are returned as an array rather than a vector, so that queryInterface() does not allocate.
+     */
     template<int len, int alternativeLen>
-    static std::vector<const InterfaceId*> makeIdWithAlternative(
+    static std::array<const InterfaceId*, 2> makeIdWithAlternative(
         const char (&charArray)[len], const char (&alternativeCharArray)[alternativeLen])
     {
         static_assert(len + /*terminating \0*/ 1 >= InterfaceId::minSize(),
@@ -132,11 +144,19 @@ protected:
         return reinterpret_cast<const InterfaceId*>(id.c_str());
     }
 
-    static std::vector<const InterfaceId*> alternativeInterfaceIds(const InterfaceId* id)
+    static std::array<const InterfaceId*, 1> alternativeInterfaceIds(const InterfaceId* id)
     {
-        return std::vector<const InterfaceId*>(1, id);
+        return {id};
+    }
+
+    template<size_t count>
+    static std::array<const InterfaceId*, count> alternativeInterfaceIds(
+        const std::array<const InterfaceId*, count>& ids)
+    {
+        return ids;
     }
 
+    /** For the interfaces defined with an older SDK, where the ids were returned as a vector. */
     static std::vector<const InterfaceId*> alternativeInterfaceIds(std::vector<const InterfaceId*> ids)
     {
         return ids;
@@ -0,0 +1,36 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+/**@file
+ * Replaces the global operator new and operator delete for the whole executable, counting the
+ * allocations of each thread.
+ */
+
+#include "allocation_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+static thread_local int t_allocationCount = 0;
+
+void* operator new(size_t size)
+{
+    ++t_allocationCount;
+    if (void* const p = malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t /*size*/) noexcept { free(p); }
+void operator delete[](void* p, size_t /*size*/) noexcept { free(p); }
+
+namespace nx::sdk::test {
+
+int threadAllocationCount()
+{
+    return t_allocationCount;
+}
+
+} // namespace nx::sdk::test
@@ -0,0 +1,14 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+namespace nx::sdk::test {
+
+/**
+ * @return Number of the heap allocations made by the current thread so far, to assert that a
+ *     path is free of them. Counted by the global operator new, which allocation_counter.cpp
+ *     replaces for the whole nx_sdk_ut executable.
+ */
+int threadAllocationCount();
+
+} // namespace nx::sdk::test
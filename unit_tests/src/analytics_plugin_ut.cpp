@@ -2,6 +2,7 @@
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #include <fstream>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -31,6 +32,7 @@
 #include <nx/sdk/helpers/error.h>
 #include <nx/sdk/helpers/lib_context.h>
 #include <nx/sdk/helpers/ref_countable.h>
+#include <nx/sdk/helpers/ref_countable_registry.h>
 #include <nx/sdk/helpers/settings_response.h>
 #include <nx/sdk/helpers/string.h>
 #include <nx/sdk/helpers/string_map.h>
@@ -580,6 +582,17 @@ static void testPluginLibrary(const std::string& libFilename)
     const std::string pluginLibName = getPluginLibName(libFilename);
     pluginLibContext->setName(pluginLibName.c_str());
 
+    // Track the ref-countable objects of the plugin to report the leaks and the number of objects
+    // of each type. The registry is owned by the plugin LibContext, thus, if the library stays
+    // loaded after its previous test, it already has the registry.
+    static std::set<std::string> libFilenamesWithRegistry;
+    RefCountableRegistry* refCountableRegistry = nullptr;
+    if (libFilenamesWithRegistry.insert(libFilename).second)
+    {
+        refCountableRegistry = new RefCountableRegistry(pluginLibName);
+        pluginLibContext->setRefCountableRegistry(refCountableRegistry);
+    }
+
     ASSERT_TRUE(integrationEntryPointFunc != nullptr || multiIntegrationEntryPointFunc != nullptr);
     if (multiIntegrationEntryPointFunc) //< Do not use entryPointFunc even if it is exported.
     {
@@ -606,7 +619,13 @@ static void testPluginLibrary(const std::string& libFilename)
         NX_KIT_ASSERT(false);
     }
 
-    unloadLib(libHandle);
+    if (refCountableRegistry)
+    {
+        NX_PRINT << "Ref-countable objects created by " << pluginLibName << ":\n"
+            << refCountableRegistry->report();
+    }
+
+    unloadLib(libHandle); //< Can delete the registry, logging the leaks.
 }
 
 static bool findPluginLibFilenames(const std::string& argv0)
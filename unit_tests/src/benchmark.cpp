@@ -0,0 +1,30 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include "benchmark.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <nx/kit/debug.h>
+#include <nx/kit/utils.h>
+
+namespace nx::sdk::test {
+
+bool benchmarksAreEnabled()
+{
+    // The args after "--" are left by nx_kit for the test itself.
+    static const bool areEnabled =
+        []()
+        {
+            const std::vector<std::string>& args = nx::kit::utils::getProcessCmdLineArgs();
+            const auto separator = std::find(args.begin(), args.end(), "--");
+            return std::find(separator, args.end(), "--benchmarks") != args.end();
+        }();
+
+    if (!areEnabled)
+        NX_PRINT << "Skipped: the benchmarks are run only with `-- --benchmarks`.";
+    return areEnabled;
+}
+
+} // namespace nx::sdk::test
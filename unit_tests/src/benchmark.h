@@ -0,0 +1,30 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include <nx/kit/test.h>
+
+namespace nx::sdk::test {
+
+/**
+ * @return Whether the benchmarks have been requested via `nx_sdk_ut -- --benchmarks`. If not,
+ *     prints a note that the current benchmark is skipped.
+ */
+bool benchmarksAreEnabled();
+
+} // namespace nx::sdk::test
+
+/**
+ * Defines a test which measures the performance rather than checks the behavior, and thus is too
+ * long for each test run: its body is run only if benchmarksAreEnabled(). Usage is the same as of
+ * TEST().
+ */
+#define BENCHMARK(TEST_CASE, TEST_NAME) \
+    static void benchmark_##TEST_CASE##_##TEST_NAME(); \
+    TEST(TEST_CASE, TEST_NAME) \
+    { \
+        if (::nx::sdk::test::benchmarksAreEnabled()) \
+            benchmark_##TEST_CASE##_##TEST_NAME(); \
+    } \
+    static void benchmark_##TEST_CASE##_##TEST_NAME()
+    // Function body follows the BENCHMARK macro.
@@ -0,0 +1,205 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <nx/kit/test.h>
+
+#include <nx/sdk/analytics/helpers/columnar_object_metadata_packet.h>
+#include <nx/sdk/analytics/helpers/object_metadata.h>
+#include <nx/sdk/analytics/helpers/object_metadata_packet.h>
+#include <nx/sdk/helpers/uuid_helper.h>
+
+#undef NX_DEBUG_ENABLE_OUTPUT
+#define NX_DEBUG_ENABLE_OUTPUT false
+#include <nx/kit/debug.h>
+
+#include "benchmark.h"
+
+namespace nx::sdk::analytics::test {
+
+static void assertRectEq(const Rect& expected, const Rect& actual)
+{
+    ASSERT_EQ(expected.x, actual.x);
+    ASSERT_EQ(expected.y, actual.y);
+    ASSERT_EQ(expected.width, actual.width);
+    ASSERT_EQ(expected.height, actual.height);
+}
+
+TEST(ColumnarObjectMetadataPacket, objectsMatchTheAddedOnes)
+{
+    const auto packet = makePtr<ColumnarObjectMetadataPacket>();
+    packet->setTimestampUs(42);
+
+    const Uuid trackId = UuidHelper::randomUuid();
+    ASSERT_EQ(0, packet->addObject("test.person", trackId, Rect(0.1F, 0.2F, 0.3F, 0.4F), 0.5F,
+        "adult"));
+    packet->addAttribute(IAttribute::Type::string, "color", "red");
+    packet->addAttribute(IAttribute::Type::number, "age", "33", 0.75F);
+
+    const std::vector<Uuid> trackIds{UuidHelper::randomUuid(), UuidHelper::randomUuid()};
+    const std::vector<Rect> boundingBoxes{Rect(0, 0, 0.5F, 0.5F), Rect(0.5F, 0.5F, 0.5F, 0.5F)};
+    packet->addObjects("test.car", trackIds, boundingBoxes);
+
+    ASSERT_EQ(3, packet->addObject("test.person", trackId, Rect(0, 0, 1, 1)));
+    packet->addAttribute(IAttribute::Type::string, "color", "green");
+
+    ASSERT_EQ(42, packet->timestampUs());
+    ASSERT_EQ(4, packet->count());
+    ASSERT_EQ(3, packet->attributeCount());
+    ASSERT_TRUE(!packet->at(-1));
+    ASSERT_TRUE(!packet->at(4));
+
+    const auto person = packet->at(0);
+    ASSERT_STREQ("test.person", person->typeId());
+    ASSERT_STREQ("adult", person->subtype());
+    ASSERT_EQ(0.5F, person->confidence());
+    ASSERT_EQ(trackId, person->trackId());
+    assertRectEq(Rect(0.1F, 0.2F, 0.3F, 0.4F), person->boundingBox());
+    ASSERT_EQ(2, person->attributeCount());
+    ASSERT_STREQ("color", person->attribute(0)->name());
+    ASSERT_STREQ("red", person->attribute(0)->value());
+    ASSERT_EQ(1.0F, person->attribute(0)->confidence());
+    ASSERT_TRUE(person->attribute(1)->type() == IAttribute::Type::number);
+    ASSERT_STREQ("age", person->attribute(1)->name());
+    ASSERT_STREQ("33", person->attribute(1)->value());
+    ASSERT_EQ(0.75F, person->attribute(1)->confidence());
+    ASSERT_TRUE(!person->attribute(2));
+
+    for (int i = 0; i < (int) trackIds.size(); ++i)
+    {
+        const auto car = packet->at(1 + i);
+        ASSERT_STREQ("test.car", car->typeId());
+        ASSERT_STREQ("", car->subtype());
+        ASSERT_EQ(trackIds[i], car->trackId());
+        assertRectEq(boundingBoxes[i], car->boundingBox());
+        ASSERT_EQ(0, car->attributeCount());
+        ASSERT_TRUE(!car->attribute(0));
+    }
+
+    const auto lastPerson = packet->at(3);
+    ASSERT_EQ(1, lastPerson->attributeCount());
+    ASSERT_STREQ("green", lastPerson->attribute(0)->value());
+
+    // Interned strings are stored once.
+    ASSERT_EQ(person->typeId(), lastPerson->typeId());
+    ASSERT_EQ(person->attribute(0)->name(), lastPerson->attribute(0)->name());
+
+    ASSERT_TRUE(person->queryInterface<IMetadata>());
+    ASSERT_TRUE(person->attribute(0)->queryInterface<IAttribute>());
+}
+
+TEST(ColumnarObjectMetadataPacket, objectsShareTheReferenceCounterOfThePacket)
+{
+    auto packet = makePtr<ColumnarObjectMetadataPacket>();
+    packet->addObject("test.person", UuidHelper::randomUuid(), Rect(0, 0, 1, 1));
+    packet->addAttribute(IAttribute::Type::string, "color", "red");
+    ASSERT_EQ(1, packet->refCount());
+
+    Ptr<const IObjectMetadata> object = packet->at(0);
+    ASSERT_EQ(2, packet->refCount());
+    Ptr<const IAttribute> attribute = object->attribute(0);
+    ASSERT_EQ(3, packet->refCount());
+
+    // The objects keep the packet alive.
+    packet.reset();
+    ASSERT_STREQ("test.person", object->typeId());
+    object.reset();
+    ASSERT_STREQ("red", attribute->value());
+    attribute.reset(); //< Destroys the packet.
+}
+
+TEST(ColumnarObjectMetadataPacket, clearKeepsThePacketReusable)
+{
+    const auto packet = makePtr<ColumnarObjectMetadataPacket>();
+    packet->addObject("test.person", UuidHelper::randomUuid(), Rect(0, 0, 1, 1));
+    packet->addAttribute(IAttribute::Type::string, "color", "red");
+
+    packet->clear();
+    ASSERT_EQ(0, packet->count());
+    ASSERT_EQ(0, packet->attributeCount());
+
+    packet->addObject("test.car", UuidHelper::randomUuid(), Rect(0, 0, 1, 1));
+    ASSERT_EQ(1, packet->count());
+    ASSERT_STREQ("test.car", packet->at(0)->typeId());
+    ASSERT_EQ(0, packet->at(0)->attributeCount());
+}
+
+/**
+ * Benchmark of building a packet of kObjectCount objects with an attribute each, and reading all
+ * of them back as the Server does, compared to ObjectMetadataPacket.
+ */
+BENCHMARK(ColumnarObjectMetadataPacket, buildBenchmark)
+{
+    constexpr int kObjectCount = 1'000;
+    constexpr int kPacketCount = 1'000;
+
+    std::vector<Uuid> trackIds;
+    std::vector<Rect> boundingBoxes;
+    for (int i = 0; i < kObjectCount; ++i)
+    {
+        trackIds.push_back(UuidHelper::randomUuid());
+        boundingBoxes.push_back(Rect(0, 0, 0.01F, 0.01F));
+    }
+
+    const auto readObjects =
+        [](const IObjectMetadataPacket* packet)
+        {
+            int attributeValueSize = 0;
+            for (int i = 0; i < packet->count(); ++i)
+            {
+                const auto object = packet->at(i);
+                for (int j = 0; j < object->attributeCount(); ++j)
+                    attributeValueSize += (int) std::string(object->attribute(j)->value()).size();
+            }
+            return attributeValueSize;
+        };
+
+    const auto benchmark =
+        [&](const char* name, auto makePacket)
+        {
+            int attributeValueSize = 0;
+            const auto startTime = std::chrono::steady_clock::now();
+            for (int i = 0; i < kPacketCount; ++i)
+                attributeValueSize += readObjects(makePacket().get());
+            const std::chrono::duration<double, std::micro> duration =
+                std::chrono::steady_clock::now() - startTime;
+
+            NX_PRINT << name << ": " << duration.count() / kPacketCount << " us per packet of "
+                << kObjectCount << " objects.";
+            ASSERT_EQ(kPacketCount * kObjectCount * (int) std::string("red").size(),
+                attributeValueSize);
+        };
+
+    benchmark("ObjectMetadataPacket",
+        [&]()
+        {
+            const auto packet = makePtr<ObjectMetadataPacket>();
+            for (int i = 0; i < kObjectCount; ++i)
+            {
+                const auto object = makePtr<ObjectMetadata>();
+                object->setTypeId("test.person");
+                object->setTrackId(trackIds[i]);
+                object->setBoundingBox(boundingBoxes[i]);
+                object->addAttribute(makePtr<Attribute>(IAttribute::Type::string, "color", "red"));
+                packet->addItem(object);
+            }
+            return packet;
+        });
+
+    benchmark("ColumnarObjectMetadataPacket",
+        [&]()
+        {
+            const auto packet = makePtr<ColumnarObjectMetadataPacket>();
+            packet->reserve(kObjectCount, kObjectCount);
+            for (int i = 0; i < kObjectCount; ++i)
+            {
+                packet->addObject("test.person", trackIds[i], boundingBoxes[i]);
+                packet->addAttribute(IAttribute::Type::string, "color", "red");
+            }
+            return packet;
+        });
+}
+
+} // namespace nx::sdk::analytics::test
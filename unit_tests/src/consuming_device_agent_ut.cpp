@@ -0,0 +1,361 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nx/kit/test.h>
+
+#include <nx/sdk/analytics/helpers/consuming_device_agent.h>
+#include <nx/sdk/analytics/helpers/event_metadata_packet.h>
+#include <nx/sdk/analytics/helpers/object_metadata.h>
+#include <nx/sdk/analytics/helpers/object_metadata_packet.h>
+#include <nx/sdk/helpers/device_info.h>
+
+#undef NX_DEBUG_ENABLE_OUTPUT
+#define NX_DEBUG_ENABLE_OUTPUT false
+#include <nx/kit/debug.h>
+
+#include "allocation_counter.h"
+#include "benchmark.h"
+
+namespace nx::sdk::analytics::test {
+
+using nx::sdk::test::threadAllocationCount;
+
+/** The last interface queried by ConsumingDeviceAgent::doPushDataPacket(). */
+class CustomMetadataPacket: public RefCountable<ICustomMetadataPacket>
+{
+public:
+    virtual int64_t timestampUs() const override { return 1; }
+    virtual const char* codec() const override { return "test"; }
+    virtual const char* data() const override { return ""; }
+    virtual int dataSize() const override { return 0; }
+    virtual const char* contextData() const override { return nullptr; }
+    virtual int contextDataSize() const override { return 0; }
+};
+
+class Handler: public RefCountable<IDeviceAgent::IHandler>
+{
+public:
+    /** Emulates the time the Server spends in handleMetadata(), e.g. waiting for a lock. */
+    std::chrono::microseconds handleMetadataDuration{0};
+
+    std::atomic<int> metadataPacketCount{0};
+
+    virtual void handleMetadata(IMetadataPacket* /*metadataPacket*/) override
+    {
+        if (handleMetadataDuration.count() > 0)
+            std::this_thread::sleep_for(handleMetadataDuration);
+        ++metadataPacketCount;
+    }
+
+    virtual void handleIntegrationDiagnosticEvent(IIntegrationDiagnosticEvent* /*event*/) override
+    {
+    }
+    virtual void pushManifest(const IString* /*manifest*/) override {}
+};
+
+class DeviceAgent: public ConsumingDeviceAgent
+{
+public:
+    DeviceAgent(const IDeviceInfo* deviceInfo): ConsumingDeviceAgent(deviceInfo, false) {}
+
+    using ConsumingDeviceAgent::pushMetadataPacket;
+
+    int customMetadataPacketCount = 0;
+
+protected:
+    virtual std::string manifestString() const override { return "{}"; }
+
+    virtual bool pushCustomMetadataPacket(Ptr<const ICustomMetadataPacket> /*packet*/) override
+    {
+        ++customMetadataPacketCount;
+        return true;
+    }
+};
+
+static Ptr<DeviceAgent> makeDeviceAgent(Ptr<Handler> handler = makePtr<Handler>())
+{
+    const auto deviceInfo = makePtr<DeviceInfo>();
+    deviceInfo->setId("test");
+    const auto deviceAgent = makePtr<DeviceAgent>(deviceInfo.get());
+    deviceAgent->setHandler(handler.get());
+    return deviceAgent;
+}
+
+TEST(ConsumingDeviceAgent, packetsAreDispatchedByInterface)
+{
+    const auto deviceAgent = makeDeviceAgent();
+
+    ASSERT_TRUE(deviceAgent->pushDataPacket(makePtr<CustomMetadataPacket>().get()).isOk());
+    ASSERT_EQ(1, deviceAgent->customMetadataPacketCount);
+
+    const auto eventPacket = makePtr<EventMetadataPacket>();
+    eventPacket->setTimestampUs(1);
+    const Result<void> result = deviceAgent->pushDataPacket(eventPacket.get());
+    ASSERT_FALSE(result.isOk()); //< Not supported.
+    Ptr(result.error().errorMessage()); //< releaseRef
+    ASSERT_EQ(1, deviceAgent->customMetadataPacketCount);
+}
+
+/**
+ * The dispatch path for the packet type which is queried last, thus making doPushDataPacket()
+ * walk the whole interface chain of the packet three times, does not allocate.
+ */
+TEST(ConsumingDeviceAgent, dispatchDoesNotAllocate)
+{
+    constexpr int kPacketCount = 1000;
+
+    const auto deviceAgent = makeDeviceAgent();
+    const auto packet = makePtr<CustomMetadataPacket>();
+    deviceAgent->pushDataPacket(packet.get()); //< Warm up, in case of any lazy initialization.
+
+    const int initialAllocationCount = threadAllocationCount();
+    for (int i = 0; i < kPacketCount; ++i)
+        deviceAgent->pushDataPacket(packet.get());
+    ASSERT_EQ(initialAllocationCount, threadAllocationCount());
+    ASSERT_EQ(kPacketCount + 1, deviceAgent->customMetadataPacketCount);
+
+    // queryInterface() itself, including a miss which walks the whole chain.
+    ASSERT_TRUE(packet->queryInterface<IDataPacket>());
+    ASSERT_FALSE(packet->queryInterface<ICompressedVideoPacket>());
+    ASSERT_EQ(initialAllocationCount, threadAllocationCount());
+}
+
+/** Benchmark of the dispatch path of the test above. */
+BENCHMARK(ConsumingDeviceAgent, dispatchBenchmark)
+{
+    constexpr int kPacketCount = 1'000'000;
+
+    const auto deviceAgent = makeDeviceAgent();
+    const auto packet = makePtr<CustomMetadataPacket>();
+
+    const auto startTime = std::chrono::steady_clock::now();
+    for (int i = 0; i < kPacketCount; ++i)
+        deviceAgent->pushDataPacket(packet.get());
+    const std::chrono::duration<double, std::nano> duration =
+        std::chrono::steady_clock::now() - startTime;
+
+    NX_PRINT << "Dispatched " << kPacketCount << " packets: "
+        << duration.count() / kPacketCount << " ns per packet.";
+
+    ASSERT_EQ(kPacketCount, deviceAgent->customMetadataPacketCount);
+}
+
+/** Takes kProcessingTime to process each packet, producing an object metadata packet. */
+class SlowDeviceAgent: public ConsumingDeviceAgent
+{
+public:
+    static constexpr auto kProcessingTime = std::chrono::milliseconds(2);
+
+    SlowDeviceAgent(const IDeviceInfo* deviceInfo): ConsumingDeviceAgent(deviceInfo, false) {}
+
+    virtual ~SlowDeviceAgent() override { disablePipeline(); }
+
+    using ConsumingDeviceAgent::enablePipeline;
+    using ConsumingDeviceAgent::disablePipeline;
+    using ConsumingDeviceAgent::pipelineCounters;
+
+protected:
+    virtual std::string manifestString() const override { return "{}"; }
+
+    virtual bool pushCustomMetadataPacket(Ptr<const ICustomMetadataPacket> /*packet*/) override
+    {
+        std::this_thread::sleep_for(kProcessingTime);
+        return true;
+    }
+
+    virtual bool pullMetadataPackets(std::vector<Ptr<IMetadataPacket>>* metadataPackets) override
+    {
+        const auto packet = makePtr<ObjectMetadataPacket>();
+        packet->setTimestampUs(1);
+        metadataPackets->push_back(packet);
+        return true;
+    }
+};
+
+/**
+ * The Server thread pushing the packets is stalled by the processing in the synchronous mode, and
+ * is not in the pipeline mode, where the packets which do not fit the queue are dropped.
+ */
+TEST(ConsumingDeviceAgent, pipelineDoesNotStallThePushingThread)
+{
+    constexpr int kPacketCount = 50;
+
+    const auto deviceInfo = makePtr<DeviceInfo>();
+    deviceInfo->setId("test");
+    const auto packet = makePtr<CustomMetadataPacket>();
+
+    const auto pushPackets =
+        [&](SlowDeviceAgent* deviceAgent)
+        {
+            const auto startTime = std::chrono::steady_clock::now();
+            for (int i = 0; i < kPacketCount; ++i)
+                ASSERT_TRUE(deviceAgent->pushDataPacket(packet.get()).isOk());
+            return std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - startTime);
+        };
+
+    const auto syncHandler = makePtr<Handler>();
+    const auto syncDeviceAgent = makePtr<SlowDeviceAgent>(deviceInfo.get());
+    syncDeviceAgent->setHandler(syncHandler.get());
+    ASSERT_FALSE(syncDeviceAgent->pipelineCounters());
+    const auto syncDuration = pushPackets(syncDeviceAgent.get());
+    ASSERT_EQ(kPacketCount, syncHandler->metadataPacketCount.load());
+
+    const auto pipelineHandler = makePtr<Handler>();
+    const auto pipelineDeviceAgent = makePtr<SlowDeviceAgent>(deviceInfo.get());
+    pipelineDeviceAgent->setHandler(pipelineHandler.get());
+    pipelineDeviceAgent->enablePipeline({/*queueCapacity*/ 4});
+    const auto pipelineDuration = pushPackets(pipelineDeviceAgent.get());
+
+    const auto counters = pipelineDeviceAgent->pipelineCounters();
+    ASSERT_TRUE(counters);
+    NX_PRINT << "Pushed " << kPacketCount << " packets taking "
+        << SlowDeviceAgent::kProcessingTime.count() << " ms each: "
+        << syncDuration.count() << " ms synchronously, "
+        << pipelineDuration.count() << " ms via the pipeline, which dropped "
+        << counters->droppedCount << " packet(s), peak queue depth " << counters->peakQueueDepth
+        << ".";
+
+    // The durations depend on the machine load, thus only the drops show that the pushing thread
+    // has not waited for the processing.
+    ASSERT_EQ(kPacketCount, (int) counters->pushedCount);
+    ASSERT_TRUE(counters->droppedCount > 0);
+
+    // The worker may not have been scheduled yet on a machine with a single core.
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (pipelineDeviceAgent->pipelineCounters()->processedCount == 0
+        && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(pipelineDeviceAgent->pipelineCounters()->processedCount > 0);
+
+    // Processed are the packets neither dropped nor still queued.
+    pipelineDeviceAgent->disablePipeline();
+    ASSERT_FALSE(pipelineDeviceAgent->pipelineCounters());
+    ASSERT_TRUE(pipelineHandler->metadataPacketCount.load() > 0);
+    ASSERT_TRUE(
+        pipelineHandler->metadataPacketCount.load() <= kPacketCount - counters->droppedCount);
+}
+
+TEST(ConsumingDeviceAgent, replacedHandlerIsUsed)
+{
+    const auto handler = makePtr<Handler>();
+    const auto deviceAgent = makeDeviceAgent(handler);
+
+    const auto packet = makePtr<ObjectMetadataPacket>();
+    packet->setTimestampUs(1);
+    deviceAgent->pushMetadataPacket(packet);
+    ASSERT_EQ(1, handler->metadataPacketCount.load());
+
+    const auto newHandler = makePtr<Handler>();
+    deviceAgent->setHandler(newHandler.get());
+    deviceAgent->pushMetadataPacket(packet);
+    ASSERT_EQ(1, handler->metadataPacketCount.load());
+    ASSERT_EQ(1, newHandler->metadataPacketCount.load());
+
+    // The replaced handler is not used by any thread, thus, is released at once.
+    ASSERT_EQ(1, handler->refCount());
+    ASSERT_EQ(2, newHandler->refCount());
+}
+
+TEST(ConsumingDeviceAgent, threadConfinedPacketsArePublishedBeforeBeingSent)
+{
+    const auto deviceAgent = makeDeviceAgent();
+
+    const auto packet = makePtr<ObjectMetadataPacket>(RefCountPolicy::threadConfined);
+    packet->setTimestampUs(1);
+    const auto objectMetadata = makePtr<ObjectMetadata>(RefCountPolicy::threadConfined);
+    packet->addItem(objectMetadata);
+    deviceAgent->pushMetadataPacket(packet);
+    ASSERT_TRUE(packet->isPublished());
+    ASSERT_TRUE(objectMetadata->isPublished());
+}
+
+/** Replaces itself with another handler while handling a packet. */
+class ReplacingHandler: public Handler
+{
+public:
+    ConsumingDeviceAgent* deviceAgent = nullptr;
+    IDeviceAgent::IHandler* newHandler = nullptr;
+    int refCountAfterReplacement = 0;
+
+    virtual void handleMetadata(IMetadataPacket* metadataPacket) override
+    {
+        Handler::handleMetadata(metadataPacket);
+        deviceAgent->setHandler(newHandler);
+        refCountAfterReplacement = refCount();
+    }
+};
+
+TEST(ConsumingDeviceAgent, handlerReplacedDuringItsCallIsReleasedAfterIt)
+{
+    const auto handler = makePtr<ReplacingHandler>();
+    const auto deviceAgent = makeDeviceAgent(handler);
+    const auto newHandler = makePtr<Handler>();
+    handler->deviceAgent = deviceAgent.get();
+    handler->newHandler = newHandler.get();
+    ASSERT_EQ(2, handler->refCount());
+
+    const auto packet = makePtr<ObjectMetadataPacket>();
+    packet->setTimestampUs(1);
+    deviceAgent->pushMetadataPacket(packet);
+    ASSERT_EQ(2, handler->refCountAfterReplacement); //< Still owned by the DeviceAgent.
+    ASSERT_EQ(1, handler->refCount());
+    ASSERT_EQ(2, newHandler->refCount());
+
+    deviceAgent->pushMetadataPacket(packet);
+    ASSERT_EQ(1, handler->metadataPacketCount.load());
+    ASSERT_EQ(1, newHandler->metadataPacketCount.load());
+}
+
+/**
+ * Benchmark of pushMetadataPacket() called from kMaxThreadCount threads at once, with the Server
+ * spending some time in each handleMetadata() call: since no lock is held during the call, the
+ * calls of the different threads overlap.
+ */
+BENCHMARK(ConsumingDeviceAgent, concurrentPushBenchmark)
+{
+    constexpr int kMaxThreadCount = 4;
+    constexpr int kPacketCountPerThread = 200;
+
+    const auto handler = makePtr<Handler>();
+    handler->handleMetadataDuration = std::chrono::microseconds(100);
+    const auto deviceAgent = makeDeviceAgent(handler);
+
+    const auto packet = makePtr<ObjectMetadataPacket>();
+    packet->setTimestampUs(1);
+
+    for (int threadCount = 1; threadCount <= kMaxThreadCount; threadCount *= 2)
+    {
+        handler->metadataPacketCount = 0;
+
+        std::vector<std::thread> threads;
+        const auto startTime = std::chrono::steady_clock::now();
+        for (int i = 0; i < threadCount; ++i)
+        {
+            threads.emplace_back(
+                [&]()
+                {
+                    for (int j = 0; j < kPacketCountPerThread; ++j)
+                        deviceAgent->pushMetadataPacket(packet);
+                });
+        }
+        for (auto& thread: threads)
+            thread.join();
+        const std::chrono::duration<double, std::micro> duration =
+            std::chrono::steady_clock::now() - startTime;
+
+        const int packetCount = threadCount * kPacketCountPerThread;
+        NX_PRINT << "Pushed " << packetCount << " packets from " << threadCount << " thread(s): "
+            << duration.count() / packetCount << " us per packet.";
+        ASSERT_EQ(packetCount, handler->metadataPacketCount.load());
+    }
+}
+
+} // namespace nx::sdk::analytics::test
@@ -0,0 +1,161 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nx/kit/test.h>
+
+#include <nx/sdk/analytics/helpers/data_packet_pipeline.h>
+#include <nx/sdk/helpers/ref_countable.h>
+
+namespace nx::sdk::analytics::test {
+
+class DataPacket: public RefCountable<IDataPacket>
+{
+public:
+    explicit DataPacket(int64_t timestampUs): m_timestampUs(timestampUs) {}
+
+    virtual int64_t timestampUs() const override { return m_timestampUs; }
+
+private:
+    const int64_t m_timestampUs;
+};
+
+/**
+ * Processor which records the timestamps of the packets, and can be paused to make the queue
+ * fill up.
+ */
+class Processor
+{
+public:
+    void operator()(Ptr<IDataPacket> packet)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this]() { return !m_isPaused; });
+        m_timestamps.push_back(packet->timestampUs());
+    }
+
+    void setPaused(bool isPaused)
+    {
+        {
+            const std::lock_guard<std::mutex> lock(m_mutex);
+            m_isPaused = isPaused;
+        }
+        m_condition.notify_all();
+    }
+
+    /** @return Space-separated timestamps of the processed packets. */
+    std::string timestamps() const
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        std::string result;
+        for (const int64_t timestamp: m_timestamps)
+            result += (result.empty() ? "" : " ") + std::to_string(timestamp);
+        return result;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_isPaused = false;
+    std::vector<int64_t> m_timestamps;
+};
+
+/** Waits until a worker takes the packet which has just been pushed into the empty queue. */
+static void waitUntilTaken(const DataPacketPipeline& pipeline)
+{
+    while (pipeline.counters().queueDepth > 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+/**
+ * Pushes the packet 1 which occupies the paused worker, then the packets 2 and 3 which fill the
+ * queue of capacity 2, then the packet 4 which overflows it, and resumes the processing.
+ *
+ * @return Timestamps of the processed packets, see Processor::timestamps().
+ */
+static std::string overflow(
+    DataPacketPipeline::OverflowPolicy overflowPolicy,
+    DataPacketPipeline::Counters* outCounters)
+{
+    Processor processor;
+    processor.setPaused(true);
+    DataPacketPipeline pipeline({/*queueCapacity*/ 2, /*workerCount*/ 1, overflowPolicy},
+        [&processor](Ptr<IDataPacket> packet) { processor(std::move(packet)); });
+
+    pipeline.push(makePtr<DataPacket>(1));
+    waitUntilTaken(pipeline);
+    pipeline.push(makePtr<DataPacket>(2));
+    pipeline.push(makePtr<DataPacket>(3));
+
+    std::thread pusher([&pipeline]() { pipeline.push(makePtr<DataPacket>(4)); });
+    if (overflowPolicy != DataPacketPipeline::OverflowPolicy::block)
+        pusher.join();
+    processor.setPaused(false);
+    if (pusher.joinable())
+        pusher.join();
+
+    pipeline.waitUntilIdle();
+    *outCounters = pipeline.counters();
+    return processor.timestamps();
+}
+
+TEST(DataPacketPipeline, dropOldest)
+{
+    DataPacketPipeline::Counters counters;
+    const auto timestamps = overflow(DataPacketPipeline::OverflowPolicy::dropOldest, &counters);
+    ASSERT_STREQ("1 3 4", timestamps);
+    ASSERT_EQ(4, counters.pushedCount);
+    ASSERT_EQ(3, counters.processedCount);
+    ASSERT_EQ(1, counters.droppedCount);
+    ASSERT_EQ(2, counters.peakQueueDepth);
+    ASSERT_EQ(0, counters.queueDepth);
+}
+
+TEST(DataPacketPipeline, dropNewest)
+{
+    DataPacketPipeline::Counters counters;
+    const auto timestamps = overflow(DataPacketPipeline::OverflowPolicy::dropNewest, &counters);
+    ASSERT_STREQ("1 2 3", timestamps);
+    ASSERT_EQ(3, counters.processedCount);
+    ASSERT_EQ(1, counters.droppedCount);
+}
+
+TEST(DataPacketPipeline, block)
+{
+    DataPacketPipeline::Counters counters;
+    const auto timestamps = overflow(DataPacketPipeline::OverflowPolicy::block, &counters);
+    ASSERT_STREQ("1 2 3 4", timestamps);
+    ASSERT_EQ(4, counters.processedCount);
+    ASSERT_EQ(0, counters.droppedCount);
+}
+
+TEST(DataPacketPipeline, destructionDropsTheQueuedPackets)
+{
+    Processor processor;
+    processor.setPaused(true);
+    std::thread resumer;
+    {
+        DataPacketPipeline pipeline({/*queueCapacity*/ 8},
+            [&processor](Ptr<IDataPacket> packet) { processor(std::move(packet)); });
+        pipeline.push(makePtr<DataPacket>(1));
+        waitUntilTaken(pipeline);
+        pipeline.push(makePtr<DataPacket>(2));
+
+        // The destructor waits for the packet being processed.
+        resumer = std::thread(
+            [&processor]()
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                processor.setPaused(false);
+            });
+    }
+    resumer.join();
+    ASSERT_STREQ("1", processor.timestamps());
+}
+
+} // namespace nx::sdk::analytics::test
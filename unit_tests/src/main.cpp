@@ -1,15 +1,29 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #include <iostream>
 
 #include <nx/kit/test.h>
 #include <nx/kit/debug.h>
+#include <nx/sdk/helpers/lib_context.h>
+#include <nx/sdk/helpers/ref_countable_registry.h>
 
 int main()
 {
+    // Tracks the objects created by the tests, detecting leaks when the LibContext is destroyed.
+    const auto refCountableRegistry = new nx::sdk::RefCountableRegistry("nx_sdk_ut");
+    nx::sdk::libContext().setRefCountableRegistry(refCountableRegistry);
+
     int failedTestsCount = 0;
 
-    failedTestsCount += nx::kit::test::runAllTests("nx_sdk");
+    failedTestsCount += nx::kit::test::runAllTests("nx_sdk", /*suppress newline*/ 1 + (const char*)
+R"(
+  --benchmarks
+    Run the benchmarks as well; they are skipped by default, being too long for each test run.
+)");
+
+    std::cerr << std::endl << "Ref-countable objects created by the tests:" << std::endl
+        << refCountableRegistry->report();
 
     std::cerr << std::endl;
 
@@ -0,0 +1,249 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <nx/kit/test.h>
+
+#include <nx/sdk/analytics/helpers/motion_grid.h>
+#include <nx/sdk/helpers/ref_countable.h>
+
+#undef NX_DEBUG_ENABLE_OUTPUT
+#define NX_DEBUG_ENABLE_OUTPUT false
+#include <nx/kit/debug.h>
+
+#include "benchmark.h"
+
+namespace nx::sdk::analytics::test {
+
+/** Packet with the motion in random cells, which implements isMotionAt() as the Server does. */
+class MotionMetadataPacket: public RefCountable<IMotionMetadataPacket>
+{
+public:
+    MotionMetadataPacket(int columnCount, int rowCount, double motionProbability):
+        m_columnCount(columnCount),
+        m_rowCount(rowCount),
+        m_data((columnCount * rowCount + 7) / 8 + /*excessive bytes*/ 3)
+    {
+        std::mt19937 random(columnCount * rowCount);
+        std::bernoulli_distribution hasMotion(motionProbability);
+        for (int column = 0; column < columnCount; ++column)
+        {
+            for (int row = 0; row < rowCount; ++row)
+            {
+                if (hasMotion(random))
+                    setMotionAt(column, row);
+            }
+        }
+
+        // Undefined bits beyond the grid, which must be ignored.
+        for (int bit = columnCount * rowCount; bit < (int) m_data.size() * 8; ++bit)
+            m_data[bit / 8] |= (uint8_t) (0x80 >> (bit % 8));
+    }
+
+    virtual int64_t timestampUs() const override { return 0; }
+    virtual const uint8_t* motionData() const override { return m_data.data(); }
+    virtual int motionDataSize() const override { return (int) m_data.size(); }
+    virtual int rowCount() const override { return m_rowCount; }
+    virtual int columnCount() const override { return m_columnCount; }
+
+    virtual bool isEmpty() const override
+    {
+        for (int column = 0; column < m_columnCount; ++column)
+        {
+            for (int row = 0; row < m_rowCount; ++row)
+            {
+                if (isMotionAt(column, row))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    virtual bool isMotionAt(int column, int row) const override
+    {
+        const int bit = m_rowCount * column + row;
+        return m_data[bit / 8] & (0x80 >> (bit % 8));
+    }
+
+    void setMotionAt(int column, int row)
+    {
+        const int bit = m_rowCount * column + row;
+        m_data[bit / 8] |= (uint8_t) (0x80 >> (bit % 8));
+    }
+
+private:
+    const int m_columnCount;
+    const int m_rowCount;
+    std::vector<uint8_t> m_data;
+};
+
+/** Reference implementation of MotionGrid::motionCellCount(). */
+static int motionCellCount(
+    const IMotionMetadataPacket* packet, int column, int row, int width, int height)
+{
+    int result = 0;
+    for (int c = std::max(column, 0); c < std::min(column + width, packet->columnCount()); ++c)
+    {
+        for (int r = std::max(row, 0); r < std::min(row + height, packet->rowCount()); ++r)
+            result += packet->isMotionAt(c, r) ? 1 : 0;
+    }
+    return result;
+}
+
+TEST(MotionGrid, cellsMatchThePacket)
+{
+    for (const auto& [columnCount, rowCount]: {std::pair{44, 32}, {5, 3}, {7, 130}, {1, 1}})
+    {
+        const auto packet = makePtr<MotionMetadataPacket>(columnCount, rowCount, 0.3);
+        const MotionGrid grid(packet.get());
+        ASSERT_EQ(columnCount, grid.columnCount());
+        ASSERT_EQ(rowCount, grid.rowCount());
+        ASSERT_EQ((rowCount + 63) / 64, grid.wordsPerColumn());
+        ASSERT_EQ(packet->isEmpty(), grid.isEmpty());
+        ASSERT_EQ(motionCellCount(packet.get(), 0, 0, columnCount, rowCount),
+            grid.motionCellCount());
+
+        for (int column = 0; column < columnCount; ++column)
+        {
+            for (int row = 0; row < rowCount; ++row)
+                ASSERT_EQ(packet->isMotionAt(column, row), grid.isMotionAt(column, row));
+        }
+    }
+}
+
+TEST(MotionGrid, rectangles)
+{
+    constexpr int kColumnCount = 44;
+    constexpr int kRowCount = 70;
+    const auto packet = makePtr<MotionMetadataPacket>(kColumnCount, kRowCount, 0.2);
+    const MotionGrid grid(packet.get());
+
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int> position(-5, 75);
+    std::uniform_int_distribution<int> size(0, 80);
+    for (int i = 0; i < 1000; ++i)
+    {
+        const int column = position(random);
+        const int row = position(random);
+        const int width = size(random);
+        const int height = size(random);
+        const int expectedCount = motionCellCount(packet.get(), column, row, width, height);
+        ASSERT_EQ(expectedCount, grid.motionCellCount(column, row, width, height));
+        ASSERT_EQ(expectedCount > 0, grid.hasMotion(column, row, width, height));
+
+        if (column >= 0 && column < kColumnCount)
+        {
+            ASSERT_EQ(motionCellCount(packet.get(), column, row, 1, height),
+                grid.columnMotionCellCount(column, row, row + height));
+        }
+    }
+
+    ASSERT_EQ(grid.motionCellCount(), grid.motionCellCount(-1, -1, 1'000'000, 1'000'000));
+    ASSERT_EQ(grid.motionCellCount(), grid.motionCellCount(0, 0, INT32_MAX, INT32_MAX));
+    ASSERT_EQ(0, grid.motionCellCount(kColumnCount, 0, 10, 10));
+}
+
+TEST(MotionGrid, shortOrNoData)
+{
+    const MotionGrid emptyGrid;
+    ASSERT_EQ(0, emptyGrid.columnCount());
+    ASSERT_TRUE(emptyGrid.isEmpty());
+    ASSERT_FALSE(emptyGrid.hasMotion(0, 0, 10, 10));
+
+    // The cells beyond the buffer have no motion.
+    const uint8_t data[] = {0xFF};
+    const MotionGrid grid(data, sizeof(data), /*columnCount*/ 3, /*rowCount*/ 4);
+    ASSERT_EQ(8, grid.motionCellCount());
+    ASSERT_TRUE(grid.isMotionAt(1, 3));
+    ASSERT_FALSE(grid.isMotionAt(2, 0));
+    ASSERT_EQ(0x0FU, (unsigned) grid.column(0)[0]);
+}
+
+/**
+ * Benchmark of the per-object check of the motion_metadata stub: the default 44x32 grid, objects
+ * of 2x2 and of the default 8x8 cells, and motion in few cells, so that many objects check all
+ * their cells.
+ */
+BENCHMARK(MotionGrid, benchmark)
+{
+    constexpr int kColumnCount = 44;
+    constexpr int kRowCount = 32;
+    constexpr int kPacketCount = 10'000;
+
+    const auto packet = makePtr<MotionMetadataPacket>(kColumnCount, kRowCount, 0.01);
+
+    // Read via a volatile pointer to make the calls virtual, as for the packets from the Server.
+    const IMotionMetadataPacket* volatile const motionPacketHolder = packet.get();
+
+    const auto measure =
+        [&](auto countObjectsWithMotion)
+        {
+            int objectCount = 0;
+            const auto startTime = std::chrono::steady_clock::now();
+            for (int i = 0; i < kPacketCount; ++i)
+                objectCount += countObjectsWithMotion();
+            const auto durationUs = std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - startTime).count() / kPacketCount;
+            return std::pair{durationUs, objectCount};
+        };
+
+    for (const int objectSize: {2, 8})
+    {
+        const int objectColumnCount = kColumnCount / objectSize;
+        const int objectRowCount = kRowCount / objectSize;
+
+        const auto [isMotionAtUs, isMotionAtObjectCount] = measure(
+            [&]()
+            {
+                const IMotionMetadataPacket* const motionPacket = motionPacketHolder;
+                int result = 0;
+                for (int objectColumn = 0; objectColumn < objectColumnCount; ++objectColumn)
+                {
+                    for (int objectRow = 0; objectRow < objectRowCount; ++objectRow)
+                    {
+                        bool hasMotion = false;
+                        for (int column = objectColumn * objectSize;
+                            !hasMotion && column < (objectColumn + 1) * objectSize; ++column)
+                        {
+                            for (int row = objectRow * objectSize;
+                                !hasMotion && row < (objectRow + 1) * objectSize; ++row)
+                            {
+                                hasMotion = motionPacket->isMotionAt(column, row);
+                            }
+                        }
+                        result += hasMotion ? 1 : 0;
+                    }
+                }
+                return result;
+            });
+
+        const auto [gridUs, gridObjectCount] = measure(
+            [&]()
+            {
+                const MotionGrid grid(motionPacketHolder);
+                int result = 0;
+                for (int objectColumn = 0; objectColumn < objectColumnCount; ++objectColumn)
+                {
+                    for (int objectRow = 0; objectRow < objectRowCount; ++objectRow)
+                    {
+                        result += grid.hasMotion(objectColumn * objectSize,
+                            objectRow * objectSize, objectSize, objectSize) ? 1 : 0;
+                    }
+                }
+                return result;
+            });
+
+        NX_PRINT << "Checked " << objectColumnCount * objectRowCount
+            << " objects of a " << kColumnCount << "x" << kRowCount << " grid: "
+            << isMotionAtUs << " us via isMotionAt(), " << gridUs << " us via MotionGrid, "
+            << "including its construction.";
+
+        ASSERT_EQ(isMotionAtObjectCount, gridObjectCount);
+    }
+}
+
+} // namespace nx::sdk::analytics::test
@@ -0,0 +1,241 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include <nx/kit/test.h>
+
+#include <nx/sdk/analytics/helpers/pixel_kernels.h>
+
+#undef NX_DEBUG_ENABLE_OUTPUT
+#define NX_DEBUG_ENABLE_OUTPUT false
+#include <nx/kit/debug.h>
+
+#include "benchmark.h"
+
+namespace nx::sdk::analytics::test {
+
+/** Image plane with the line padding, owning its data. */
+struct Plane
+{
+    int lineSize = 0;
+    std::vector<uint8_t> bytes;
+
+    Plane(int width, int height, int padding = 0):
+        lineSize(width + padding), bytes(lineSize * height)
+    {
+    }
+
+    ImagePlane view() const { return {bytes.data(), lineSize}; }
+    MutableImagePlane mutableView() { return {bytes.data(), lineSize}; }
+};
+
+/** Random yuv420 image, with the line padding, owning its planes. */
+struct TestYuv420Image
+{
+    Plane y;
+    Plane u;
+    Plane v;
+    Yuv420Image image;
+
+    TestYuv420Image(int width, int height):
+        y(width, height, /*padding*/ 7),
+        u((width + 1) / 2, (height + 1) / 2, /*padding*/ 5),
+        v((width + 1) / 2, (height + 1) / 2, /*padding*/ 3)
+    {
+        std::mt19937 random(width * height);
+        for (Plane* plane: {&y, &u, &v})
+        {
+            for (auto& byte: plane->bytes)
+                byte = (uint8_t) random();
+        }
+        image = {y.view(), u.view(), v.view(), width, height};
+    }
+};
+
+static void assertRowsEqual(
+    const Plane& expected, const Plane& actual, int rowSize, int rowCount)
+{
+    for (int row = 0; row < rowCount; ++row)
+    {
+        for (int i = 0; i < rowSize; ++i)
+        {
+            ASSERT_EQ((int) expected.bytes[row * expected.lineSize + i],
+                (int) actual.bytes[row * actual.lineSize + i]);
+        }
+    }
+}
+
+TEST(PixelKernels, yuv420ToRgbKnownColors)
+{
+    TestYuv420Image yuv(/*width*/ 2, /*height*/ 2);
+    for (int row = 0; row < 2; ++row)
+    {
+        yuv.y.bytes[row * yuv.y.lineSize] = 16; //< Black.
+        yuv.y.bytes[row * yuv.y.lineSize + 1] = 235; //< White.
+    }
+    yuv.u.bytes[0] = 128;
+    yuv.v.bytes[0] = 128;
+
+    Plane rgb(/*width*/ 2 * 3, /*height*/ 2);
+    yuv420ToRgb(yuv.image, rgb.mutableView(), SimdLevel::scalar);
+
+    const uint8_t expectedRow[] = {0, 0, 0, 255, 255, 255};
+    for (int row = 0; row < 2; ++row)
+    {
+        for (int i = 0; i < 6; ++i)
+            ASSERT_EQ((int) expectedRow[i], (int) rgb.bytes[row * rgb.lineSize + i]);
+    }
+
+    // Pure red in BT.601: y=81, u=90, v=240.
+    yuv.y.bytes[0] = 81;
+    yuv.u.bytes[0] = 90;
+    yuv.v.bytes[0] = 240;
+    yuv420ToRgb(yuv.image, rgb.mutableView(), SimdLevel::scalar);
+    ASSERT_TRUE(rgb.bytes[0] >= 254 && rgb.bytes[1] <= 1 && rgb.bytes[2] <= 1);
+}
+
+TEST(PixelKernels, yuv420ToRgbSimdMatchesScalar)
+{
+    NX_PRINT << "Best SIMD level: "
+        << (bestSimdLevel() == SimdLevel::avx2 ? "avx2" : "scalar") << ".";
+
+    for (const auto& [width, height]: {std::pair{64, 4}, {37, 21}, {15, 3}, {1, 1}})
+    {
+        const TestYuv420Image yuv(width, height);
+
+        Plane expectedRgb(width * 3, height, /*padding*/ 1);
+        yuv420ToRgb(yuv.image, expectedRgb.mutableView(), SimdLevel::scalar);
+        Plane rgb(width * 3, height, /*padding*/ 1);
+        yuv420ToRgb(yuv.image, rgb.mutableView(), SimdLevel::best);
+        assertRowsEqual(expectedRgb, rgb, width * 3, height);
+    }
+}
+
+TEST(PixelKernels, yuv420Crop)
+{
+    const TestYuv420Image yuv(/*width*/ 40, /*height*/ 30);
+    const Yuv420Image cropped = yuv.image.cropped(/*x*/ 11, /*y*/ 5, /*width*/ 20, /*height*/ 10);
+    ASSERT_EQ(20, cropped.width);
+    ASSERT_EQ(10, cropped.height);
+
+    Plane gray(20, 10);
+    yuv420ToGray(cropped, gray.mutableView());
+    for (int row = 0; row < 10; ++row)
+    {
+        for (int x = 0; x < 20; ++x)
+        {
+            // The position is rounded down to (10, 4).
+            ASSERT_EQ((int) yuv.y.bytes[(4 + row) * yuv.y.lineSize + 10 + x],
+                (int) gray.bytes[row * gray.lineSize + x]);
+        }
+    }
+
+    Plane croppedRgb(20 * 3, 10);
+    yuv420ToRgb(cropped, croppedRgb.mutableView());
+    Plane rgb(40 * 3, 30);
+    yuv420ToRgb(yuv.image, rgb.mutableView());
+    for (int row = 0; row < 10; ++row)
+    {
+        for (int i = 0; i < 20 * 3; ++i)
+        {
+            ASSERT_EQ((int) rgb.bytes[(4 + row) * rgb.lineSize + 10 * 3 + i],
+                (int) croppedRgb.bytes[row * croppedRgb.lineSize + i]);
+        }
+    }
+}
+
+TEST(PixelKernels, downscaleAreaAverages)
+{
+    Plane source(/*width*/ 4, /*height*/ 2, /*padding*/ 3);
+    source.bytes = {
+        0, 10, 100, 101, /*padding*/ 0, 0, 0,
+        20, 30, 200, 201, /*padding*/ 0, 0, 0,
+    };
+    Plane destination(2, 1);
+    downscaleArea(source.view(), 4, 2, /*channelCount*/ 1, destination.mutableView(), 2, 1);
+    ASSERT_EQ(15, (int) destination.bytes[0]);
+    ASSERT_EQ(151, (int) destination.bytes[1]); //< 150.5, rounded up.
+}
+
+TEST(PixelKernels, downscaleAreaSimdMatchesScalar)
+{
+    struct Case
+    {
+        int width;
+        int height;
+        int channelCount;
+        int destinationWidth;
+        int destinationHeight;
+    };
+
+    for (const Case& c: {
+        Case{64, 64, 1, 32, 32},
+        Case{100, 51, 3, 33, 17},
+        Case{37, 23, 1, 5, 7},
+        Case{640, 8, 3, 3, 1},
+        Case{17, 9, 4, 17, 9}})
+    {
+        const TestYuv420Image image(c.width * c.channelCount, c.height); //< Random data.
+        const ImagePlane source = image.y.view();
+
+        Plane expected(c.destinationWidth * c.channelCount, c.destinationHeight);
+        downscaleArea(source, c.width, c.height, c.channelCount, expected.mutableView(),
+            c.destinationWidth, c.destinationHeight, SimdLevel::scalar);
+        Plane actual(c.destinationWidth * c.channelCount, c.destinationHeight);
+        downscaleArea(source, c.width, c.height, c.channelCount, actual.mutableView(),
+            c.destinationWidth, c.destinationHeight, SimdLevel::best);
+        assertRowsEqual(expected, actual, c.destinationWidth * c.channelCount,
+            c.destinationHeight);
+    }
+}
+
+/** Benchmark of the kernels on a full HD frame, compared to the scalar reference. */
+BENCHMARK(PixelKernels, benchmark)
+{
+    constexpr int kWidth = 1920;
+    constexpr int kHeight = 1080;
+    constexpr int kRepetitionCount = 20;
+
+    const TestYuv420Image yuv(kWidth, kHeight);
+    Plane rgb(kWidth * 3, kHeight);
+    Plane smallRgb(640 * 3, 360);
+    Plane smallGray(480, 270);
+
+    const auto measure =
+        [](const char* name, const std::function<void(SimdLevel)>& kernel)
+        {
+            double durationsMs[2] = {};
+            const SimdLevel simdLevels[2] = {SimdLevel::scalar, SimdLevel::best};
+            for (int i = 0; i < 2; ++i)
+            {
+                const auto startTime = std::chrono::steady_clock::now();
+                for (int j = 0; j < kRepetitionCount; ++j)
+                    kernel(simdLevels[i]);
+                durationsMs[i] = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - startTime).count() / kRepetitionCount;
+            }
+            NX_PRINT << name << ": " << durationsMs[0] << " ms scalar, "
+                << durationsMs[1] << " ms best.";
+        };
+
+    measure("yuv420ToRgb 1920x1080",
+        [&](SimdLevel simdLevel) { yuv420ToRgb(yuv.image, rgb.mutableView(), simdLevel); });
+    measure("downscaleArea rgb 1920x1080 -> 640x360 (scalar at any level)",
+        [&](SimdLevel simdLevel)
+        {
+            downscaleArea(rgb.view(), kWidth, kHeight, /*channelCount*/ 3,
+                smallRgb.mutableView(), 640, 360, simdLevel);
+        });
+    measure("downscaleArea gray 1920x1080 -> 480x270",
+        [&](SimdLevel simdLevel)
+        {
+            downscaleArea(yuv.image.y, kWidth, kHeight, /*channelCount*/ 1,
+                smallGray.mutableView(), 480, 270, simdLevel);
+        });
+}
+
+} // namespace nx::sdk::analytics::test
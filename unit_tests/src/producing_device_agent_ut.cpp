@@ -0,0 +1,140 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <nx/kit/test.h>
+
+#include <nx/sdk/analytics/helpers/event_metadata_packet.h>
+#include <nx/sdk/analytics/helpers/producing_device_agent.h>
+
+namespace nx::sdk::analytics::test {
+
+using namespace std::chrono_literals;
+
+/** Yields packets with timestamps 1..count, sleeping between them. */
+static ProducerTask produceNumberedPackets(int count, std::chrono::milliseconds period)
+{
+    for (int i = 1; i <= count; ++i)
+    {
+        auto packet = makePtr<EventMetadataPacket>();
+        packet->setTimestampUs(i);
+        co_yield packet;
+        co_await sleepFor(period);
+    }
+}
+
+/** Collects the timestamps of the packets, and the threads they were produced on. */
+struct Collector
+{
+    std::mutex mutex;
+    std::vector<int64_t> timestamps;
+    std::set<std::thread::id> threadIds;
+
+    ProducerTask::Sink sink()
+    {
+        return
+            [this](Ptr<IMetadataPacket> packet)
+            {
+                const std::lock_guard<std::mutex> lock(mutex);
+                timestamps.push_back(packet->timestampUs());
+                threadIds.insert(std::this_thread::get_id());
+            };
+    }
+
+    int count()
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        return (int) timestamps.size();
+    }
+};
+
+static void waitFor(const std::function<bool()>& condition)
+{
+    const auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (!condition() && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(1ms);
+    ASSERT_TRUE(condition());
+}
+
+TEST(ProducingDeviceAgent, taskYieldsPacketsInOrderAfterSleeps)
+{
+    ProducerExecutor executor;
+    Collector collector;
+
+    const auto startTime = std::chrono::steady_clock::now();
+    ProducerTask task = produceNumberedPackets(/*count*/ 5, /*period*/ 10ms);
+    ASSERT_EQ(0, collector.count()); //< Not started yet.
+    task.start(&executor, collector.sink());
+
+    waitFor([&]() { return task.isDone(); });
+    ASSERT_TRUE(std::chrono::steady_clock::now() - startTime >= 50ms);
+    ASSERT_EQ(5, collector.count());
+    for (int i = 0; i < 5; ++i)
+        ASSERT_EQ(i + 1, collector.timestamps[i]);
+}
+
+TEST(ProducingDeviceAgent, manyTasksShareOneThread)
+{
+    constexpr int kTaskCount = 300;
+    constexpr int kPacketsPerTask = 3;
+
+    ProducerExecutor executor;
+    Collector collector;
+    std::vector<ProducerTask> tasks;
+    for (int i = 0; i < kTaskCount; ++i)
+    {
+        tasks.push_back(produceNumberedPackets(kPacketsPerTask, /*period*/ 5ms));
+        tasks.back().start(&executor, collector.sink());
+    }
+
+    waitFor([&]() { return collector.count() == kTaskCount * kPacketsPerTask; });
+    ASSERT_EQ(1, (int) collector.threadIds.size());
+    ASSERT_TRUE(*collector.threadIds.begin() != std::this_thread::get_id());
+}
+
+TEST(ProducingDeviceAgent, stoppedTaskProducesNoMore)
+{
+    ProducerExecutor executor;
+    Collector collector;
+
+    ProducerTask task = produceNumberedPackets(/*count*/ 1000, /*period*/ 1ms);
+    task.start(&executor, collector.sink());
+    waitFor([&]() { return collector.count() >= 3; });
+
+    task.stop();
+    ASSERT_FALSE(task.isValid());
+    const int countAfterStop = collector.count();
+    std::this_thread::sleep_for(20ms);
+    ASSERT_EQ(countAfterStop, collector.count());
+
+    // A task can be stopped right after being started, whether or not it has run.
+    ProducerTask neverRun = produceNumberedPackets(/*count*/ 1, /*period*/ 1ms);
+    neverRun.start(&executor, collector.sink());
+    neverRun.stop();
+}
+
+TEST(ProducingDeviceAgent, wokenTaskDoesNotWaitForTheRestOfItsSleep)
+{
+    ProducerExecutor executor;
+    Collector collector;
+
+    ProducerTask task = produceNumberedPackets(/*count*/ 3, /*period*/ 1h);
+    task.start(&executor, collector.sink());
+    waitFor([&]() { return collector.count() == 1; });
+
+    task.wake();
+    waitFor([&]() { return collector.count() == 2; });
+
+    // Waking a task which is not started does nothing.
+    ProducerTask notStarted = produceNumberedPackets(/*count*/ 1, /*period*/ 1ms);
+    notStarted.wake();
+    ASSERT_EQ(2, collector.count());
+}
+
+} // namespace nx::sdk::analytics::test
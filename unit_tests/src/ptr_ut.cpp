@@ -1,3 +1,4 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #include <nx/kit/test.h>
@@ -185,7 +186,7 @@ TEST(Ptr, shareToPtr)
         ASSERT_EQ(1, p->refCount());
         ASSERT_FALSE(Data::s_destructorCalled);
 
-        delete p;
+        ASSERT_EQ(0, p->releaseRef());
     }
     ASSERT_TRUE(Data::s_destructorCalled);
 }
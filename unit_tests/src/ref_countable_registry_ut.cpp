@@ -0,0 +1,111 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nx/kit/test.h>
+
+#include <nx/sdk/helpers/ref_countable.h>
+#include <nx/sdk/helpers/ref_countable_registry.h>
+#include <nx/sdk/helpers/string.h>
+#include <nx/sdk/helpers/string_map.h>
+
+namespace nx::sdk::test {
+
+/**
+ * The objects in these tests are registered when they are already constructed, so their type is
+ * the most derived one.
+ */
+static RefCountableRegistry::TypeStats findTypeStats(
+    const RefCountableRegistry& registry, const std::string& typeName)
+{
+    for (const auto& stats: registry.typeStats())
+    {
+        if (stats.typeName == typeName)
+            return stats;
+    }
+    return {};
+}
+
+TEST(RefCountableRegistry, countsObjectsPerType)
+{
+    RefCountableRegistry registry("test");
+
+    std::vector<Ptr<String>> strings;
+    for (int i = 0; i < 3; ++i)
+    {
+        strings.push_back(makePtr<String>());
+        registry.notifyCreated(strings.back().get(), strings.back()->refCount());
+    }
+    const auto stringMap = makePtr<StringMap>();
+    registry.notifyCreated(stringMap.get(), stringMap->refCount());
+    ASSERT_EQ(4, registry.liveCount());
+
+    for (int i = 0; i < 2; ++i)
+        registry.notifyDestroyed(strings[i].get(), /*refCount*/ 0);
+    registry.notifyCreated(strings[0].get(), strings[0]->refCount()); //< Address reused.
+    ASSERT_EQ(3, registry.liveCount());
+
+    const auto stringStats = findTypeStats(registry, "nx::sdk::String");
+    ASSERT_EQ(4, stringStats.createdCount);
+    ASSERT_EQ(2, stringStats.destroyedCount);
+    ASSERT_EQ(2, stringStats.liveCount);
+    ASSERT_EQ(3, stringStats.peakLiveCount);
+
+    const auto stringMapStats = findTypeStats(registry, "nx::sdk::StringMap");
+    ASSERT_EQ(1, stringMapStats.createdCount);
+    ASSERT_EQ(1, stringMapStats.liveCount);
+
+    // The most created type is the first.
+    ASSERT_EQ(stringStats.typeName, registry.typeStats().front().typeName);
+
+    // The live objects are reported as leaks.
+    const std::string report = registry.report();
+    ASSERT_TRUE(report.find("Live objects:") != std::string::npos);
+    ASSERT_TRUE(report.find(stringMapStats.typeName) != std::string::npos);
+
+    registry.notifyDestroyed(strings[0].get(), /*refCount*/ 0);
+    registry.notifyDestroyed(strings[2].get(), /*refCount*/ 0);
+    registry.notifyDestroyed(stringMap.get(), /*refCount*/ 0);
+    ASSERT_EQ(0, registry.liveCount());
+    ASSERT_TRUE(registry.report().find("Live objects:") == std::string::npos);
+}
+
+TEST(RefCountableRegistry, concurrentNotifications)
+{
+    constexpr int kThreadCount = 8;
+    constexpr int kObjectsPerThread = 1000;
+
+    RefCountableRegistry registry("test");
+    std::vector<std::vector<Ptr<String>>> objects(kThreadCount);
+    for (auto& threadObjects: objects)
+    {
+        for (int i = 0; i < kObjectsPerThread; ++i)
+            threadObjects.push_back(makePtr<String>());
+    }
+
+    std::vector<std::thread> threads;
+    for (auto& threadObjects: objects)
+    {
+        threads.emplace_back(
+            [&registry, &threadObjects]()
+            {
+                for (const auto& object: threadObjects)
+                    registry.notifyCreated(object.get(), 1);
+                for (const auto& object: threadObjects)
+                    registry.notifyDestroyed(object.get(), 0);
+            });
+    }
+    for (auto& thread: threads)
+        thread.join();
+
+    const auto stats = findTypeStats(registry, "nx::sdk::String");
+    ASSERT_EQ(kThreadCount * kObjectsPerThread, stats.createdCount);
+    ASSERT_EQ(kThreadCount * kObjectsPerThread, stats.destroyedCount);
+    ASSERT_EQ(0, stats.liveCount);
+    ASSERT_TRUE(stats.peakLiveCount >= kObjectsPerThread);
+    ASSERT_EQ(0, registry.liveCount());
+}
+
+} // namespace nx::sdk::test
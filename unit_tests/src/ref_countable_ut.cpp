@@ -1,11 +1,17 @@
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
+#include <array>
 #include <string>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include <nx/kit/test.h>
 
 #include <nx/sdk/interface.h>
+#include <nx/sdk/analytics/helpers/object_metadata.h>
+#include <nx/sdk/analytics/helpers/object_metadata_packet.h>
+#include <nx/sdk/helpers/attribute.h>
 #include <nx/sdk/helpers/ref_countable.h>
 
 #undef NX_DEBUG_ENABLE_OUTPUT
@@ -98,9 +104,9 @@ std::string objectAndInterfaceIdRef(ObjectPtr objectPtr)
         interfaceIdRef = nx::kit::utils::toString(Interface::interfaceId()->value);
     }
     else if constexpr (std::is_same_v<decltype(Interface::interfaceId()),
-        std::vector<const IRefCountable::InterfaceId*>>)
+        std::array<const IRefCountable::InterfaceId*, 2>>)
     {
-        // New interface with alternative id; interfaceId() is a vector of struct pointers.
+        // New interface with alternative id; interfaceId() is an array of struct pointers.
         for (const auto& id: Interface::interfaceId())
         {
             interfaceIdRef += (interfaceIdRef.empty() ? "" : "|")
@@ -207,6 +213,13 @@ TEST(RefCountable, interfaceId)
 {
     ASSERT_STREQ(ID_PREFIX "IData", static_cast<const char*>(IData::interfaceId()->value));
     ASSERT_EQ(IData::interfaceId()->value, reinterpret_cast<const char*>(IData::interfaceId()));
+
+    // Ids are equal by value, e.g. when they come from different binaries.
+    const std::string idCopy = IData::interfaceId()->value;
+    const auto copiedId = reinterpret_cast<const IRefCountable::InterfaceId*>(idCopy.c_str());
+    ASSERT_TRUE(*IData::interfaceId() == *copiedId);
+    ASSERT_FALSE(*IData::interfaceId() != *copiedId);
+    ASSERT_TRUE(*IData::interfaceId() != *IRefCountable::interfaceId());
 }
 
 TEST(RefCountable, refCountableBasics)
@@ -227,6 +240,125 @@ TEST(RefCountable, refCountableBasics)
     ASSERT_TRUE(Data::s_destructorCalled);
 }
 
+class ThreadConfinedData: public RefCountable<IData>
+{
+public:
+    static bool s_destructorCalled;
+
+    ThreadConfinedData(): RefCountable(RefCountPolicy::threadConfined) {}
+
+    virtual ~ThreadConfinedData() override
+    {
+        ASSERT_FALSE(s_destructorCalled);
+        s_destructorCalled = true;
+    }
+};
+bool ThreadConfinedData::s_destructorCalled = false;
+
+TEST(RefCountable, threadConfinedRefCount)
+{
+    ThreadConfinedData::s_destructorCalled = false;
+
+    auto data = new ThreadConfinedData;
+    ASSERT_FALSE(data->isPublished());
+    ASSERT_EQ(1, data->refCount());
+    ASSERT_EQ(2, data->addRef());
+    ASSERT_EQ(1, data->releaseRef());
+
+    data->publish();
+    ASSERT_TRUE(data->isPublished());
+    ASSERT_EQ(1, data->refCount());
+
+    // After the publication, the counter can be changed concurrently.
+    constexpr int kThreadCount = 4;
+    constexpr int kIterationCount = 100000;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreadCount; ++i)
+    {
+        threads.emplace_back(
+            [data]()
+            {
+                for (int j = 0; j < kIterationCount; ++j)
+                {
+                    data->addRef();
+                    data->releaseRef();
+                }
+            });
+    }
+    for (auto& thread: threads)
+        thread.join();
+    ASSERT_EQ(1, data->refCount());
+
+    ASSERT_FALSE(ThreadConfinedData::s_destructorCalled);
+    ASSERT_EQ(0, data->releaseRef());
+    ASSERT_TRUE(ThreadConfinedData::s_destructorCalled);
+
+    // An unpublished object is deleted as well.
+    ThreadConfinedData::s_destructorCalled = false;
+    {
+        const auto unpublished = makePtr<ThreadConfinedData>();
+        Ptr<ThreadConfinedData> copy = unpublished;
+        ASSERT_EQ(2, unpublished->refCount());
+        copy.reset();
+        ASSERT_EQ(1, unpublished->refCount());
+        ASSERT_FALSE(ThreadConfinedData::s_destructorCalled);
+    }
+    ASSERT_TRUE(ThreadConfinedData::s_destructorCalled);
+}
+
+TEST(RefCountable, atomicObjectIsPublishedFromTheStart)
+{
+    Data::s_destructorCalled = false;
+    const auto data = makePtr<Data>();
+    ASSERT_TRUE(data->isPublished());
+    data->publish();
+    ASSERT_TRUE(data->isPublished());
+}
+
+TEST(RefCountable, objectMetadataPublishesItsAttributes)
+{
+    const auto objectMetadata =
+        makePtr<analytics::ObjectMetadata>(RefCountPolicy::threadConfined);
+    const auto attribute = makePtr<Attribute>(IAttribute::Type::string, "name", "value",
+        /*confidence*/ 1.0F, RefCountPolicy::threadConfined);
+    objectMetadata->addAttribute(attribute);
+    ASSERT_FALSE(objectMetadata->isPublished());
+    ASSERT_FALSE(attribute->isPublished());
+
+    objectMetadata->publish();
+    ASSERT_TRUE(objectMetadata->isPublished());
+    ASSERT_TRUE(attribute->isPublished());
+
+    // The attributes are published as well when the object is published via its base class.
+    const auto otherObjectMetadata =
+        makePtr<analytics::ObjectMetadata>(RefCountPolicy::threadConfined);
+    const auto otherAttribute = makePtr<Attribute>(IAttribute::Type::string, "name", "value",
+        /*confidence*/ 1.0F, RefCountPolicy::threadConfined);
+    otherObjectMetadata->addAttribute(otherAttribute);
+    const RefCountable<analytics::IObjectMetadata>& base = *otherObjectMetadata;
+    base.publish();
+    ASSERT_TRUE(otherObjectMetadata->isPublished());
+    ASSERT_TRUE(otherAttribute->isPublished());
+}
+
+TEST(RefCountable, objectMetadataPacketPublishesItsObjects)
+{
+    const auto packet = makePtr<analytics::ObjectMetadataPacket>(RefCountPolicy::threadConfined);
+    const auto objectMetadata =
+        makePtr<analytics::ObjectMetadata>(RefCountPolicy::threadConfined);
+    const auto attribute = makePtr<Attribute>(IAttribute::Type::string, "name", "value",
+        /*confidence*/ 1.0F, RefCountPolicy::threadConfined);
+    objectMetadata->addAttribute(attribute);
+    packet->addItem(objectMetadata);
+    ASSERT_FALSE(packet->isPublished());
+    ASSERT_FALSE(objectMetadata->isPublished());
+
+    packet->publish();
+    ASSERT_TRUE(packet->isPublished());
+    ASSERT_TRUE(objectMetadata->isPublished());
+    ASSERT_TRUE(attribute->isPublished());
+}
+
 TEST(RefCountable, queryInterface)
 {
     Data::s_destructorCalled = false;
@@ -0,0 +1,86 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <string>
+#include <thread>
+
+#include <nx/kit/json.h>
+#include <nx/kit/test.h>
+
+#include <nx/sdk/helpers/span_recorder.h>
+
+namespace nx::sdk::test {
+
+static nx::kit::Json parseTraceEvents()
+{
+    std::string error;
+    const auto trace = nx::kit::Json::parse(SpanRecorder::instance().chromeTraceJson(), error);
+    ASSERT_EQ("", error);
+    return trace["traceEvents"];
+}
+
+TEST(SpanRecorder, disabledRecorderRecordsNothing)
+{
+    SpanRecorder::setEnabled(false);
+    SpanRecorder::instance().clear();
+    {
+        const Span span("disabled");
+    }
+    ASSERT_EQ(0, (int) parseTraceEvents().array_items().size());
+}
+
+TEST(SpanRecorder, nestedSpansOfSeveralThreads)
+{
+    SpanRecorder::instance().clear();
+    SpanRecorder::setEnabled(true);
+
+    const auto work =
+        []()
+        {
+            const Span outer("outer");
+            const Span inner("inner");
+        };
+    work();
+    std::thread(work).join();
+    SpanRecorder::setEnabled(false);
+
+    const auto events = parseTraceEvents().array_items();
+    ASSERT_EQ(4, (int) events.size());
+
+    // The events are sorted by the start time, so within a thread the outer span goes first.
+    int outerCount = 0;
+    for (const auto& event: events)
+    {
+        ASSERT_EQ("X", event["ph"].string_value());
+        ASSERT_TRUE(event["dur"].number_value() >= 0);
+        if (event["name"].string_value() != "outer")
+            continue;
+        ++outerCount;
+        for (const auto& other: events)
+        {
+            if (other["name"].string_value() == "inner"
+                && other["tid"].int_value() == event["tid"].int_value())
+            {
+                ASSERT_TRUE(other["ts"].number_value() >= event["ts"].number_value());
+                ASSERT_TRUE(other["ts"].number_value() + other["dur"].number_value()
+                    <= event["ts"].number_value() + event["dur"].number_value());
+            }
+        }
+    }
+    ASSERT_EQ(2, outerCount);
+    ASSERT_TRUE(events[0]["tid"].int_value() != events[3]["tid"].int_value());
+}
+
+TEST(SpanRecorder, ringKeepsMostRecentSpans)
+{
+    SpanRecorder::instance().clear();
+    for (int i = 0; i < SpanRecorder::kSpansPerThread + 100; ++i)
+        SpanRecorder::instance().record(i < 100 ? "old" : "new", /*beginUs*/ i, /*endUs*/ i + 1);
+
+    const auto events = parseTraceEvents().array_items();
+    ASSERT_EQ(SpanRecorder::kSpansPerThread, (int) events.size());
+    for (const auto& event: events)
+        ASSERT_EQ("new", event["name"].string_value());
+    ASSERT_EQ(100, events[0]["ts"].int_value());
+}
+
+} // namespace nx::sdk::test
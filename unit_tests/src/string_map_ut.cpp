@@ -0,0 +1,122 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <nx/kit/test.h>
+
+#include <nx/sdk/helpers/string_map.h>
+
+#undef NX_DEBUG_ENABLE_OUTPUT
+#define NX_DEBUG_ENABLE_OUTPUT false
+#include <nx/kit/debug.h>
+
+#include "benchmark.h"
+
+namespace nx::sdk::test {
+
+TEST(StringMap, itemsAreSortedByKey)
+{
+    const auto map = makePtr<StringMap>();
+    map->setItem("b", "2");
+    map->setItem("c", "3");
+    map->setItem("a", "1");
+
+    ASSERT_EQ(3, map->count());
+    ASSERT_STREQ("a", map->key(0));
+    ASSERT_STREQ("1", map->value(0));
+    ASSERT_STREQ("b", map->key(1));
+    ASSERT_STREQ("2", map->value(1));
+    ASSERT_STREQ("c", map->key(2));
+    ASSERT_STREQ("3", map->value(2));
+
+    ASSERT_TRUE(map->key(-1) == nullptr);
+    ASSERT_TRUE(map->key(3) == nullptr);
+    ASSERT_TRUE(map->value(3) == nullptr);
+
+    ASSERT_STREQ("2", map->value("b"));
+    ASSERT_TRUE(map->value("d") == nullptr);
+    ASSERT_TRUE(map->value("") == nullptr);
+    ASSERT_TRUE(map->value(nullptr) == nullptr);
+
+    map->clear();
+    ASSERT_EQ(0, map->count());
+    ASSERT_TRUE(map->value("a") == nullptr);
+}
+
+TEST(StringMap, overwrittenValuesAreReplaced)
+{
+    const auto map = makePtr<StringMap>();
+    map->setItem("key", "");
+    map->setItem("otherKey", "otherValue");
+
+    // Overwrite enough times to compact the buffer.
+    for (int i = 0; i < 100; ++i)
+    {
+        map->setItem("key", "value" + std::to_string(i));
+        ASSERT_EQ(2, map->count());
+        ASSERT_STREQ("value" + std::to_string(i), map->value("key"));
+        ASSERT_STREQ("otherValue", map->value("otherKey"));
+    }
+
+    ASSERT_STREQ("key", map->key(0));
+    ASSERT_STREQ("value99", map->value(0));
+    ASSERT_STREQ("otherKey", map->key(1));
+    ASSERT_STREQ("otherValue", map->value(1));
+}
+
+TEST(StringMap, constructionFromMap)
+{
+    const auto map = makePtr<StringMap>(StringMap::Map{{"b", "2"}, {"a", "1"}, {"c", ""}});
+    ASSERT_EQ(3, map->count());
+    ASSERT_STREQ("a", map->key(0));
+    ASSERT_STREQ("c", map->key(2));
+    ASSERT_STREQ("", map->value(2));
+    ASSERT_STREQ("2", map->value("b"));
+
+    map->setItem("ab", "12");
+    ASSERT_STREQ("ab", map->key(1));
+    ASSERT_STREQ("12", map->value(1));
+}
+
+/**
+ * Benchmark of filling a map item by item, reading each item back by index right after it is
+ * added (as a logging or validating caller does), and then looking up all the keys.
+ */
+BENCHMARK(StringMap, benchmark)
+{
+    const auto benchmark =
+        [](int itemCount, int repetitionCount)
+        {
+            std::vector<std::string> keys;
+            for (int i = 0; i < itemCount; ++i)
+                keys.push_back("setting" + std::to_string((i * 7919) % itemCount));
+
+            int totalSize = 0;
+            const auto startTime = std::chrono::steady_clock::now();
+            for (int repetition = 0; repetition < repetitionCount; ++repetition)
+            {
+                const auto map = makePtr<StringMap>();
+                for (const auto& key: keys)
+                {
+                    map->setItem(key, "value");
+                    totalSize += (int) strlen(map->key(map->count() - 1));
+                }
+                for (const auto& key: keys)
+                    totalSize += (int) strlen(map->value(key.c_str()));
+            }
+            const std::chrono::duration<double, std::micro> duration =
+                std::chrono::steady_clock::now() - startTime;
+
+            NX_PRINT << "Map of " << itemCount << " items: "
+                << duration.count() / repetitionCount << " us.";
+            ASSERT_TRUE(totalSize > 0);
+        };
+
+    benchmark(/*itemCount*/ 20, /*repetitionCount*/ 10'000);
+    benchmark(/*itemCount*/ 2'000, /*repetitionCount*/ 10);
+}
+
+} // namespace nx::sdk::test
@@ -1,15 +1,25 @@
+// Copyright 2025-present mike.shevchenko@gmail.com. Licensed under www.mozilla.org/MPL/2.0/
 // Copyright 2018-present Network Optix, Inc. Licensed under MPL 2.0: www.mozilla.org/MPL/2.0/
 
 #include <nx/kit/test.h>
 
+#include <chrono>
 #include <map>
+#include <set>
 #include <string>
 #include <sstream>
 #include <cctype>
+#include <thread>
 #include <vector>
 
 #include <nx/sdk/helpers/uuid_helper.h>
 
+#undef NX_DEBUG_ENABLE_OUTPUT
+#define NX_DEBUG_ENABLE_OUTPUT false
+#include <nx/kit/debug.h>
+
+#include "benchmark.h"
+
 namespace nx {
 namespace sdk {
 namespace test {
@@ -67,6 +77,38 @@ TEST(UuidHelper, uuidRandom)
     ASSERT_FALSE(random1 == random2);
 }
 
+TEST(UuidHelper, uuidRandomIsUniqueAcrossThreads)
+{
+    constexpr int kThreadCount = 4;
+    constexpr int kUuidCount = 1'000;
+
+    std::vector<std::vector<Uuid>> uuidsOfThreads(kThreadCount);
+    std::vector<std::thread> threads;
+    for (auto& uuids: uuidsOfThreads)
+    {
+        threads.emplace_back(
+            [&uuids]()
+            {
+                for (int i = 0; i < kUuidCount; ++i)
+                    uuids.push_back(UuidHelper::randomUuid());
+            });
+    }
+    for (auto& thread: threads)
+        thread.join();
+
+    std::set<Uuid> allUuids;
+    for (const auto& uuids: uuidsOfThreads)
+    {
+        for (const Uuid& uuid: uuids)
+        {
+            ASSERT_EQ(0x40, uuid[6] & 0xF0); //< Version 4.
+            ASSERT_EQ(0x80, uuid[8] & 0xC0); //< Variant 1.
+            allUuids.insert(uuid);
+        }
+    }
+    ASSERT_EQ(kThreadCount * kUuidCount, (int) allUuids.size());
+}
+
 TEST(UuidHelper, uuidBinaryCompatibilityWithOldSdk)
 {
     ASSERT_EQ(16, (int) sizeof(Uuid));
@@ -98,6 +140,11 @@ TEST(UuidHelper, toStdString)
     }
     ASSERT_STREQ(fixedUuidWithoutFormatOptions,
         UuidHelper::toStdString(kFixedUuid, UuidHelper::FormatOptions::none));
+
+    ASSERT_STREQ("D4BB55A4A87A4199BBD18000A480A5AD",
+        UuidHelper::toStdString(kFixedUuid, UuidHelper::FormatOptions::uppercase));
+    ASSERT_STREQ("{d4bb55a4-a87a-4199-bbd1-8000a480a5ad}", UuidHelper::toStdString(kFixedUuid,
+        (UuidHelper::FormatOptions) (UuidHelper::hyphens | UuidHelper::braces)));
 }
 
 TEST(UuidHelper, fromRawData)
@@ -150,7 +197,10 @@ TEST(UuidHelper, fromStdString)
         "{asdadsjhgjhg",
         "C9560F62-EC0D-45E9-B2A5-190A9F76B778adadae",
         "D7BFE5822B844E26AAAA40DA5CA5R097",
-        "<1be1f39b-96a6-481a-aa63-b4886314ad65>"
+        "<1be1f39b-96a6-481a-aa63-b4886314ad65>",
+        "1be1f39b-96a6-481a-aa63-b4886314ad6", //< Odd number of digits.
+        "1be1f39b-96a6-481a-aa63-b4886314ad65g",
+        "1be1f39b-96a6-481a-aa63-b4886314ad\x80\x80",
     };
 
     for (const auto& entry: goodUuids)
@@ -160,6 +210,79 @@ TEST(UuidHelper, fromStdString)
         ASSERT_EQ(UuidHelper::fromStdString(uuidString), kNullUuid);
 }
 
+/**
+ * Benchmark of the uuid generation, both in a single thread and in kThreadCount threads at once,
+ * when the threads would contend for a shared generator.
+ */
+BENCHMARK(UuidHelper, randomUuidBenchmark)
+{
+    constexpr int kUuidCount = 1'000'000;
+    constexpr int kThreadCount = 4;
+
+    const auto generate =
+        []()
+        {
+            uint8_t checksum = 0;
+            for (int i = 0; i < kUuidCount; ++i)
+                checksum ^= UuidHelper::randomUuid()[0];
+            return checksum;
+        };
+
+    auto startTime = std::chrono::steady_clock::now();
+    const uint8_t checksum = generate();
+    const std::chrono::duration<double, std::nano> duration =
+        std::chrono::steady_clock::now() - startTime;
+    NX_PRINT << "randomUuid(), 1 thread: " << duration.count() / kUuidCount << " ns per uuid"
+        << " (checksum " << (int) checksum << ").";
+
+    std::vector<std::thread> threads;
+    startTime = std::chrono::steady_clock::now();
+    for (int i = 0; i < kThreadCount; ++i)
+        threads.emplace_back(generate);
+    for (auto& thread: threads)
+        thread.join();
+    const std::chrono::duration<double, std::nano> concurrentDuration =
+        std::chrono::steady_clock::now() - startTime;
+    NX_PRINT << "randomUuid(), " << kThreadCount << " threads: "
+        << concurrentDuration.count() / (kThreadCount * kUuidCount) << " ns per uuid.";
+}
+
+BENCHMARK(UuidHelper, stringConversionBenchmark)
+{
+    constexpr int kUuidCount = 1'000'000;
+
+    std::vector<Uuid> uuids;
+    for (int i = 0; i < 1'000; ++i)
+        uuids.push_back(UuidHelper::randomUuid());
+
+    auto startTime = std::chrono::steady_clock::now();
+    int totalSize = 0;
+    for (int i = 0; i < kUuidCount; ++i)
+        totalSize += (int) UuidHelper::toStdString(uuids[i % uuids.size()]).size();
+    const std::chrono::duration<double, std::nano> toStdStringDuration =
+        std::chrono::steady_clock::now() - startTime;
+    ASSERT_EQ(kUuidCount * (int) sizeof(kFixedUuidString) - kUuidCount, totalSize);
+
+    std::vector<std::string> strings;
+    for (const Uuid& uuid: uuids)
+        strings.push_back(UuidHelper::toStdString(uuid));
+
+    startTime = std::chrono::steady_clock::now();
+    int parsedCount = 0;
+    for (int i = 0; i < kUuidCount; ++i)
+    {
+        const int index = i % (int) uuids.size();
+        if (UuidHelper::fromStdString(strings[index]) == uuids[index])
+            ++parsedCount;
+    }
+    const std::chrono::duration<double, std::nano> fromStdStringDuration =
+        std::chrono::steady_clock::now() - startTime;
+    ASSERT_EQ(kUuidCount, parsedCount);
+
+    NX_PRINT << "toStdString(): " << toStdStringDuration.count() / kUuidCount << " ns, "
+        << "fromStdString(): " << fromStdStringDuration.count() / kUuidCount << " ns per uuid.";
+}
+
 } // namespace test
 } // namespace sdk
 } // namespace nx